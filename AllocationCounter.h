@@ -0,0 +1,11 @@
+#pragma once
+#include <cstdint>
+
+// Heap allocations (operator new of any form) made by the calling thread so
+// far. Only programs that link AllocationCounter.cpp count: it replaces the
+// global operator new and delete, so keep it out of the shipped game.
+//
+//     const uint64_t before = allocationCount();
+//     ... code that should not allocate ...
+//     const uint64_t allocations = allocationCount() - before;
+uint64_t allocationCount();
@@ -0,0 +1,160 @@
+// The hot paths that promise not to allocate once warmed up: each is run
+// once to warm up, then again, and the second run must leave
+// allocationCount() where it was. Built with AllocationCounter.cpp, which
+// counts every operator new.
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "AllocationCounter.h"
+#include "FleetGenerator.h"
+#include "GameState.h"
+#include "MatchHost.h"
+#include "Protocol.h"
+#include "Replay.h"
+#include "Simulator.h"
+#include "TargetingEngine.h"
+#include "TestCheck.h"
+#ifdef SEA_BATTLE_RENDER_TESTS
+#include "BoardRenderer.h"
+#endif
+
+namespace {
+
+// Runs `work` twice; the second run must not allocate
+template <typename Work>
+void checkWarmedUp(const char* name, Work work) {
+    work();
+    const uint64_t before = allocationCount();
+    work();
+    const uint64_t allocations = allocationCount() - before;
+    if (allocations != 0) {
+        std::cerr << name << ": " << allocations << " allocation(s) after warm-up" << std::endl;
+    }
+    CHECK(allocations == 0);
+}
+
+std::vector<std::vector<Ship>> makeFleets(int count) {
+    std::vector<std::vector<Ship>> fleets(count);
+    for (int i = 0; i < count; ++i) {
+        autoPlaceShipsInPlacement(fleets[i], 10, 10, i);
+    }
+    return fleets;
+}
+
+void checkPlayGame(const std::vector<std::vector<Ship>>& fleets) {
+    const char* names[] = { "playGame (random)", "playGame (probability)", "playGame (density)", "playGame (endgame)" };
+    for (int kind = 0; kind < 4; ++kind) {
+        std::unique_ptr<Shooter> shooter = makeShooter(static_cast<ShooterKind>(kind), Rules(), 1);
+        FleetState fleet;
+        checkWarmedUp(names[kind], [&]() {
+            for (const auto& ships : fleets) {
+                fleet.setFleet(ships);
+                playGame(*shooter, fleet);
+            }
+        });
+    }
+}
+
+void checkFireAndUndo(const std::vector<std::vector<Ship>>& fleets) {
+    FleetState fleet;
+    checkWarmedUp("FleetState::fire/undo", [&]() {
+        for (const auto& ships : fleets) {
+            fleet.setFleet(ships);
+            for (int cell = 0; cell < 100; ++cell) {
+                fleet.fire(cell / 10, cell % 10);
+            }
+            for (int cell = 0; cell < 100; ++cell) {
+                fleet.undo();
+            }
+        }
+    });
+}
+
+void checkHostedMatch(const std::vector<std::vector<Ship>>& fleets) {
+    bool over = false;
+    ShotResult lastResult = ShotResult::MISS;
+    MatchHost host([&](ClientId, const Message& message) {
+        if (message.type == MessageType::GAME_OVER) {
+            over = true;
+        }
+        else if (message.type == MessageType::SHOT_RESULT && message.flags == 0) {
+            lastResult = message.result;
+        }
+    }, 1);
+    TargetingEngine client(protocolRows, protocolCols, standardFleet(), 2);
+    std::vector<Message> messages;
+    for (const auto& ships : fleets) {
+        messages.push_back(fleetMessage(0, Opponent::COMPUTER, ships));
+    }
+    checkWarmedUp("MatchHost::receive", [&]() {
+        for (const auto& fleet : messages) {
+            over = false;
+            client.reset();
+            host.receive(1, fleet);
+            int row = 0;
+            int col = 0;
+            while (!over && client.chooseTarget(row, col)) {
+                host.receive(1, shotMessage(0, row, col));
+                client.recordShot(row, col, lastResult);
+            }
+        }
+    });
+}
+
+void checkReplayPlayer() {
+    const std::string path = "allocation-test.sbr";
+    ReplayRecordOptions options;
+    options.seed = 3;
+    options.games = 32;
+    options.threads = 1;
+    std::string error;
+    ReplayLog log;
+    CHECK(recordMatches(options, path, error) && log.open(path, error));
+    ReplayPlayer player(10, 10);
+    ReplayRecord record;
+    checkWarmedUp("ReplayPlayer::step", [&]() {
+        size_t cursor = 0;
+        while (log.next(cursor, record)) {
+            player.start(log, record);
+            while (player.step()) {
+            }
+        }
+    });
+    std::remove(path.c_str());
+}
+
+#ifdef SEA_BATTLE_RENDER_TESTS
+void checkCellBatch(const std::vector<std::vector<Ship>>& fleets) {
+    const BoardLayout layout = { 50.0f, 50.0f, 42.5f, 60.0f, 10, 10 };
+    CellBatch cells;
+    cells.reserve(4 * 10 * 10);
+    FleetState fleet;
+    checkWarmedUp("CellBatch rebuild", [&]() {
+        for (const auto& ships : fleets) {
+            fleet.setFleet(ships);
+            for (int cell = 0; cell < 100; cell += 3) {
+                fleet.fire(cell / 10, cell % 10);
+            }
+            cells.clear();
+            cells.addShips(layout, ships);
+            cells.addMarks(layout, fleet);
+            cells.commit();
+        }
+    });
+}
+#endif
+
+}
+
+int main() {
+    const std::vector<std::vector<Ship>> fleets = makeFleets(64);
+    checkPlayGame(fleets);
+    checkFireAndUndo(fleets);
+    checkHostedMatch(fleets);
+    checkReplayPlayer();
+#ifdef SEA_BATTLE_RENDER_TESTS
+    checkCellBatch(fleets);
+#endif
+    return testResult();
+}
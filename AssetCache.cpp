@@ -0,0 +1,228 @@
+#include "AssetCache.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include "EmbeddedAssets.h"
+#include "MappedFile.h"
+#include "Profiler.h"
+
+namespace {
+
+const char decodedMagic[4] = { 'S', 'B', 'T', '1' };
+const size_t decodedHeaderSize = 28;
+
+uint64_t readLittleEndian(const unsigned char* data, int bytes) {
+    uint64_t value = 0;
+    for (int i = bytes - 1; i >= 0; --i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+void appendLittleEndian(std::string& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+uint64_t fnv1a(const unsigned char* data, size_t size) {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ data[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+bool decodeTexture(const std::string& path, sf::Image& image) {
+    ProfileScope scope("AssetCache::decodeTexture");
+    // Embedded images touch no file at all, so they skip the decoded cache
+    if (const EmbeddedAsset* embedded = findEmbeddedAsset(path)) {
+        return image.loadFromMemory(embedded->data, embedded->size);
+    }
+    std::ifstream file(path, std::ios::binary);
+    const std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (data.empty()) {
+        return false;
+    }
+    const std::string cachePath = path + ".sbt";
+    if (loadDecodedImage(cachePath, data.data(), data.size(), image)) {
+        return true;
+    }
+    if (!image.loadFromMemory(data.data(), data.size())) {
+        return false;
+    }
+    // Best effort: a read-only directory only costs the next start a decode
+    saveDecodedImage(cachePath, data.data(), data.size(), image);
+    return true;
+}
+
+bool decodeFont(const std::string& path, sf::Font& font) {
+    ProfileScope scope("AssetCache::decodeFont");
+    // sf::Font reads glyphs from its source for as long as it lives, which
+    // embedded data does
+    if (const EmbeddedAsset* embedded = findEmbeddedAsset(path)) {
+        return font.loadFromMemory(embedded->data, embedded->size);
+    }
+    return font.loadFromFile(path);
+}
+
+}
+
+bool loadDecodedImage(const std::string& cachePath, const unsigned char* source, size_t sourceSize, sf::Image& image) {
+    MappedFile file;
+    if (!file.open(cachePath) || file.size() < decodedHeaderSize) {
+        return false;
+    }
+    const unsigned char* data = file.data();
+    const uint64_t width = readLittleEndian(data + 4, 4);
+    const uint64_t height = readLittleEndian(data + 8, 4);
+    if (!std::equal(decodedMagic, decodedMagic + 4, data) || file.size() != decodedHeaderSize + 4 * width * height
+        || readLittleEndian(data + 12, 8) != sourceSize || readLittleEndian(data + 20, 8) != fnv1a(source, sourceSize)) {
+        return false;
+    }
+    image.create(static_cast<unsigned>(width), static_cast<unsigned>(height), data + decodedHeaderSize);
+    return true;
+}
+
+bool saveDecodedImage(const std::string& cachePath, const unsigned char* source, size_t sourceSize, const sf::Image& image) {
+    const sf::Vector2u size = image.getSize();
+    std::string header(decodedMagic, sizeof(decodedMagic));
+    appendLittleEndian(header, size.x, 4);
+    appendLittleEndian(header, size.y, 4);
+    appendLittleEndian(header, sourceSize, 8);
+    appendLittleEndian(header, fnv1a(source, sourceSize), 8);
+
+    // Written aside and renamed, so a reader never maps half a file
+    const std::string partPath = cachePath + ".part";
+    std::ofstream out(partPath, std::ios::binary | std::ios::trunc);
+    out.write(header.data(), header.size());
+    out.write(reinterpret_cast<const char*>(image.getPixelsPtr()), 4 * static_cast<std::streamsize>(size.x) * size.y);
+    out.close();
+    std::remove(cachePath.c_str());
+    if (!out || std::rename(partPath.c_str(), cachePath.c_str()) != 0) {
+        std::remove(partPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+AssetCache::~AssetCache() {
+    if (loader.joinable()) {
+        loader.join();
+    }
+}
+
+std::shared_ptr<const sf::Texture> AssetCache::texture(const std::string& path) {
+    if (isPending(path)) {
+        waitForLoader();
+    }
+    auto it = textures.find(path);
+    if (it != textures.end()) {
+        return it->second;
+    }
+    sf::Image image;
+    auto loaded = std::make_shared<sf::Texture>();
+    if (!decodeTexture(path, image) || !loaded->loadFromImage(image)) {
+        std::cerr << "Error loading texture " << path << "!" << std::endl;
+        return nullptr;
+    }
+    textures[path] = loaded;
+    return loaded;
+}
+
+std::shared_ptr<const sf::Font> AssetCache::font(const std::string& path) {
+    if (isPending(path)) {
+        waitForLoader();
+    }
+    auto it = fonts.find(path);
+    if (it != fonts.end()) {
+        return it->second;
+    }
+    auto loaded = std::make_shared<sf::Font>();
+    if (!decodeFont(path, *loaded)) {
+        std::cerr << "Error loading font " << path << "!" << std::endl;
+        return nullptr;
+    }
+    fonts[path] = loaded;
+    return loaded;
+}
+
+void AssetCache::loadAsync(const std::vector<std::string>& fontPaths, const std::vector<std::string>& texturePaths) {
+    for (const auto& path : fontPaths) {
+        pending.push_back(PendingAsset());
+        pending.back().path = path;
+        pending.back().isFont = true;
+    }
+    for (const auto& path : texturePaths) {
+        pending.push_back(PendingAsset());
+        pending.back().path = path;
+    }
+    // `pending` is not resized from here on: the loader fills its entries in
+    // order and publishes each through `decoded`
+    loader = std::thread([this]() {
+        Profiler::setThreadName("assets");
+        for (size_t i = 0; i < pending.size(); ++i) {
+            PendingAsset& asset = pending[i];
+            if (asset.isFont) {
+                asset.font = std::make_shared<sf::Font>();
+                asset.loaded = decodeFont(asset.path, *asset.font);
+            }
+            else {
+                asset.loaded = decodeTexture(asset.path, asset.image);
+            }
+            decoded.store(i + 1, std::memory_order_release);
+        }
+    });
+}
+
+AssetState AssetCache::poll() {
+    const size_t ready = decoded.load(std::memory_order_acquire);
+    for (; taken < ready; ++taken) {
+        PendingAsset& asset = pending[taken];
+        if (asset.loaded && asset.isFont) {
+            fonts[asset.path] = std::move(asset.font);
+        }
+        else if (asset.loaded) {
+            ProfileScope scope("AssetCache::upload");
+            auto uploaded = std::make_shared<sf::Texture>();
+            asset.loaded = uploaded->loadFromImage(asset.image);
+            asset.image = sf::Image();
+            if (asset.loaded) {
+                textures[asset.path] = uploaded;
+            }
+        }
+        if (!asset.loaded) {
+            std::cerr << "Error loading " << asset.path << "!" << std::endl;
+            failed = true;
+        }
+    }
+    if (failed) {
+        return AssetState::FAILED;
+    }
+    return taken == pending.size() ? AssetState::READY : AssetState::LOADING;
+}
+
+float AssetCache::progress() const {
+    if (pending.empty()) {
+        return 1.0f;
+    }
+    return static_cast<float>(decoded.load(std::memory_order_acquire)) / pending.size();
+}
+
+bool AssetCache::isPending(const std::string& path) const {
+    for (size_t i = taken; i < pending.size(); ++i) {
+        if (pending[i].path == path) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void AssetCache::waitForLoader() {
+    if (loader.joinable()) {
+        loader.join();
+    }
+    poll();
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+enum class AssetState {
+    LOADING,
+    READY,
+    FAILED
+};
+
+// Loads every texture and font once and hands out shared handles to it, so
+// any number of sprites, texts and windows can use the same asset. Assets
+// are either loaded in the background at startup or lazily on first use;
+// after that a lookup never touches the disk.
+//
+// An asset comes from the binary if the build embedded it (EmbeddedAssets.h),
+// without any file access, else from the file. A texture decoded from a file
+// is kept in "<path>.sbt" (raw RGBA, see below) so that later starts skip
+// PNG decoding.
+class AssetCache {
+public:
+    AssetCache() = default;
+    ~AssetCache();
+
+    AssetCache(const AssetCache&) = delete;
+    AssetCache& operator=(const AssetCache&) = delete;
+
+    // nullptr (and a message on std::cerr) if the asset cannot be loaded.
+    // Waits for the background load if the asset is part of it.
+    std::shared_ptr<const sf::Texture> texture(const std::string& path);
+    std::shared_ptr<const sf::Font> font(const std::string& path);
+
+    // Reads and decodes the assets on a background thread, so the window
+    // can show frames meanwhile. Call once.
+    void loadAsync(const std::vector<std::string>& fontPaths, const std::vector<std::string>& texturePaths);
+    // Takes over what the background thread has decoded so far (textures
+    // are uploaded here, on the thread that owns the GL context); never
+    // blocks. READY once every asset is in, FAILED if any could not load.
+    AssetState poll();
+    // Share of the background assets decoded, 0..1
+    float progress() const;
+
+private:
+    // One asset of the background load; written by the loader until
+    // `decoded` counts it, then read by poll()
+    struct PendingAsset {
+        std::string path;
+        bool isFont = false;
+        std::shared_ptr<sf::Font> font;
+        sf::Image image;
+        bool loaded = false;
+    };
+
+    std::map<std::string, std::shared_ptr<const sf::Texture>> textures;
+    std::map<std::string, std::shared_ptr<const sf::Font>> fonts;
+
+    std::vector<PendingAsset> pending;
+    std::atomic<size_t> decoded{ 0 };
+    size_t taken = 0;
+    bool failed = false;
+    std::thread loader;
+
+    bool isPending(const std::string& path) const;
+    void waitForLoader();
+};
+
+// Decoded texture cache ("SBT1"), little-endian: magic, width and height
+// (4 bytes each), size and FNV-1a hash of the encoded image the pixels came
+// from (8 bytes each), then width * height RGBA pixels. A cache whose source
+// no longer matches is decoded again and rewritten.
+bool loadDecodedImage(const std::string& cachePath, const unsigned char* source, size_t sourceSize, sf::Image& image);
+bool saveDecodedImage(const std::string& cachePath, const unsigned char* source, size_t sourceSize, const sf::Image& image);
@@ -0,0 +1,171 @@
+#include "BattleSession.h"
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include "FleetBatch.h"
+#include "Profiler.h"
+#include "Simulator.h"
+
+namespace {
+
+BattleSnapshot emptySnapshot(int rows, int cols) {
+    BattleSnapshot snapshot;
+    snapshot.marks[0].assign(rows * cols, CellMark::NONE);
+    snapshot.marks[1].assign(rows * cols, CellMark::NONE);
+    return snapshot;
+}
+
+}
+
+BattleSession::BattleSession(const Rules& rules, const std::vector<Ship>& playerShips, bool withComputer, uint64_t seed,
+                             std::string replayPath)
+    : rules(rules),
+      colCount(rules.cols),
+      withComputer(withComputer),
+      replayPath(std::move(replayPath)),
+      playerFleet(rules.rows, rules.cols, rules.shipsMayTouch),
+      opponentFleet(rules.rows, rules.cols, rules.shipsMayTouch),
+      computer(makeShooter(ShooterKind::ENDGAME, rules, fleetSeed(seed, 1))),
+      snapshots(emptySnapshot(rules.rows, rules.cols)) {
+    playerFleet.setFleet(playerShips);
+    if (!withComputer) {
+        return;
+    }
+    if (!fleetFollowsRules(playerShips, rules)) {
+        std::cerr << "Error: the player's fleet does not follow the rules" << std::endl;
+        this->withComputer = false;
+        return;
+    }
+    // Hidden computer fleet on the right board, the computer shoots at the left one
+    std::vector<Ship> opponentShips;
+    autoPlaceShipsInPlacement(opponentShips, rules, fleetSeed(seed, 0));
+    opponentFleet.setFleet(opponentShips);
+
+    // Replay shots are one byte per cell and the format has no touching rule
+    if (rules.shipsMayTouch || rules.cellCount() > 256) {
+        this->replayPath.clear();
+    }
+    // The log lists ships longest first (the standard fleet's order)
+    auto longestFirst = [](const Ship& a, const Ship& b) { return a.length > b.length; };
+    replay.seed = seed;
+    replay.firstSide = 0;
+    replay.fleets[0] = playerShips;
+    std::stable_sort(replay.fleets[0].begin(), replay.fleets[0].end(), longestFirst);
+    replay.fleets[1] = opponentShips;
+    std::stable_sort(replay.fleets[1].begin(), replay.fleets[1].end(), longestFirst);
+    replay.shots.reserve(2 * rules.cellCount());
+
+    worker = std::thread(&BattleSession::run, this);
+}
+
+BattleSession::~BattleSession() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool BattleSession::shoot(int row, int col) {
+    const BattleSnapshot& shown = snapshot();
+    if (!withComputer || shown.winner >= 0 || shown.marks[1][row * colCount + col] != CellMark::NONE) {
+        return false;
+    }
+    if (!inputs.push({ row, col })) {
+        return false;
+    }
+    ++sent;
+    // The worker checks the queue under the mutex before it sleeps, so
+    // passing through it here means the notify cannot be missed
+    { std::lock_guard<std::mutex> lock(wakeMutex); }
+    wake.notify_one();
+    return true;
+}
+
+void BattleSession::run() {
+    // Only stores the name: a worker per game costs the profiler a ring only
+    // while profiling, and the ring is reused once the game ends
+    Profiler::setThreadName("battle");
+    Input input;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait(lock, [this] { return stopping || !inputs.empty(); });
+            if (stopping) {
+                return;
+            }
+        }
+        while (inputs.pop(input)) {
+            ProfileScope scope("BattleSession::playTurn");
+            playTurn(input.row, input.col);
+            ++answered;
+            publish();
+        }
+    }
+}
+
+void BattleSession::playTurn(int row, int col) {
+    // The render thread checked against a snapshot that may be behind
+    bool gameOver = playerFleet.defeated() || opponentFleet.defeated();
+    if (gameOver || opponentFleet.mark(row, col) != CellMark::NONE) {
+        return;
+    }
+    ShotResult result = opponentFleet.fire(row, col);
+    replay.shots.push_back(static_cast<uint8_t>(row * colCount + col));
+    if (opponentFleet.defeated()) {
+        std::cout << "You win!" << std::endl;
+    }
+
+    // A miss passes the turn; the computer keeps shooting while it hits,
+    // and the screen follows it shot by shot
+    bool computerTurn = result == ShotResult::MISS;
+    int targetRow = 0;
+    int targetCol = 0;
+    while (computerTurn && !playerFleet.defeated()) {
+        publish();
+        if (!computer->chooseTarget(targetRow, targetCol)) {
+            break;
+        }
+        ShotResult answer = playerFleet.fire(targetRow, targetCol);
+        computer->recordShot(targetRow, targetCol, answer);
+        replay.shots.push_back(static_cast<uint8_t>(targetRow * colCount + targetCol));
+        if (playerFleet.defeated()) {
+            std::cout << "Computer wins!" << std::endl;
+        }
+        computerTurn = answer != ShotResult::MISS;
+    }
+    if (playerFleet.defeated() || opponentFleet.defeated()) {
+        saveReplay();
+    }
+}
+
+void BattleSession::publish() {
+    // Same sizes every time: copying the marks does not allocate
+    BattleSnapshot& next = snapshots.back();
+    for (int side = 0; side < 2; ++side) {
+        const FleetState& fleet = side == 0 ? playerFleet : opponentFleet;
+        for (int row = 0; row < rules.rows; ++row) {
+            for (int col = 0; col < colCount; ++col) {
+                next.marks[side][row * colCount + col] = fleet.mark(row, col);
+            }
+        }
+    }
+    next.winner = opponentFleet.defeated() ? 0 : playerFleet.defeated() ? 1 : -1;
+    next.answered = answered;
+    snapshots.publish();
+}
+
+void BattleSession::saveReplay() {
+    if (replayPath.empty()) {
+        return;
+    }
+    std::vector<int> shipLengths = rules.shipLengths;
+    std::sort(shipLengths.begin(), shipLengths.end(), std::greater<int>());
+    ReplayWriter writer;
+    if (!writer.open(replayPath, rules.rows, rules.cols, shipLengths) || !writer.write(replay) || !writer.close()) {
+        std::cerr << "Error writing " << replayPath << std::endl;
+    }
+}
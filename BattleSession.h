@@ -0,0 +1,82 @@
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "GameState.h"
+#include "Replay.h"
+#include "Rules.h"
+#include "Shooter.h"
+#include "SpscQueue.h"
+#include "TripleBuffer.h"
+
+// What the screen shows of a battle, as of one moment
+struct BattleSnapshot {
+    // Shots at each fleet, row-major: side 0 is the player's, side 1 the computer's
+    std::vector<CellMark> marks[2];
+    int winner = -1;        // side that won, -1 while the battle goes on
+    uint64_t answered = 0;  // player shots fully answered, computer turn included
+};
+
+// A battle against the computer, played on its own thread so the computer
+// can think as long as it likes without stalling the frame loop. The
+// render thread queues the player's shots and reads immutable snapshots;
+// both handoffs are lock-free and neither allocates. The game is saved to
+// `replayPath` (if not empty) by the battle thread when it ends, as long
+// as the replay format can hold it (no touching, at most 256 cells).
+class BattleSession {
+public:
+    // Without the computer, or with a player fleet that breaks the rules,
+    // the boards just show the player's fleet and shots are ignored
+    BattleSession(const Rules& rules, const std::vector<Ship>& playerShips, bool withComputer, uint64_t seed,
+                  std::string replayPath);
+    ~BattleSession();
+
+    BattleSession(const BattleSession&) = delete;
+    BattleSession& operator=(const BattleSession&) = delete;
+
+    // Render thread. shoot() is false if the shot was not queued.
+    bool shoot(int row, int col);
+    // True if snapshot() changed
+    bool update() { return snapshots.update(); }
+    const BattleSnapshot& snapshot() const { return snapshots.front(); }
+    // Shots queued that the snapshot does not answer yet: the battle
+    // thread is (or is about to be) working
+    bool busy() const { return snapshot().answered < sent; }
+
+private:
+    struct Input {
+        int row;
+        int col;
+    };
+
+    Rules rules;
+    int colCount;
+    bool withComputer;
+    std::string replayPath;
+
+    // Battle thread only, once started
+    FleetState playerFleet;
+    FleetState opponentFleet;
+    std::unique_ptr<Shooter> computer;
+    ReplayGame replay;
+    uint64_t answered = 0;
+
+    SpscQueue<Input, 64> inputs;
+    TripleBuffer<BattleSnapshot> snapshots;
+    uint64_t sent = 0;   // render thread
+
+    // Only for sleeping while there is nothing to do
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+
+    void run();
+    void playTurn(int row, int col);
+    void publish();
+    void saveReplay();
+};
@@ -0,0 +1,374 @@
+// Placement and generation hot paths. Board sizes are square (10, 12, 15,
+// 20); fleet density is the share of board cells covered by ships already
+// on the board, built from copies of the standard fleet. Game and server
+// benchmarks report heap allocations per iteration as "allocs", which
+// should stay 0 once warmed up.
+//
+//   SeaBattleBench --benchmark_out=bench.json --benchmark_out_format=json
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "AllocationCounter.h"
+#include "BattleSession.h"
+#include "DensityKernel.h"
+#include "FleetCorpus.h"
+#include "FleetGenerator.h"
+#include "FleetSampler.h"
+#include "GameState.h"
+#include "MatchHost.h"
+#include "Profiler.h"
+#include "Random.h"
+#include "Simulator.h"
+#include "TargetingEngine.h"
+
+namespace {
+
+// Ship lengths covering at least `percent` of a size x size board
+std::vector<int> densityFleet(int size, int percent) {
+    std::vector<int> lengths;
+    const int wanted = size * size * percent / 100;
+    int covered = 0;
+    while (covered < wanted) {
+        for (int length : standardFleet()) {
+            if (covered >= wanted) {
+                break;
+            }
+            lengths.push_back(length);
+            covered += length;
+        }
+    }
+    return lengths;
+}
+
+bool makeFleet(int size, int percent, std::vector<Ship>& ships) {
+    ships.clear();
+    std::vector<ShipPlacement> placements;
+    FleetGenerator generator(size, size, densityFleet(size, percent), 12345);
+    if (generator.generate(placements) != FleetResult::OK) {
+        return false;
+    }
+    for (const auto& placement : placements) {
+        ships.push_back({ placement.length, placement.row, placement.col, placement.direction });
+    }
+    return true;
+}
+
+// Counted inside the loop body only: starting and stopping the benchmark
+// loop allocates a little of its own
+void reportAllocations(benchmark::State& state, uint64_t allocations) {
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+struct PlacementQuery {
+    int row;
+    int col;
+    int length;
+    ShipDirection direction;
+};
+
+std::vector<PlacementQuery> makeQueries(int size) {
+    std::vector<PlacementQuery> queries(1024);
+    Rng rng(99);
+    for (auto& query : queries) {
+        query.row = static_cast<int>(rng.below(size));
+        query.col = static_cast<int>(rng.below(size));
+        query.length = 1 + static_cast<int>(rng.below(4));
+        query.direction = rng.below(2) ? ShipDirection::VERTICAL : ShipDirection::HORIZONTAL;
+    }
+    return queries;
+}
+
+template <bool (*Check)(const std::vector<Ship>&, int, int, int, ShipDirection, int, int)>
+void placementCheck(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    std::vector<Ship> ships;
+    if (!makeFleet(size, static_cast<int>(state.range(1)), ships)) {
+        state.SkipWithError("fleet does not fit");
+        return;
+    }
+    const std::vector<PlacementQuery> queries = makeQueries(size);
+    size_t next = 0;
+    for (auto _ : state) {
+        const PlacementQuery& query = queries[next];
+        next = (next + 1) & (queries.size() - 1);
+        benchmark::DoNotOptimize(Check(ships, query.row, query.col, query.length, query.direction, size, size));
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["ships"] = static_cast<double>(ships.size());
+}
+
+void BM_CanPlaceShip(benchmark::State& state) {
+    placementCheck<canPlaceShip>(state);
+}
+
+void BM_CanPlaceShipWithGap(benchmark::State& state) {
+    placementCheck<canPlaceShipWithGap>(state);
+}
+
+void BM_AutoPlaceShips(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    std::vector<Ship> ships;
+    uint64_t seed = 1;
+    for (auto _ : state) {
+        autoPlaceShipsInPlacement(ships, size, size, seed++);
+        benchmark::DoNotOptimize(ships.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Same generator as autoPlaceShipsInPlacement, with denser fleets
+void BM_GenerateFleet(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    FleetGenerator generator(size, size, densityFleet(size, static_cast<int>(state.range(1))), 1);
+    std::vector<ShipPlacement> fleet;
+    uint64_t failed = 0;
+    for (auto _ : state) {
+        if (generator.generate(fleet) != FleetResult::OK) {
+            ++failed;
+        }
+        benchmark::DoNotOptimize(fleet.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["failed"] = static_cast<double>(failed);
+}
+
+// Canonical corpus key of a classic layout: the smallest of its 8 mirror images
+void BM_CanonicalKey(benchmark::State& state) {
+    FleetGenerator generator(10, 10, standardFleet(), 3);
+    BoardSymmetries symmetries(10, 10);
+    std::vector<CorpusKey> keys;
+    std::vector<ShipPlacement> fleet;
+    for (int i = 0; i < 1024; ++i) {
+        generator.generate(fleet);
+        keys.push_back(layoutKey(fleet, 10));
+    }
+    size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(symmetries.canonical(keys[next++ & 1023]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Exactly uniform classic layout from the tables `SeaBattleCli layouts`
+// cached in the working directory. Skipped without them: counting takes
+// about a minute and writes some 190 MB, which a benchmark run should not.
+void BM_UniformFleet(benchmark::State& state) {
+    Rules rules;
+    FleetSampler sampler;
+    std::string error;
+    if (!sampler.openCached(rules, FleetSampler::defaultCachePath(rules), error)) {
+        state.SkipWithError("no cached layout tables, run `SeaBattleCli layouts` first");
+        return;
+    }
+    Rng rng(5);
+    std::vector<ShipPlacement> fleet;
+    for (auto _ : state) {
+        sampler.sample(rng, fleet);
+        benchmark::DoNotOptimize(fleet.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// A whole game on a FleetState, every shot then taken back again: the
+// make/unmake pair a search runs at every node
+void BM_FireAndUndo(benchmark::State& state) {
+    const int size = static_cast<int>(state.range(0));
+    std::vector<Ship> ships;
+    autoPlaceShipsInPlacement(ships, size, size, 5);
+    FleetState fleet(size, size);
+    fleet.setFleet(ships);
+    std::vector<int> order(size * size);
+    Rng rng(11);
+    for (int i = 0; i < size * size; ++i) {
+        const int j = static_cast<int>(rng.below(i + 1));
+        order[i] = order[j];
+        order[j] = i;
+    }
+    uint64_t allocations = 0;
+    for (auto _ : state) {
+        const uint64_t before = allocationCount();
+        for (int cell : order) {
+            benchmark::DoNotOptimize(fleet.fire(cell / size, cell % size));
+        }
+        for (size_t i = 0; i < order.size(); ++i) {
+            fleet.undo();
+        }
+        allocations += allocationCount() - before;
+    }
+    state.SetItemsProcessed(state.iterations() * order.size());
+    reportAllocations(state, allocations);
+}
+
+// One simulated game: new fleet on a reused FleetState, shooter reset.
+// shooter: 0 random, 1 probability, 2 density, 3 endgame (ShooterKind order).
+// The endgame shooter searches up to 5 ms per move near the end of a game.
+void BM_PlayGame(benchmark::State& state) {
+    const ShooterKind kind = static_cast<ShooterKind>(state.range(0));
+    std::unique_ptr<Shooter> shooter = makeShooter(kind, Rules(), 1);
+    std::vector<std::vector<Ship>> fleets(64);
+    for (size_t i = 0; i < fleets.size(); ++i) {
+        autoPlaceShipsInPlacement(fleets[i], 10, 10, i);
+    }
+    FleetState fleet;
+    for (const auto& ships : fleets) {
+        fleet.setFleet(ships);
+        playGame(*shooter, fleet);
+    }
+    size_t next = 0;
+    uint64_t allocations = 0;
+    for (auto _ : state) {
+        const uint64_t before = allocationCount();
+        fleet.setFleet(fleets[next]);
+        next = (next + 1) & (fleets.size() - 1);
+        benchmark::DoNotOptimize(playGame(*shooter, fleet));
+        allocations += allocationCount() - before;
+    }
+    state.SetItemsProcessed(state.iterations());
+    reportAllocations(state, allocations);
+}
+
+// One whole match against the computer through MatchHost, the client side
+// played by a TargetingEngine
+void BM_HostedMatch(benchmark::State& state) {
+    bool over = false;
+    ShotResult lastResult = ShotResult::MISS;
+    MatchHost host([&](ClientId, const Message& message) {
+        if (message.type == MessageType::GAME_OVER) {
+            over = true;
+        }
+        else if (message.type == MessageType::SHOT_RESULT && message.flags == 0) {
+            lastResult = message.result;
+        }
+    }, 1);
+    TargetingEngine client(protocolRows, protocolCols, standardFleet(), 2);
+    std::vector<Message> fleets(64);
+    for (size_t i = 0; i < fleets.size(); ++i) {
+        std::vector<Ship> ships;
+        autoPlaceShipsInPlacement(ships, protocolRows, protocolCols, i);
+        fleets[i] = fleetMessage(0, Opponent::COMPUTER, ships);
+    }
+    auto playMatch = [&](const Message& fleet) {
+        over = false;
+        client.reset();
+        host.receive(1, fleet);
+        int row = 0;
+        int col = 0;
+        while (!over && client.chooseTarget(row, col)) {
+            host.receive(1, shotMessage(0, row, col));
+            client.recordShot(row, col, lastResult);
+        }
+    };
+    for (const auto& fleet : fleets) {
+        playMatch(fleet);
+    }
+    size_t next = 0;
+    uint64_t allocations = 0;
+    for (auto _ : state) {
+        const uint64_t before = allocationCount();
+        playMatch(fleets[next]);
+        next = (next + 1) & (fleets.size() - 1);
+        allocations += allocationCount() - before;
+    }
+    state.SetItemsProcessed(state.iterations());
+    reportAllocations(state, allocations);
+}
+
+// One density recount, standard fleet, `percent` of the cells known water
+void BM_DensityKernel(benchmark::State& state) {
+    const SimdLevel level = static_cast<SimdLevel>(state.range(0));
+    if (level > detectSimdLevel()) {
+        state.SkipWithError("SIMD level not supported here");
+        return;
+    }
+    const int size = static_cast<int>(state.range(1));
+    DensityInput input;
+    input.rows = size;
+    input.cols = size;
+    Rng rng(7);
+    for (int r = 0; r < size; ++r) {
+        for (int c = 0; c < size; ++c) {
+            if (rng.below(100) >= 20) {
+                input.freeRows[r] |= static_cast<uint16_t>(1u << c);
+            }
+        }
+    }
+    input.hitRows[size / 2] = static_cast<uint16_t>(input.freeRows[size / 2] & (1u << (size / 2)));
+    for (int length : standardFleet()) {
+        ++input.remaining[length];
+    }
+    DensityMap map;
+    for (auto _ : state) {
+        computeDensity(input, map, level);
+        benchmark::DoNotOptimize(map.all[0]);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetLabel(simdLevelName(level));
+}
+
+// Cost of one ProfileScope, profiler off (0) or recording (1). A frame runs
+// about ten of them.
+void BM_ProfileScope(benchmark::State& state) {
+    Profiler::setEnabled(state.range(0) != 0);
+    uint64_t work = 0;
+    for (auto _ : state) {
+        ProfileScope scope("BM_ProfileScope");
+        benchmark::DoNotOptimize(++work);
+    }
+    Profiler::setEnabled(false);
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Render thread side of the battle handoff: take the newest snapshot while
+// another thread keeps publishing, as the battle thread does mid-turn
+void BM_SnapshotHandoff(benchmark::State& state) {
+    BattleSnapshot initial;
+    initial.marks[0].assign(100, CellMark::NONE);
+    initial.marks[1].assign(100, CellMark::NONE);
+    TripleBuffer<BattleSnapshot> snapshots(initial);
+    std::atomic<bool> done{ false };
+    std::thread writer([&] {
+        uint64_t version = 0;
+        while (!done.load(std::memory_order_relaxed)) {
+            BattleSnapshot& next = snapshots.back();
+            next.marks[0][version % 100] = CellMark::MISS;
+            next.answered = ++version;
+            snapshots.publish();
+        }
+    });
+    int64_t fresh = 0;
+    for (auto _ : state) {
+        fresh += snapshots.update();
+        benchmark::DoNotOptimize(snapshots.front().answered);
+    }
+    done = true;
+    writer.join();
+    state.SetItemsProcessed(state.iterations());
+    state.counters["fresh"] = benchmark::Counter(static_cast<double>(fresh) / state.iterations());
+}
+
+void placementArgs(benchmark::internal::Benchmark* benchmark) {
+    benchmark->ArgNames({ "size", "density" });
+    for (int size : { 10, 12, 15, 20 }) {
+        for (int density : { 0, 10, 20 }) {
+            benchmark->Args({ size, density });
+        }
+    }
+}
+
+}
+
+BENCHMARK(BM_CanPlaceShip)->Apply(placementArgs);
+BENCHMARK(BM_CanPlaceShipWithGap)->Apply(placementArgs);
+BENCHMARK(BM_AutoPlaceShips)->ArgName("size")->Arg(10)->Arg(12)->Arg(15)->Arg(20);
+BENCHMARK(BM_GenerateFleet)->Apply(placementArgs);
+// Tournament boards: the cost per layout should grow with the area, not faster
+BENCHMARK(BM_GenerateFleet)->ArgNames({ "size", "density" })->ArgsProduct({ { 50, 100 }, { 10, 20 } });
+BENCHMARK(BM_CanonicalKey);
+BENCHMARK(BM_UniformFleet);
+BENCHMARK(BM_FireAndUndo)->ArgName("size")->Arg(10)->Arg(12)->Arg(15)->Arg(20);
+BENCHMARK(BM_PlayGame)->ArgName("shooter")->DenseRange(0, 3);
+BENCHMARK(BM_HostedMatch);
+BENCHMARK(BM_DensityKernel)->ArgNames({ "simd", "size" })->ArgsProduct({ { 0, 1, 2 }, { 10, 12, 15 } });
+BENCHMARK(BM_ProfileScope)->ArgName("enabled")->Arg(0)->Arg(1);
+BENCHMARK(BM_SnapshotHandoff)->UseRealTime();
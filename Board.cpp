@@ -0,0 +1,101 @@
+#include "Board.h"
+#include <algorithm>
+
+namespace {
+
+// Bits [offset, offset + count) of a single word, count in 1..64
+uint64_t wordMask(int offset, int count) {
+    const uint64_t bits = (count == 64) ? ~0ull : ((1ull << count) - 1);
+    return bits << offset;
+}
+
+}
+
+Board::Board(int rows, int cols)
+    : rowCount(rows), colCount(cols),
+      occupied((rows * cols + 63) / 64, 0), blocked((rows * cols + 63) / 64, 0) {
+}
+
+bool Board::fits(int row, int col, int length, ShipDirection direction) const {
+    if (row < 0 || col < 0 || length <= 0) {
+        return false;
+    }
+    if (direction == ShipDirection::HORIZONTAL) {
+        return row < rowCount && col + length <= colCount;
+    }
+    return col < colCount && row + length <= rowCount;
+}
+
+bool Board::canPlace(int row, int col, int length, ShipDirection direction) const {
+    return fits(row, col, length, direction) && !shipIntersects(occupied, row, col, length, direction);
+}
+
+bool Board::canPlaceWithGap(int row, int col, int length, ShipDirection direction) const {
+    return fits(row, col, length, direction) && !shipIntersects(blocked, row, col, length, direction);
+}
+
+void Board::place(int row, int col, int length, ShipDirection direction) {
+    const int lastRow = (direction == ShipDirection::VERTICAL) ? row + length - 1 : row;
+    const int lastCol = (direction == ShipDirection::HORIZONTAL) ? col + length - 1 : col;
+
+    // Ship cells
+    for (int r = std::max(row, 0); r <= std::min(lastRow, rowCount - 1); ++r) {
+        const int first = std::max(col, 0);
+        const int last = std::min(lastCol, colCount - 1);
+        if (first <= last) {
+            setRange(occupied, r * colCount + first, last - first + 1);
+        }
+    }
+
+    // Ship cells plus the surrounding halo, one row segment at a time
+    const int haloFirstCol = std::max(col - 1, 0);
+    const int haloLastCol = std::min(lastCol + 1, colCount - 1);
+    if (haloFirstCol > haloLastCol) {
+        return;
+    }
+    for (int r = std::max(row - 1, 0); r <= std::min(lastRow + 1, rowCount - 1); ++r) {
+        setRange(blocked, r * colCount + haloFirstCol, haloLastCol - haloFirstCol + 1);
+    }
+}
+
+void Board::clear() {
+    std::fill(occupied.begin(), occupied.end(), 0);
+    std::fill(blocked.begin(), blocked.end(), 0);
+}
+
+bool Board::anyInRange(const std::vector<uint64_t>& mask, int first, int count) {
+    while (count > 0) {
+        const int offset = first & 63;
+        const int n = std::min(count, 64 - offset);
+        if (mask[first >> 6] & wordMask(offset, n)) {
+            return true;
+        }
+        first += n;
+        count -= n;
+    }
+    return false;
+}
+
+void Board::setRange(std::vector<uint64_t>& mask, int first, int count) {
+    while (count > 0) {
+        const int offset = first & 63;
+        const int n = std::min(count, 64 - offset);
+        mask[first >> 6] |= wordMask(offset, n);
+        first += n;
+        count -= n;
+    }
+}
+
+bool Board::shipIntersects(const std::vector<uint64_t>& mask, int row, int col, int length, ShipDirection direction) const {
+    const int first = row * colCount + col;
+    if (direction == ShipDirection::HORIZONTAL) {
+        // A horizontal ship is one contiguous run of bits
+        return anyInRange(mask, first, length);
+    }
+    for (int i = 0; i < length; ++i) {
+        if (testBit(mask, first + i * colCount)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+enum class ShipDirection {
+    HORIZONTAL,
+    VERTICAL
+};
+
+enum class ShotResult {
+    MISS,
+    HIT,
+    SUNK
+};
+
+// Occupancy grid of one player's fleet, stored as row-major bitmasks.
+// `occupied` holds the ship cells, `blocked` holds the ship cells plus the
+// one-cell "no-touch" halo around every ship. A 10x10 board fits in two
+// 64-bit words; bigger boards simply use more words.
+class Board {
+public:
+    Board(int rows = 10, int cols = 10);
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+
+    // True when the whole ship lies inside the board
+    bool fits(int row, int col, int length, ShipDirection direction) const;
+    // Ship fits and overlaps no other ship
+    bool canPlace(int row, int col, int length, ShipDirection direction) const;
+    // Ship fits, overlaps no other ship and touches none, not even diagonally
+    bool canPlaceWithGap(int row, int col, int length, ShipDirection direction) const;
+
+    // Marks the ship cells and its halo. Cells outside the board are ignored.
+    void place(int row, int col, int length, ShipDirection direction);
+
+    bool isOccupied(int row, int col) const { return testBit(occupied, row * colCount + col); }
+    bool isBlocked(int row, int col) const { return testBit(blocked, row * colCount + col); }
+
+    void clear();
+
+private:
+    int rowCount;
+    int colCount;
+    std::vector<uint64_t> occupied;
+    std::vector<uint64_t> blocked;
+
+    static bool testBit(const std::vector<uint64_t>& mask, int bit) {
+        return (mask[bit >> 6] >> (bit & 63)) & 1u;
+    }
+    static bool anyInRange(const std::vector<uint64_t>& mask, int first, int count);
+    static void setRange(std::vector<uint64_t>& mask, int first, int count);
+
+    bool shipIntersects(const std::vector<uint64_t>& mask, int row, int col, int length, ShipDirection direction) const;
+};
@@ -0,0 +1,307 @@
+#include "BoardRenderer.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include "Profiler.h"
+
+namespace {
+
+// Cells covered by one copy of the board image
+const int imageCells = 10;
+// Closest label centres, in pixels
+const float minLabelSpacingX = 40.0f;
+const float minLabelSpacingY = 25.0f;
+
+std::string columnLabel(int col, int cols) {
+    return cols <= 26 ? std::string(1, static_cast<char>('A' + col)) : std::to_string(col + 1);
+}
+
+// Every step-th cell gets a label, the step chosen so they stay apart
+int labelStep(float cellSize, float spacing) {
+    return std::max(1, static_cast<int>(std::ceil(spacing / cellSize)));
+}
+
+// Coordinate labels, centred on their cell's row or column
+const unsigned labelSize = 20;
+
+}
+
+sf::Color shipColor(int length) {
+    switch (length) {
+    case 4: return sf::Color::Cyan;
+    case 3: return sf::Color::Magenta;
+    case 2: return sf::Color::Blue;
+    default: return sf::Color::Green;
+    }
+}
+
+void drawBoardImage(sf::RenderTarget& target, const sf::Texture& texture, const BoardLayout& layout) {
+    sf::Sprite sprite(texture);
+    sprite.setScale(layout.cols * layout.cellWidth / texture.getSize().x, layout.rows * layout.cellHeight / texture.getSize().y);
+    sprite.setPosition(layout.left, layout.top);
+    target.draw(sprite);
+}
+
+void drawBoardImage(sf::RenderTarget& target, const sf::Texture& texture, const BoardView& view) {
+    const BoardLayout& layout = view.layout();
+    const CellRange visible = view.visibleCells();
+    const sf::Vector2f textureSize(static_cast<float>(texture.getSize().x), static_cast<float>(texture.getSize().y));
+    sf::VertexArray quads(sf::Quads);
+    for (int blockRow = visible.firstRow / imageCells * imageCells; blockRow < visible.lastRow; blockRow += imageCells) {
+        for (int blockCol = visible.firstCol / imageCells * imageCells; blockCol < visible.lastCol; blockCol += imageCells) {
+            // Blocks cut by the board edge show the matching part of the image
+            const int blockRows = std::min(imageCells, layout.rows - blockRow);
+            const int blockCols = std::min(imageCells, layout.cols - blockCol);
+            const float left = layout.left + blockCol * layout.cellWidth;
+            const float top = layout.top + blockRow * layout.cellHeight;
+            const float right = left + blockCols * layout.cellWidth;
+            const float bottom = top + blockRows * layout.cellHeight;
+            const float texRight = textureSize.x * blockCols / imageCells;
+            const float texBottom = textureSize.y * blockRows / imageCells;
+            quads.append(sf::Vertex(sf::Vector2f(left, top), sf::Vector2f(0, 0)));
+            quads.append(sf::Vertex(sf::Vector2f(right, top), sf::Vector2f(texRight, 0)));
+            quads.append(sf::Vertex(sf::Vector2f(right, bottom), sf::Vector2f(texRight, texBottom)));
+            quads.append(sf::Vertex(sf::Vector2f(left, bottom), sf::Vector2f(0, texBottom)));
+        }
+    }
+    target.draw(quads, sf::RenderStates(&texture));
+}
+
+void addCoordinateLabels(TextBatch& batch, const BoardLayout& layout) {
+    for (int i = 0; i < layout.cols; ++i) {
+        batch.addText(columnLabel(i, layout.cols), sf::Vector2f(layout.left + i * layout.cellWidth + layout.cellWidth / 2.0f, layout.top - 30), labelSize, sf::Color::White);
+    }
+    for (int i = 0; i < layout.rows; ++i) {
+        batch.addText(std::to_string(i + 1), sf::Vector2f(layout.left - 20, layout.top + i * layout.cellHeight + layout.cellHeight / 2.0f), labelSize, sf::Color::White);
+    }
+}
+
+void addCoordinateLabels(TextBatch& batch, const BoardView& view) {
+    const BoardLayout& layout = view.layout();
+    const sf::FloatRect& area = view.area();
+    const CellRange visible = view.visibleCells();
+    // Labels stay on the same cells while panning: multiples of the step
+    const int colStep = labelStep(layout.cellWidth, minLabelSpacingX);
+    for (int i = (visible.firstCol + colStep - 1) / colStep * colStep; i < visible.lastCol; i += colStep) {
+        const float x = layout.left + i * layout.cellWidth + layout.cellWidth / 2.0f;
+        if (x >= area.left && x <= area.left + area.width) {
+            batch.addText(columnLabel(i, layout.cols), sf::Vector2f(x, area.top - 30), labelSize, sf::Color::White);
+        }
+    }
+    const int rowStep = labelStep(layout.cellHeight, minLabelSpacingY);
+    for (int i = (visible.firstRow + rowStep - 1) / rowStep * rowStep; i < visible.lastRow; i += rowStep) {
+        const float y = layout.top + i * layout.cellHeight + layout.cellHeight / 2.0f;
+        if (y >= area.top && y <= area.top + area.height) {
+            batch.addText(std::to_string(i + 1), sf::Vector2f(area.left - 20, y), labelSize, sf::Color::White);
+        }
+    }
+}
+
+BoardView::BoardView(sf::FloatRect area, int rows, int cols)
+    : screenArea(area),
+      rows(rows),
+      cols(cols),
+      maxScale(std::max(1.0f, std::min(rows, cols) / static_cast<float>(imageCells))) {
+    place();
+}
+
+CellRange BoardView::visibleCells() const {
+    CellRange range;
+    range.firstRow = std::max(0, static_cast<int>(offset.y / placement.cellHeight));
+    range.lastRow = std::min(rows, static_cast<int>(std::ceil((offset.y + screenArea.height) / placement.cellHeight)));
+    range.firstCol = std::max(0, static_cast<int>(offset.x / placement.cellWidth));
+    range.lastCol = std::min(cols, static_cast<int>(std::ceil((offset.x + screenArea.width) / placement.cellWidth)));
+    return range;
+}
+
+sf::View BoardView::clipView(sf::Vector2u targetSize) const {
+    sf::View view(screenArea);
+    view.setViewport(sf::FloatRect(screenArea.left / targetSize.x, screenArea.top / targetSize.y,
+                                   screenArea.width / targetSize.x, screenArea.height / targetSize.y));
+    return view;
+}
+
+bool BoardView::cellAt(sf::Vector2f point, int& row, int& col) const {
+    if (!screenArea.contains(point)) {
+        return false;
+    }
+    row = std::min(rows - 1, static_cast<int>((point.y - placement.top) * inverseCell.y));
+    col = std::min(cols - 1, static_cast<int>((point.x - placement.left) * inverseCell.x));
+    return true;
+}
+
+bool BoardView::zoom(float factor, sf::Vector2f anchor) {
+    const float newScale = std::max(1.0f, std::min(maxScale, scale * factor));
+    if (newScale == scale) {
+        return false;
+    }
+    // Board position under the anchor, in cells, before and after
+    const float anchorCol = (anchor.x - placement.left) / placement.cellWidth;
+    const float anchorRow = (anchor.y - placement.top) / placement.cellHeight;
+    scale = newScale;
+    place();
+    offset.x = anchorCol * placement.cellWidth - (anchor.x - screenArea.left);
+    offset.y = anchorRow * placement.cellHeight - (anchor.y - screenArea.top);
+    place();
+    return true;
+}
+
+bool BoardView::pan(sf::Vector2f delta) {
+    const sf::Vector2f old = offset;
+    offset -= delta;
+    place();
+    return offset != old;
+}
+
+void BoardView::place() {
+    placement.cellWidth = screenArea.width / cols * scale;
+    placement.cellHeight = screenArea.height / rows * scale;
+    inverseCell = sf::Vector2f(1.0f / placement.cellWidth, 1.0f / placement.cellHeight);
+    placement.rows = rows;
+    placement.cols = cols;
+    // The board never scrolls past its edges
+    offset.x = std::max(0.0f, std::min(offset.x, cols * placement.cellWidth - screenArea.width));
+    offset.y = std::max(0.0f, std::min(offset.y, rows * placement.cellHeight - screenArea.height));
+    placement.left = screenArea.left - offset.x;
+    placement.top = screenArea.top - offset.y;
+}
+
+bool StaticLayer::create(unsigned width, unsigned height) {
+    if (!texture.create(width, height)) {
+        return false;
+    }
+    texture.clear(sf::Color::Transparent);
+    return true;
+}
+
+void StaticLayer::clear() {
+    texture.clear(sf::Color::Transparent);
+}
+
+void StaticLayer::finish() {
+    texture.display();
+    sprite.setTexture(texture.getTexture(), true);
+}
+
+void StaticLayer::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    ProfileScope scope("StaticLayer::draw");
+    target.draw(sprite, states);
+    Profiler::countDrawCalls();
+}
+
+CellBatch::CellBatch()
+    : buffer(sf::Quads, sf::VertexBuffer::Static), useBuffer(sf::VertexBuffer::isAvailable()) {
+}
+
+void CellBatch::clear() {
+    vertices.clear();
+}
+
+void CellBatch::reserve(size_t quads) {
+    vertices.reserve(quads * 4);
+    if (useBuffer && buffer.getVertexCount() < quads * 4 && !buffer.create(quads * 4)) {
+        useBuffer = false;
+    }
+}
+
+void CellBatch::addCell(const BoardLayout& layout, float row, float col, sf::Color fill, bool outlined, float sizeFraction) {
+    const float left = layout.left + col * layout.cellWidth;
+    const float top = layout.top + row * layout.cellHeight;
+    const float width = layout.cellWidth * sizeFraction;
+    const float height = layout.cellHeight * sizeFraction;
+    if (outlined) {
+        // The outline is a black quad 1px bigger on every side, painted first
+        addQuad(left - 1, top - 1, width + 2, height + 2, sf::Color::Black);
+    }
+    addQuad(left, top, width, height, fill);
+}
+
+void CellBatch::addShips(const BoardLayout& layout, const std::vector<Ship>& ships) {
+    for (const auto& ship : ships) {
+        for (int i = 0; i < ship.length; ++i) {
+            const int row = ship.startRow + (ship.direction == ShipDirection::VERTICAL ? i : 0);
+            const int col = ship.startCol + (ship.direction == ShipDirection::HORIZONTAL ? i : 0);
+            addCell(layout, static_cast<float>(row), static_cast<float>(col), shipColor(ship.length), true);
+        }
+    }
+}
+
+void CellBatch::addShips(const BoardLayout& layout, const std::vector<Ship>& ships, const CellRange& visible) {
+    for (const auto& ship : ships) {
+        for (int i = 0; i < ship.length; ++i) {
+            const int row = ship.startRow + (ship.direction == ShipDirection::VERTICAL ? i : 0);
+            const int col = ship.startCol + (ship.direction == ShipDirection::HORIZONTAL ? i : 0);
+            if (visible.contains(row, col)) {
+                addCell(layout, static_cast<float>(row), static_cast<float>(col), shipColor(ship.length), true);
+            }
+        }
+    }
+}
+
+void CellBatch::addMarks(const BoardLayout& layout, const FleetState& fleet) {
+    for (int row = 0; row < fleet.rows(); ++row) {
+        for (int col = 0; col < fleet.cols(); ++col) {
+            addMark(layout, row, col, fleet.mark(row, col));
+        }
+    }
+}
+
+void CellBatch::addMarks(const BoardLayout& layout, const std::vector<CellMark>& marks) {
+    for (int row = 0; row < layout.rows; ++row) {
+        for (int col = 0; col < layout.cols; ++col) {
+            addMark(layout, row, col, marks[row * layout.cols + col]);
+        }
+    }
+}
+
+void CellBatch::addMarks(const BoardLayout& layout, const std::vector<CellMark>& marks, const CellRange& visible) {
+    for (int row = visible.firstRow; row < visible.lastRow; ++row) {
+        for (int col = visible.firstCol; col < visible.lastCol; ++col) {
+            addMark(layout, row, col, marks[row * layout.cols + col]);
+        }
+    }
+}
+
+void CellBatch::addMark(const BoardLayout& layout, int row, int col, CellMark mark) {
+    if (mark == CellMark::HIT) {
+        addCell(layout, static_cast<float>(row), static_cast<float>(col), sf::Color(255, 0, 0, 180), false);
+    }
+    else if (mark == CellMark::MISS) {
+        addCell(layout, row + 0.4f, col + 0.4f, sf::Color::Black, false, 0.2f);
+    }
+}
+
+void CellBatch::commit() {
+    ProfileScope scope("CellBatch::commit");
+    if (!useBuffer) {
+        return;
+    }
+    if (buffer.getVertexCount() < vertices.size() && !buffer.create(vertices.size())) {
+        useBuffer = false;
+        return;
+    }
+    if (!vertices.empty()) {
+        buffer.update(vertices.data(), vertices.size(), 0);
+    }
+}
+
+void CellBatch::addQuad(float left, float top, float width, float height, sf::Color color) {
+    vertices.emplace_back(sf::Vector2f(left, top), color);
+    vertices.emplace_back(sf::Vector2f(left + width, top), color);
+    vertices.emplace_back(sf::Vector2f(left + width, top + height), color);
+    vertices.emplace_back(sf::Vector2f(left, top + height), color);
+}
+
+void CellBatch::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    if (vertices.empty()) {
+        return;
+    }
+    ProfileScope scope("CellBatch::draw");
+    if (useBuffer) {
+        target.draw(buffer, 0, vertices.size(), states);
+    }
+    else {
+        target.draw(vertices.data(), vertices.size(), sf::Quads, states);
+    }
+    Profiler::countDrawCalls();
+}
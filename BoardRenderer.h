@@ -0,0 +1,138 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include "GameState.h"
+#include "TextBatch.h"
+
+sf::Color shipColor(int length);
+
+// Where one board sits on screen
+struct BoardLayout {
+    float left;
+    float top;
+    float cellWidth;
+    float cellHeight;
+    int rows;
+    int cols;
+
+    sf::FloatRect bounds() const { return sf::FloatRect(left, top, cols * cellWidth, rows * cellHeight); }
+};
+
+// Cells [firstRow, lastRow) x [firstCol, lastCol) of a board
+struct CellRange {
+    int firstRow;
+    int lastRow;
+    int firstCol;
+    int lastCol;
+
+    bool contains(int row, int col) const { return row >= firstRow && row < lastRow && col >= firstCol && col < lastCol; }
+};
+
+// A board shown in a fixed screen area. Unzoomed the whole board fits the
+// area, as on the classic 10x10 screens; zoomed in (large boards only) the
+// board is panned under the area, only the cells in view are drawn and
+// drawing is clipped to the area through clipView().
+class BoardView {
+public:
+    BoardView(sf::FloatRect area, int rows, int cols);
+
+    // Screen placement of the whole board at the current zoom and pan
+    const BoardLayout& layout() const { return placement; }
+    const sf::FloatRect& area() const { return screenArea; }
+    // Cells at least partly inside the area
+    CellRange visibleCells() const;
+    // Same coordinates as the default view of a `targetSize` target, but
+    // nothing is drawn outside the area
+    sf::View clipView(sf::Vector2u targetSize) const;
+
+    // False if the point is outside the area
+    bool cellAt(sf::Vector2f point, int& row, int& col) const;
+
+    // Keeps the board point under `anchor` in place; zoom 1 is the whole
+    // board and at the deepest zoom about 10 cells fit across. Both return
+    // false if nothing moved.
+    bool zoom(float factor, sf::Vector2f anchor);
+    bool pan(sf::Vector2f delta);
+
+private:
+    sf::FloatRect screenArea;
+    int rows;
+    int cols;
+    float scale = 1.0f;
+    float maxScale;
+    sf::Vector2f offset;   // board pixels scrolled out left of and above the area
+    BoardLayout placement;
+    // Cells per pixel, so cellAt() multiplies instead of dividing
+    sf::Vector2f inverseCell;
+
+    void place();
+};
+
+// Board image stretched over the layout
+void drawBoardImage(sf::RenderTarget& target, const sf::Texture& texture, const BoardLayout& layout);
+// The image covers 10x10 cells and is tiled over bigger boards, one quad
+// per block in view (the target should use the view's clipView)
+void drawBoardImage(sf::RenderTarget& target, const sf::Texture& texture, const BoardView& view);
+// Column letters above the board and row numbers left of it
+void addCoordinateLabels(TextBatch& batch, const BoardLayout& layout);
+// Same for the cells in view, thinned out so labels never overlap; columns
+// are numbered instead of lettered past 26
+void addCoordinateLabels(TextBatch& batch, const BoardView& view);
+
+// Everything that never changes on a screen (board images, ...) drawn once into an offscreen texture and then shown with a
+// single draw call per frame.
+class StaticLayer : public sf::Drawable {
+public:
+    bool create(unsigned width, unsigned height);
+    // Empties the canvas for drawing the content again
+    void clear();
+
+    // Draw the static content here, then call finish()
+    sf::RenderTexture& canvas() { return texture; }
+    void finish();
+
+private:
+    sf::RenderTexture texture;
+    sf::Sprite sprite;
+
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+};
+
+// Solid-colour cells (ship parts, hits, misses) of any number of boards as one
+// quad batch. The vertices are rebuilt only when the caller marks the board
+// state as changed; drawing an unchanged batch is one draw call and, where
+// vertex buffers are supported, no upload.
+class CellBatch : public sf::Drawable {
+public:
+    CellBatch();
+
+    void clear();
+    // Room for `quads` quads in memory and on the GPU up front, so a batch
+    // that grows during a game never reallocates mid-frame
+    void reserve(size_t quads);
+
+    // Rectangle in cell units relative to the cell's top-left corner, with
+    // an optional 1px outline around it (like RectangleShape's outline)
+    void addCell(const BoardLayout& layout, float row, float col, sf::Color fill, bool outlined, float sizeFraction = 1.0f);
+    void addShips(const BoardLayout& layout, const std::vector<Ship>& ships);
+    // Only the ship cells inside `visible`
+    void addShips(const BoardLayout& layout, const std::vector<Ship>& ships, const CellRange& visible);
+    // Hits as red cells, misses as dots
+    void addMarks(const BoardLayout& layout, const FleetState& fleet);
+    // Same from row-major marks of a layout.rows x layout.cols board
+    void addMarks(const BoardLayout& layout, const std::vector<CellMark>& marks);
+    // Only the marks inside `visible`
+    void addMarks(const BoardLayout& layout, const std::vector<CellMark>& marks, const CellRange& visible);
+
+    // Uploads the rebuilt vertices; call once after the add* calls
+    void commit();
+
+private:
+    std::vector<sf::Vertex> vertices;
+    sf::VertexBuffer buffer;
+    bool useBuffer;
+
+    void addMark(const BoardLayout& layout, int row, int col, CellMark mark);
+    void addQuad(float left, float top, float width, float height, sf::Color color);
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+};
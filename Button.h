@@ -0,0 +1,54 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <string>
+#include "TextBatch.h"
+
+// Button Struct: drawn through the screen's TextBatch, which the scene
+// bakes again whenever a button reports `changed`
+struct Button {
+    static const unsigned characterSize = 24;
+
+    std::string label;
+    sf::Vector2f position;   // centre
+    sf::FloatRect bounds;
+    sf::Color defaultColor;
+    sf::Color hoverColor;
+    sf::Color pressedColor;
+    bool isPressed = false;
+    bool hovered = false;
+    // The caption looks different since the last addTo()
+    bool changed = true;
+
+    Button(const std::string& label, const sf::Font& font, sf::Color defaultColor, sf::Color hoverColor, sf::Color pressedColor, float x, float y)
+        : label(label), position(x, y), defaultColor(defaultColor), hoverColor(hoverColor), pressedColor(pressedColor) {
+        const sf::FloatRect textRect = measureText(font, label, characterSize);
+        const sf::Vector2f size(textRect.width + 20, textRect.height + 10); // Add some padding
+        bounds = sf::FloatRect(x - size.x / 2.0f, y - size.y / 2.0f, size.x, size.y);
+    }
+
+    // Keeps the size the button got for its first label
+    void setLabel(const std::string& text) {
+        label = text;
+        changed = true;
+    }
+    // Background and caption
+    void addTo(TextBatch& batch) {
+        batch.addRect(bounds, sf::Color(0, 0, 0, 150)); // Semi-transparent background
+        batch.addText(label, position, characterSize, color());
+        changed = false;
+    }
+    sf::Color color() const {
+        return isPressed ? pressedColor : hovered ? hoverColor : defaultColor;
+    }
+    // Called by InputLayer when the pointer enters or leaves the button
+    void setHovered(bool hover) {
+        const sf::Color before = color();
+        hovered = hover;
+        changed = changed || color() != before;
+    }
+    void setPressed(bool pressed) {
+        const sf::Color before = color();
+        isPressed = pressed;
+        changed = changed || color() != before;
+    }
+};
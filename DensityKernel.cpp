@@ -0,0 +1,247 @@
+#include "DensityKernel.h"
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define DENSITY_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// GCC and Clang compile the AVX2 kernel for AVX2 without building the whole
+// file that way; MSVC accepts the intrinsics anywhere
+#if defined(DENSITY_X86) && (defined(__GNUC__) || defined(__clang__))
+#define DENSITY_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define DENSITY_TARGET_AVX2
+#endif
+
+namespace {
+
+typedef uint16_t Grid[densityMaxSize][densityMaxSize];
+
+// Adds every vertical placement to `all` / `through`. `weights[length]` is
+// the weight of one placement of that length, 0 to skip the length.
+void verticalScalar(const uint16_t* freeRows, const uint16_t* hitRows, int rows, const uint16_t* weights, Grid& all, Grid& through) {
+    uint16_t freeLanes[densityMaxSize][densityMaxSize];
+    uint16_t hitLanes[densityMaxSize][densityMaxSize];
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < densityMaxSize; ++c) {
+            freeLanes[r][c] = ((freeRows[r] >> c) & 1) ? 0xffff : 0;
+            hitLanes[r][c] = ((hitRows[r] >> c) & 1) ? 0xffff : 0;
+        }
+    }
+    for (int length = 1; length <= rows; ++length) {
+        if (weights[length] == 0) {
+            continue;
+        }
+        for (int r = 0; r + length <= rows; ++r) {
+            for (int c = 0; c < densityMaxSize; ++c) {
+                uint16_t valid = freeLanes[r][c];
+                uint16_t hit = hitLanes[r][c];
+                for (int k = 1; k < length; ++k) {
+                    valid &= freeLanes[r + k][c];
+                    hit |= hitLanes[r + k][c];
+                }
+                const uint16_t add = valid & weights[length];
+                for (int k = 0; k < length; ++k) {
+                    all[r + k][c] += add;
+                    through[r + k][c] += add & hit;
+                }
+            }
+        }
+    }
+}
+
+#ifdef DENSITY_X86
+
+void verticalSse2(const uint16_t* freeRows, const uint16_t* hitRows, int rows, const uint16_t* weights, Grid& all, Grid& through) {
+    // Lanes 0-7 and 8-15 of a row are two independent halves
+    for (int half = 0; half < 2; ++half) {
+        const int shift = half * 8;
+        const __m128i laneBits = _mm_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128);
+        __m128i freeLanes[densityMaxSize];
+        __m128i hitLanes[densityMaxSize];
+        __m128i allSum[densityMaxSize];
+        __m128i throughSum[densityMaxSize];
+        for (int r = 0; r < rows; ++r) {
+            const __m128i freeBits = _mm_and_si128(_mm_set1_epi16(static_cast<short>(freeRows[r] >> shift)), laneBits);
+            const __m128i hitBits = _mm_and_si128(_mm_set1_epi16(static_cast<short>(hitRows[r] >> shift)), laneBits);
+            freeLanes[r] = _mm_cmpeq_epi16(freeBits, laneBits);
+            hitLanes[r] = _mm_cmpeq_epi16(hitBits, laneBits);
+            allSum[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&all[r][shift]));
+            throughSum[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&through[r][shift]));
+        }
+        for (int length = 1; length <= rows; ++length) {
+            if (weights[length] == 0) {
+                continue;
+            }
+            const __m128i weight = _mm_set1_epi16(static_cast<short>(weights[length]));
+            for (int r = 0; r + length <= rows; ++r) {
+                __m128i valid = freeLanes[r];
+                __m128i hit = hitLanes[r];
+                for (int k = 1; k < length; ++k) {
+                    valid = _mm_and_si128(valid, freeLanes[r + k]);
+                    hit = _mm_or_si128(hit, hitLanes[r + k]);
+                }
+                const __m128i add = _mm_and_si128(valid, weight);
+                const __m128i addHit = _mm_and_si128(add, hit);
+                for (int k = 0; k < length; ++k) {
+                    allSum[r + k] = _mm_add_epi16(allSum[r + k], add);
+                    throughSum[r + k] = _mm_add_epi16(throughSum[r + k], addHit);
+                }
+            }
+        }
+        for (int r = 0; r < rows; ++r) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&all[r][shift]), allSum[r]);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&through[r][shift]), throughSum[r]);
+        }
+    }
+}
+
+DENSITY_TARGET_AVX2 void verticalAvx2(const uint16_t* freeRows, const uint16_t* hitRows, int rows, const uint16_t* weights, Grid& all, Grid& through) {
+    const __m256i laneBits = _mm256_setr_epi16(1, 2, 4, 8, 16, 32, 64, 128, 256, 512, 1024, 2048, 4096, 8192, 16384, static_cast<short>(0x8000));
+    __m256i freeLanes[densityMaxSize];
+    __m256i hitLanes[densityMaxSize];
+    __m256i allSum[densityMaxSize];
+    __m256i throughSum[densityMaxSize];
+    for (int r = 0; r < rows; ++r) {
+        const __m256i freeBits = _mm256_and_si256(_mm256_set1_epi16(static_cast<short>(freeRows[r])), laneBits);
+        const __m256i hitBits = _mm256_and_si256(_mm256_set1_epi16(static_cast<short>(hitRows[r])), laneBits);
+        freeLanes[r] = _mm256_cmpeq_epi16(freeBits, laneBits);
+        hitLanes[r] = _mm256_cmpeq_epi16(hitBits, laneBits);
+        allSum[r] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(all[r]));
+        throughSum[r] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(through[r]));
+    }
+    for (int length = 1; length <= rows; ++length) {
+        if (weights[length] == 0) {
+            continue;
+        }
+        const __m256i weight = _mm256_set1_epi16(static_cast<short>(weights[length]));
+        for (int r = 0; r + length <= rows; ++r) {
+            __m256i valid = freeLanes[r];
+            __m256i hit = hitLanes[r];
+            for (int k = 1; k < length; ++k) {
+                valid = _mm256_and_si256(valid, freeLanes[r + k]);
+                hit = _mm256_or_si256(hit, hitLanes[r + k]);
+            }
+            const __m256i add = _mm256_and_si256(valid, weight);
+            const __m256i addHit = _mm256_and_si256(add, hit);
+            for (int k = 0; k < length; ++k) {
+                allSum[r + k] = _mm256_add_epi16(allSum[r + k], add);
+                throughSum[r + k] = _mm256_add_epi16(throughSum[r + k], addHit);
+            }
+        }
+    }
+    for (int r = 0; r < rows; ++r) {
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(all[r]), allSum[r]);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(through[r]), throughSum[r]);
+    }
+}
+
+bool cpuHasAvx2() {
+#ifdef _MSC_VER
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) {
+        return false;
+    }
+    __cpuid(info, 1);
+    // The OS must save the YMM registers too
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) {
+        return false;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+#endif
+
+void vertical(SimdLevel level, const uint16_t* freeRows, const uint16_t* hitRows, int rows, const uint16_t* weights, Grid& all, Grid& through) {
+#ifdef DENSITY_X86
+    if (level == SimdLevel::AVX2) {
+        verticalAvx2(freeRows, hitRows, rows, weights, all, through);
+        return;
+    }
+    if (level == SimdLevel::SSE2) {
+        verticalSse2(freeRows, hitRows, rows, weights, all, through);
+        return;
+    }
+#endif
+    verticalScalar(freeRows, hitRows, rows, weights, all, through);
+}
+
+// bits[r] bit c -> transposed[c] bit r
+void transposeBits(const uint16_t* bits, int rows, int cols, uint16_t* transposed) {
+    for (int c = 0; c < cols; ++c) {
+        uint16_t column = 0;
+        for (int r = 0; r < rows; ++r) {
+            column |= static_cast<uint16_t>(((bits[r] >> c) & 1) << r);
+        }
+        transposed[c] = column;
+    }
+}
+
+}
+
+SimdLevel detectSimdLevel() {
+#ifdef DENSITY_X86
+    static const SimdLevel level = cpuHasAvx2() ? SimdLevel::AVX2 : SimdLevel::SSE2;
+    return level;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+const char* simdLevelName(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::AVX2:
+        return "avx2";
+    case SimdLevel::SSE2:
+        return "sse2";
+    case SimdLevel::SCALAR:
+        break;
+    }
+    return "scalar";
+}
+
+void computeDensity(const DensityInput& input, DensityMap& map, SimdLevel level) {
+    if (level > detectSimdLevel()) {
+        level = detectSimdLevel();
+    }
+    std::memset(map.all, 0, sizeof(map.all));
+    std::memset(map.throughHits, 0, sizeof(map.throughHits));
+
+    // Vertical ships, every length
+    vertical(level, input.freeRows, input.hitRows, input.rows, input.remaining, map.all, map.throughHits);
+
+    // Horizontal ships: same pass on the transposed board. A single cell is
+    // the same ship either way and was counted above already.
+    uint16_t weights[densityMaxSize + 1];
+    std::memcpy(weights, input.remaining, sizeof(weights));
+    weights[1] = 0;
+    uint16_t freeColumns[densityMaxSize] = {};
+    uint16_t hitColumns[densityMaxSize] = {};
+    transposeBits(input.freeRows, input.rows, input.cols, freeColumns);
+    transposeBits(input.hitRows, input.rows, input.cols, hitColumns);
+
+    alignas(32) Grid all = {};
+    alignas(32) Grid through = {};
+    vertical(level, freeColumns, hitColumns, input.cols, weights, all, through);
+    for (int r = 0; r < input.rows; ++r) {
+        for (int c = 0; c < input.cols; ++c) {
+            map.all[r][c] += all[c][r];
+            map.throughHits[r][c] += through[c][r];
+        }
+    }
+}
+
+void computeDensity(const DensityInput& input, DensityMap& map) {
+    computeDensity(input, map, detectSimdLevel());
+}
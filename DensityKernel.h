@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+
+// Boards up to 16x16: one board row is 16 uint16 lanes, i.e. one AVX2 or
+// two SSE2 registers
+const int densityMaxSize = 16;
+
+// What the shooter knows about the opponent's board, one bit per cell
+struct DensityInput {
+    int rows = 0;
+    int cols = 0;
+    uint16_t freeRows[densityMaxSize] = {};            // bit c: (row, c) may still hold a ship
+    uint16_t hitRows[densityMaxSize] = {};             // bit c: (row, c) is a hit of a ship not sunk yet
+    uint16_t remaining[densityMaxSize + 1] = {};       // ships still afloat, by length
+};
+
+// For every cell: the number of placements of the remaining ships that
+// cover it (each length weighted by how many such ships are left), and the
+// same count restricted to placements that also cover an open hit
+struct DensityMap {
+    alignas(32) uint16_t all[densityMaxSize][densityMaxSize];
+    alignas(32) uint16_t throughHits[densityMaxSize][densityMaxSize];
+};
+
+enum class SimdLevel {
+    SCALAR,
+    SSE2,
+    AVX2
+};
+
+// Best level this build and CPU support, detected once
+SimdLevel detectSimdLevel();
+const char* simdLevelName(SimdLevel level);
+
+// Sliding-window placement count over whole rows at a time. Vertical ships
+// run down the rows lane-parallel; horizontal ships use the same pass on
+// the transposed board. Levels the build or CPU lack fall back to scalar.
+void computeDensity(const DensityInput& input, DensityMap& map, SimdLevel level);
+void computeDensity(const DensityInput& input, DensityMap& map);
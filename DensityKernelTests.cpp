@@ -0,0 +1,105 @@
+// The density kernel at every SIMD level against a plain count of every
+// placement, on random boards of every size it takes. Levels the CPU lacks
+// fall back to scalar and are checked all the same.
+#include <iostream>
+#include "DensityKernel.h"
+#include "Random.h"
+#include "TestCheck.h"
+
+namespace {
+
+// Counts placements one by one, the way DensityMap describes them
+void countPlacements(const DensityInput& input, DensityMap& map) {
+    for (int r = 0; r < densityMaxSize; ++r) {
+        for (int c = 0; c < densityMaxSize; ++c) {
+            map.all[r][c] = 0;
+            map.throughHits[r][c] = 0;
+        }
+    }
+    for (int length = 1; length <= densityMaxSize; ++length) {
+        const uint16_t weight = input.remaining[length];
+        for (int vertical = 0; vertical < (length == 1 ? 1 : 2) && weight > 0; ++vertical) {
+            for (int row = 0; row < input.rows; ++row) {
+                for (int col = 0; col < input.cols; ++col) {
+                    const int lastRow = row + (vertical ? length - 1 : 0);
+                    const int lastCol = col + (vertical ? 0 : length - 1);
+                    if (lastRow >= input.rows || lastCol >= input.cols) {
+                        continue;
+                    }
+                    bool free = true;
+                    bool hit = false;
+                    for (int r = row; r <= lastRow; ++r) {
+                        for (int c = col; c <= lastCol; ++c) {
+                            free = free && ((input.freeRows[r] >> c) & 1);
+                            hit = hit || ((input.hitRows[r] >> c) & 1);
+                        }
+                    }
+                    if (!free) {
+                        continue;
+                    }
+                    for (int r = row; r <= lastRow; ++r) {
+                        for (int c = col; c <= lastCol; ++c) {
+                            map.all[r][c] += weight;
+                            map.throughHits[r][c] += hit ? weight : 0;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// About `percent` of the board's cells set
+uint16_t randomRow(Rng& rng, int cols, int percent) {
+    uint16_t row = 0;
+    for (int c = 0; c < cols; ++c) {
+        if (static_cast<int>(rng.below(100)) < percent) {
+            row |= 1u << c;
+        }
+    }
+    return row;
+}
+
+bool sameMap(const DensityMap& a, const DensityMap& b) {
+    for (int r = 0; r < densityMaxSize; ++r) {
+        for (int c = 0; c < densityMaxSize; ++c) {
+            if (a.all[r][c] != b.all[r][c] || a.throughHits[r][c] != b.throughHits[r][c]) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+}
+
+int main() {
+    std::cout << "density kernel: best level here " << simdLevelName(detectSimdLevel()) << std::endl;
+    const SimdLevel levels[] = { SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2 };
+    Rng rng(17);
+    for (int i = 0; i < 2000; ++i) {
+        DensityInput input;
+        input.rows = 1 + static_cast<int>(rng.below(densityMaxSize));
+        input.cols = 1 + static_cast<int>(rng.below(densityMaxSize));
+        const int freePercent = 40 + static_cast<int>(rng.below(61));
+        for (int r = 0; r < input.rows; ++r) {
+            input.freeRows[r] = randomRow(rng, input.cols, freePercent);
+            input.hitRows[r] = input.freeRows[r] & randomRow(rng, input.cols, 10);
+        }
+        for (int length = 1; length <= 6; ++length) {
+            input.remaining[length] = static_cast<uint16_t>(rng.below(4));
+        }
+
+        DensityMap expected;
+        countPlacements(input, expected);
+        for (SimdLevel level : levels) {
+            DensityMap map;
+            computeDensity(input, map, level);
+            if (!sameMap(map, expected)) {
+                std::cerr << simdLevelName(level) << " differs on a " << input.rows << "x" << input.cols << " board" << std::endl;
+            }
+            CHECK(sameMap(map, expected));
+        }
+    }
+    return testResult();
+}
@@ -0,0 +1,131 @@
+#include "DensityShooter.h"
+#include <cassert>
+#include <cstddef>
+
+DensityShooter::DensityShooter(int rows, int cols, const std::vector<int>& shipLengths, uint64_t seed)
+    : rowCount(rows), colCount(cols), fleet(shipLengths), rng(seed), simd(detectSimdLevel()) {
+    // A clamped board would play a corner of the real one
+    assert(rows > 0 && rows <= densityMaxSize && cols > 0 && cols <= densityMaxSize);
+    sunkShip.reserve(densityMaxSize * densityMaxSize);
+    reset();
+}
+
+void DensityShooter::reset() {
+    input = DensityInput();
+    input.rows = rowCount;
+    input.cols = colCount;
+    const uint16_t fullRow = static_cast<uint16_t>((1u << colCount) - 1);
+    for (int r = 0; r < rowCount; ++r) {
+        input.freeRows[r] = fullRow;
+        shotRows[r] = 0;
+    }
+    for (int length : fleet) {
+        if (length > 0 && length <= densityMaxSize) {
+            ++input.remaining[length];
+        }
+    }
+}
+
+bool DensityShooter::chooseTarget(int& row, int& col) {
+    computeDensity(input, map, simd);
+
+    bool targeting = false;
+    for (int r = 0; r < rowCount; ++r) {
+        targeting = targeting || input.hitRows[r] != 0;
+    }
+    const uint16_t (*weight)[densityMaxSize] = targeting ? map.throughHits : map.all;
+
+    // Reservoir-sample among the best unshot cells
+    int best = -1;
+    uint16_t bestWeight = 0;
+    uint32_t ties = 0;
+    for (int r = 0; r < rowCount; ++r) {
+        for (int c = 0; c < colCount; ++c) {
+            if ((shotRows[r] >> c) & 1) {
+                continue;
+            }
+            if (best < 0 || weight[r][c] > bestWeight) {
+                best = r * colCount + c;
+                bestWeight = weight[r][c];
+                ties = 1;
+            }
+            else if (weight[r][c] == bestWeight && rng.below(++ties) == 0) {
+                best = r * colCount + c;
+            }
+        }
+    }
+    if (best < 0) {
+        return false;
+    }
+    row = best / colCount;
+    col = best % colCount;
+    return true;
+}
+
+void DensityShooter::markWater(int row, int col) {
+    if (row < 0 || row >= rowCount || col < 0 || col >= colCount) {
+        return;
+    }
+    const uint16_t bit = static_cast<uint16_t>(1u << col);
+    input.freeRows[row] &= ~bit;
+    shotRows[row] |= bit;
+}
+
+void DensityShooter::recordShot(int row, int col, ShotResult result) {
+    if (row < 0 || row >= rowCount || col < 0 || col >= colCount) {
+        return;
+    }
+    shotRows[row] |= static_cast<uint16_t>(1u << col);
+
+    if (result == ShotResult::MISS) {
+        markWater(row, col);
+        return;
+    }
+
+    // A ship cell: ships are straight and never touch, so the diagonal
+    // neighbours are water
+    input.hitRows[row] |= static_cast<uint16_t>(1u << col);
+    for (int dr : { -1, 1 }) {
+        for (int dc : { -1, 1 }) {
+            markWater(row + dr, col + dc);
+        }
+    }
+    if (result == ShotResult::HIT) {
+        return;
+    }
+
+    // Sunk: collect the connected open hits, that is the whole ship
+    std::vector<int>& ship = sunkShip;
+    ship.assign(1, row * colCount + col);
+    input.hitRows[row] &= ~static_cast<uint16_t>(1u << col);
+    for (size_t i = 0; i < ship.size(); ++i) {
+        const int r = ship[i] / colCount;
+        const int c = ship[i] % colCount;
+        const int neighbours[4][2] = { { r - 1, c }, { r + 1, c }, { r, c - 1 }, { r, c + 1 } };
+        for (const auto& n : neighbours) {
+            if (n[0] < 0 || n[0] >= rowCount || n[1] < 0 || n[1] >= colCount) {
+                continue;
+            }
+            if ((input.hitRows[n[0]] >> n[1]) & 1) {
+                input.hitRows[n[0]] &= ~static_cast<uint16_t>(1u << n[1]);
+                ship.push_back(n[0] * colCount + n[1]);
+            }
+        }
+    }
+
+    // The ship and everything around it can hold no other ship
+    for (int part : ship) {
+        const int r = part / colCount;
+        const int c = part % colCount;
+        for (int nr = r - 1; nr <= r + 1; ++nr) {
+            for (int nc = c - 1; nc <= c + 1; ++nc) {
+                markWater(nr, nc);
+            }
+        }
+    }
+
+    const int length = static_cast<int>(ship.size());
+    if (length <= densityMaxSize && input.remaining[length] > 0) {
+        --input.remaining[length];
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "DensityKernel.h"
+#include "Random.h"
+#include "Shooter.h"
+
+// Computer shooter on the SIMD density kernel. Instead of keeping a list of
+// placements up to date it keeps a few bit rows (free cells, open hits) and
+// recounts every placement from scratch for each shot, a whole board row per
+// instruction. Boards up to densityMaxSize in each direction; makeShooter()
+// picks TargetingEngine for anything bigger.
+class DensityShooter : public Shooter {
+public:
+    DensityShooter(int rows, int cols, const std::vector<int>& shipLengths, uint64_t seed = 0);
+
+    void reset() override;
+    void reseed(uint64_t seed) override { rng.reseed(seed); }
+
+    // Same choice as TargetingEngine: the unshot cell covered by the most
+    // placements, only placements through open hits while a ship is wounded
+    bool chooseTarget(int& row, int& col) override;
+    void recordShot(int row, int col, ShotResult result) override;
+
+    // Density of every cell for the next shot (valid after chooseTarget)
+    const DensityMap& density() const { return map; }
+    void setSimdLevel(SimdLevel level) { simd = level; }
+
+private:
+    int rowCount;
+    int colCount;
+    std::vector<int> fleet;
+    Rng rng;
+    SimdLevel simd;
+
+    DensityInput input;
+    DensityMap map;
+    uint16_t shotRows[densityMaxSize];
+    std::vector<int> sunkShip;   // scratch for recordShot, sized once
+
+    void markWater(int row, int col);
+};
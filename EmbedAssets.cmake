@@ -0,0 +1,23 @@
+# Writes OUTPUT, a C++ file with the bytes of every file in ASSETS (a list
+# of paths) as arrays, and the embeddedAssets table EmbeddedAssets.cpp looks
+# them up in. Assets are named by file name.
+#
+#   cmake -DOUTPUT=EmbeddedAssetData.cpp "-DASSETS=arial.ttf;field.png" -P EmbedAssets.cmake
+set(source "// Generated by EmbedAssets.cmake - do not edit\n#include \"EmbeddedAssets.h\"\n\nnamespace {\n\n")
+set(table "")
+set(index 0)
+foreach(asset IN LISTS ASSETS)
+    get_filename_component(name ${asset} NAME)
+    file(READ ${asset} hex HEX)
+    string(LENGTH "${hex}" length)
+    math(EXPR size "${length} / 2")
+    # 32 bytes a line
+    string(REPEAT "[0-9a-f]" 64 line)
+    string(REGEX REPLACE "(${line})" "\\1\n" hex "${hex}")
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+    string(APPEND source "const unsigned char asset${index}[] = {\n${bytes}\n};\n\n")
+    string(APPEND table "    { \"${name}\", asset${index}, ${size} },\n")
+    math(EXPR index "${index} + 1")
+endforeach()
+string(APPEND source "}\n\nextern const EmbeddedAsset embeddedAssets[] = {\n${table}};\nextern const size_t embeddedAssetCount = ${index};\n")
+file(WRITE ${OUTPUT} "${source}")
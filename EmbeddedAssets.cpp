@@ -0,0 +1,20 @@
+#include "EmbeddedAssets.h"
+
+#ifdef SEA_BATTLE_EMBEDDED_ASSETS
+// Defined in the generated EmbeddedAssetData.cpp
+extern const EmbeddedAsset embeddedAssets[];
+extern const size_t embeddedAssetCount;
+#endif
+
+const EmbeddedAsset* findEmbeddedAsset(const std::string& name) {
+#ifdef SEA_BATTLE_EMBEDDED_ASSETS
+    for (size_t i = 0; i < embeddedAssetCount; ++i) {
+        if (name == embeddedAssets[i].name) {
+            return &embeddedAssets[i];
+        }
+    }
+#else
+    (void)name;
+#endif
+    return nullptr;
+}
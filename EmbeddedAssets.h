@@ -0,0 +1,15 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+// Game assets compiled into the binary. CMake builds generate the data from
+// arial.ttf and field.png (EmbedAssets.cmake); other builds embed nothing
+// and the game reads the files from the working directory instead.
+struct EmbeddedAsset {
+    const char* name;
+    const unsigned char* data;
+    size_t size;
+};
+
+// nullptr if `name` was not embedded
+const EmbeddedAsset* findEmbeddedAsset(const std::string& name);
@@ -0,0 +1,27 @@
+#include "EndgameShooter.h"
+#include "Profiler.h"
+
+EndgameShooter::EndgameShooter(int rows, int cols, const std::vector<int>& shipLengths, uint64_t seed,
+                               const EndgameLimits& limits)
+    : heuristic(rows, cols, shipLengths, seed), endgame(rows, cols, limits) {
+}
+
+void EndgameShooter::reset() {
+    heuristic.reset();
+    endgame.reset();
+    solved = 0;
+}
+
+bool EndgameShooter::chooseTarget(int& row, int& col) {
+    ProfileScope scope("EndgameShooter::chooseTarget");
+    if (endgame.load(heuristic) && endgame.solve(row, col)) {
+        ++solved;
+        return true;
+    }
+    return heuristic.chooseTarget(row, col);
+}
+
+void EndgameShooter::recordShot(int row, int col, ShotResult result) {
+    heuristic.recordShot(row, col, result);
+    endgame.recordShot(row, col, result);
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "EndgameSolver.h"
+#include "Shooter.h"
+#include "TargetingEngine.h"
+
+// TargetingEngine for most of the game, EndgameSolver once few enough
+// layouts of the remaining fleet are left. Its endgame is optimal, but the
+// heuristic's is nearly so: on the classic board it saves about 0.05 shots
+// a game (55.06 against 55.10 over 20000 games), within the noise, at some
+// 200 times the time. A move never takes much longer than
+// EndgameLimits::moveTime.
+class EndgameShooter : public Shooter {
+public:
+    EndgameShooter(int rows, int cols, const std::vector<int>& shipLengths, uint64_t seed = 0,
+                   const EndgameLimits& limits = EndgameLimits());
+
+    void reset() override;
+    void reseed(uint64_t seed) override { heuristic.reseed(seed); }
+    bool chooseTarget(int& row, int& col) override;
+    void recordShot(int row, int col, ShotResult result) override;
+
+    // Moves of this game the solver chose
+    int solvedMoves() const { return solved; }
+    const EndgameSolver& solver() const { return endgame; }
+
+private:
+    TargetingEngine heuristic;
+    EndgameSolver endgame;
+    int solved = 0;
+};
@@ -0,0 +1,491 @@
+#include "EndgameSolver.h"
+#include <algorithm>
+#include "Random.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+// Layouts are enumerated only while this bound on their number holds, and
+// for at most this many steps; past that the game is not in its endgame yet
+const double candidateLimit = 1 << 20;
+const uint64_t enumerationBudget = 1 << 16;
+
+// Time is read once per this many positions
+const uint64_t clockInterval = 64;
+
+int bitCount(uint64_t mask) {
+#ifdef _MSC_VER
+    return static_cast<int>(__popcnt64(mask));
+#else
+    return __builtin_popcountll(mask);
+#endif
+}
+
+int lowestBit(uint64_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+// Ways to choose `count` of `total`, capped well above candidateLimit
+double choose(int total, int count) {
+    double ways = 1;
+    for (int i = 0; i < count && ways <= candidateLimit; ++i) {
+        ways = ways * (total - i) / (i + 1);
+    }
+    return ways;
+}
+
+// Key of one placement. A layout's key mixes its placements' keys again, so
+// sets of layouts that share ships do not cancel out when XORed together.
+uint64_t placementKey(int placement) {
+    uint64_t x = 0x5EA0BA771E000000ull + static_cast<uint64_t>(placement);
+    return Rng::splitMix64(x);
+}
+
+}
+
+EndgameSolver::EndgameSolver(int rows, int cols, const EndgameLimits& limits)
+    : limits(limits), rowCount(rows), colCount(cols) {
+    size_t entries = 1;
+    while (entries * 2 * sizeof(Entry) <= limits.tableBytes) {
+        entries *= 2;
+    }
+    table.assign(entries, Entry{ 0, 0.0f, -1, 0, 0 });
+    tableMask = entries - 1;
+    this->limits.maxLayouts = std::min(std::max(limits.maxLayouts, 1), maxCells);
+
+    const int cellCount = rows * cols;
+    cellKeys.resize(cellCount);
+    uint64_t stream = 0xC0FFEE;
+    for (auto& key : cellKeys) {
+        key = Rng::splitMix64(stream);
+    }
+    searchCell.assign(cellCount, -1);
+
+    // Enumeration scratch for the most ships the board can hold, so loading
+    // never allocates
+    const size_t maxShips = ((rows + 1) / 2) * ((cols + 1) / 2);
+    slotLength.reserve(maxShips);
+    chosen.resize(maxShips);
+    blocked.assign(maxShips + 1, std::vector<uint64_t>((cellCount + 63) / 64, 0));
+    hitsCovered.resize(maxShips + 1);
+    lengthsLeft.resize(maxShips + 1);
+    openHits.reserve(cellCount);
+    hitCoverers.resize(maxCells);
+    for (auto& list : hitCoverers) {
+        list.reserve(maxCells);
+    }
+    layoutShips.reserve((maxCells + 1) * maxShips);
+    layoutCells.reserve(maxCells);
+    layoutKeys.reserve(maxCells);
+    shipCells.reserve(maxCells * maxCells);
+}
+
+void EndgameSolver::recordShot(int row, int col, ShotResult result) {
+    if (result != ShotResult::MISS) {
+        hitsKey ^= cellKeys[row * colCount + col];
+    }
+}
+
+bool EndgameSolver::load(const TargetingEngine& engine) {
+    for (int cell = 0; cell < cellTotal; ++cell) {
+        searchCell[boardCell[cell]] = -1;
+    }
+    layoutTotal = 0;
+    cellTotal = 0;
+    if (engine.rows() != rowCount || engine.cols() != colCount) {
+        return false;
+    }
+
+    // One slot per ship afloat, longest first
+    const std::vector<int>& remaining = engine.shipsRemaining();
+    slotLength.clear();
+    for (int length = static_cast<int>(remaining.size()) - 1; length > 0; --length) {
+        slotLength.insert(slotLength.end(), remaining[length], length);
+    }
+    if (slotLength.empty() || slotLength.size() >= blocked.size() || remaining.size() > 64) {
+        return false;
+    }
+
+    // A placement fully on hits would have been reported sunk
+    if (candidates.size() != remaining.size()) {
+        candidates.resize(remaining.size());
+        for (auto& list : candidates) {
+            list.reserve(engine.placementCount());
+        }
+    }
+    for (auto& list : candidates) {
+        list.clear();
+    }
+    for (int p = 0; p < engine.placementCount(); ++p) {
+        const int length = engine.placementLength(p);
+        if (!engine.placementAlive(p) || remaining[length] == 0) {
+            continue;
+        }
+        for (int cell : engine.placementCells(p)) {
+            if (!engine.isShot(cell)) {
+                candidates[length].push_back(p);
+                break;
+            }
+        }
+    }
+    double bound = 1;
+    for (size_t length = 1; length < remaining.size() && bound <= candidateLimit; ++length) {
+        bound *= choose(static_cast<int>(candidates[length].size()), remaining[length]);
+    }
+    if (bound > candidateLimit) {
+        return false;
+    }
+
+    openHits.clear();
+    for (int cell = 0; cell < rowCount * colCount; ++cell) {
+        if (engine.isOpenHit(cell)) {
+            openHits.push_back(cell);
+        }
+    }
+    if (openHits.size() > hitCoverers.size()) {
+        return false;
+    }
+    for (size_t hit = 0; hit < openHits.size(); ++hit) {
+        hitCoverers[hit].clear();
+    }
+    for (const auto& list : candidates) {
+        for (int p : list) {
+            for (uint64_t hits = openHitsOn(engine.placementCells(p)); hits != 0; hits &= hits - 1) {
+                hitCoverers[lowestBit(hits)].push_back(p);
+            }
+        }
+    }
+
+    const size_t slots = slotLength.size();
+    std::fill(blocked[0].begin(), blocked[0].end(), 0);
+    hitsCovered[0] = 0;
+    lengthsLeft[slots] = 0;
+    for (size_t slot = slots; slot-- > 0;) {
+        lengthsLeft[slot] = lengthsLeft[slot + 1] | (1ull << slotLength[slot]);
+    }
+    layoutShips.clear();
+    enumerationSteps = 0;
+    enumerate(engine, 0);
+    if (layoutTotal == 0 || layoutTotal > limits.maxLayouts || enumerationSteps > enumerationBudget) {
+        layoutTotal = 0;
+        return false;
+    }
+
+    // Number the unhit ship cells and describe every layout by them
+    layoutCells.assign(layoutTotal, 0);
+    layoutKeys.assign(layoutTotal, 0);
+    shipCells.assign(layoutTotal * maxCells, 0);
+    bool fits = true;
+    for (int layout = 0; layout < layoutTotal && fits; ++layout) {
+        uint64_t key = 0;
+        for (size_t slot = 0; slot < slots && fits; ++slot) {
+            const int p = layoutShips[layout * slots + slot];
+            key ^= placementKey(p);
+            uint64_t ship = 0;
+            for (int cell : engine.placementCells(p)) {
+                if (engine.isShot(cell)) {
+                    continue;
+                }
+                if (searchCell[cell] < 0) {
+                    if (cellTotal == maxCells) {
+                        fits = false;
+                        break;
+                    }
+                    boardCell[cellTotal] = cell;
+                    searchCell[cell] = cellTotal++;
+                }
+                ship |= 1ull << searchCell[cell];
+            }
+            layoutCells[layout] |= ship;
+            for (uint64_t rest = ship; rest != 0; rest &= rest - 1) {
+                shipCells[layout * maxCells + lowestBit(rest)] = ship;
+            }
+        }
+        layoutKeys[layout] = Rng::splitMix64(key);
+    }
+    if (!fits) {
+        layoutTotal = 0;
+        return false;
+    }
+    return true;
+}
+
+void EndgameSolver::enumerate(const TargetingEngine& engine, int slot) {
+    if (++enumerationSteps > enumerationBudget || layoutTotal > limits.maxLayouts) {
+        return;
+    }
+    const size_t slots = slotLength.size();
+    const uint64_t allHits = openHits.size() == 64 ? ~0ull : (1ull << openHits.size()) - 1;
+    const std::vector<uint64_t>& taken = blocked[slot];
+    if (slot == static_cast<int>(slots)) {
+        // Every open hit belongs to one of the ships
+        if (hitsCovered[slot] == allHits && ++layoutTotal <= limits.maxLayouts) {
+            for (size_t s = 0; s < slots; ++s) {
+                layoutShips.push_back(candidates[slotLength[s]][chosen[s]]);
+            }
+        }
+        return;
+    }
+
+    // Give up on this branch as soon as an open hit can no longer be covered
+    for (uint64_t left = allHits & ~hitsCovered[slot]; left != 0; left &= left - 1) {
+        bool coverable = false;
+        for (int p : hitCoverers[lowestBit(left)]) {
+            if (!((lengthsLeft[slot] >> engine.placementLength(p)) & 1u)) {
+                continue;
+            }
+            coverable = true;
+            for (int cell : engine.placementCells(p)) {
+                coverable = coverable && !((taken[cell >> 6] >> (cell & 63)) & 1u);
+            }
+            if (coverable) {
+                break;
+            }
+        }
+        if (!coverable) {
+            return;
+        }
+    }
+
+    const int length = slotLength[slot];
+    const std::vector<int>& list = candidates[length];
+    const int first = slot > 0 && slotLength[slot - 1] == length ? chosen[slot - 1] + 1 : 0;
+    std::vector<uint64_t>& next = blocked[slot + 1];
+    for (int i = first; i < static_cast<int>(list.size()); ++i) {
+        const std::vector<int>& cells = engine.placementCells(list[i]);
+        bool free = true;
+        for (int cell : cells) {
+            free = free && !((taken[cell >> 6] >> (cell & 63)) & 1u);
+        }
+        if (!free) {
+            continue;
+        }
+        next = taken;
+        for (int cell : cells) {
+            const int r = cell / colCount;
+            const int c = cell % colCount;
+            for (int nr = std::max(r - 1, 0); nr <= std::min(r + 1, rowCount - 1); ++nr) {
+                for (int nc = std::max(c - 1, 0); nc <= std::min(c + 1, colCount - 1); ++nc) {
+                    const int around = nr * colCount + nc;
+                    next[around >> 6] |= 1ull << (around & 63);
+                }
+            }
+        }
+        hitsCovered[slot + 1] = hitsCovered[slot] | openHitsOn(cells);
+        chosen[slot] = i;
+        enumerate(engine, slot + 1);
+        if (enumerationSteps > enumerationBudget || layoutTotal > limits.maxLayouts) {
+            return;
+        }
+    }
+}
+
+uint64_t EndgameSolver::openHitsOn(const std::vector<int>& cells) const {
+    uint64_t hits = 0;
+    for (int cell : cells) {
+        const auto at = std::find(openHits.begin(), openHits.end(), cell);
+        if (at != openHits.end()) {
+            hits |= 1ull << (at - openHits.begin());
+        }
+    }
+    return hits;
+}
+
+bool EndgameSolver::solve(int& row, int& col) {
+    depthDone = 0;
+    exactDone = false;
+    nodes = 0;
+    if (layoutTotal == 0) {
+        return false;
+    }
+    if (layoutTotal == 1) {
+        // Nothing left to find out
+        const int cell = boardCell[lowestBit(layoutCells[0])];
+        row = cell / colCount;
+        col = cell % colCount;
+        exactDone = true;
+        valueDone = bitCount(layoutCells[0]);
+        return true;
+    }
+
+    ++generation;
+    deadline = std::chrono::steady_clock::now() + limits.moveTime;
+    aborted = false;
+    const uint64_t all = layoutTotal == 64 ? ~0ull : (1ull << layoutTotal) - 1;
+    int best = -1;
+    for (int depth = 1; depth <= cellTotal && !exactDone; ++depth) {
+        rootCell = -1;
+        bool exact = false;
+        const double value = search(all, 0, hitsKey, depth, exact);
+        if (aborted || rootCell < 0) {
+            break;
+        }
+        best = rootCell;
+        depthDone = depth;
+        exactDone = exact;
+        valueDone = value;
+    }
+    if (best < 0) {
+        return false;
+    }
+    row = boardCell[best] / colCount;
+    col = boardCell[best] % colCount;
+    return true;
+}
+
+double EndgameSolver::search(uint64_t set, uint64_t shots, uint64_t hits, int depth, bool& exact) {
+    // The first iteration always finishes, so there is a move to make
+    if (++nodes % clockInterval == 0 && depthDone > 0 && std::chrono::steady_clock::now() >= deadline) {
+        aborted = true;
+    }
+    if (aborted) {
+        return 0;
+    }
+
+    int layouts = 0;
+    int left = 0;
+    uint64_t key = hits;
+    int hitCount[maxCells] = {};
+    uint64_t open = 0;
+    for (uint64_t rest = set; rest != 0; rest &= rest - 1) {
+        const int layout = lowestBit(rest);
+        const uint64_t cells = layoutCells[layout] & ~shots;
+        ++layouts;
+        left += bitCount(cells);
+        key ^= layoutKeys[layout];
+        open |= cells;
+        for (uint64_t bits = cells; bits != 0; bits &= bits - 1) {
+            ++hitCount[lowestBit(bits)];
+        }
+    }
+    // Every unhit ship cell still takes a shot
+    const double bound = static_cast<double>(left) / layouts;
+    if (layouts == 1) {
+        exact = true;
+        return bound;
+    }
+
+    // Likeliest hits first: they have the lowest bounds
+    int order[maxCells];
+    int cellCount = 0;
+    for (uint64_t bits = open; bits != 0; bits &= bits - 1) {
+        const int cell = lowestBit(bits);
+        int i = cellCount++;
+        while (i > 0 && hitCount[order[i - 1]] < hitCount[cell]) {
+            order[i] = order[i - 1];
+            --i;
+        }
+        order[i] = cell;
+    }
+
+    if (depth == 0) {
+        // Plus the misses: until its first hit every layout sees the same
+        // shots, and the first i shots hit at most the i likeliest cells'
+        // layouts, so at least `layouts - covered` layouts miss shot i
+        int misses = 0;
+        int covered = 0;
+        for (int i = 0; i < cellCount && covered < layouts; ++i) {
+            covered += hitCount[order[i]];
+            misses += std::max(layouts - covered, 0);
+        }
+        exact = false;
+        return bound + static_cast<double>(misses) / layouts;
+    }
+
+    Entry& entry = table[key & tableMask];
+    if (entry.key == key) {
+        if (entry.depth >= depth) {
+            exact = entry.depth == exactDepth;
+            if (shots == 0) {
+                rootCell = searchCell[entry.cell];
+            }
+            return entry.value;
+        }
+        // Best shot of the shallower search first
+        const int hint = searchCell[entry.cell];
+        if (hint >= 0 && ((open >> hint) & 1u)) {
+            int* at = std::find(order, order + cellCount, hint);
+            std::rotate(order, at, at + 1);
+        }
+    }
+
+    double best = 1e30;
+    int bestCell = -1;
+    bool bestExact = false;
+    for (int i = 0; i < cellCount; ++i) {
+        const int cell = order[i];
+        const uint64_t bit = 1ull << cell;
+        double value = 1 + bound - static_cast<double>(hitCount[cell]) / layouts;
+        if (value >= best) {
+            // Bounds only grow down the order; the hint is the one exception
+            if (i == 0) {
+                continue;
+            }
+            break;
+        }
+
+        // Split the layouts by what the shot would report. Layouts in which
+        // it ends the game cost nothing more.
+        uint64_t outcome[3] = {};   // miss, hit, sunk
+        int outcomeLeft[3] = {};
+        for (uint64_t rest = set; rest != 0; rest &= rest - 1) {
+            const int layout = lowestBit(rest);
+            const uint64_t cells = layoutCells[layout] & ~shots;
+            if (!(cells & bit)) {
+                outcome[0] |= 1ull << layout;
+                outcomeLeft[0] += bitCount(cells);
+                continue;
+            }
+            if ((cells & ~bit) == 0) {
+                continue;
+            }
+            const int result = (shipCells[layout * maxCells + cell] & ~shots & ~bit) != 0 ? 1 : 2;
+            outcome[result] |= 1ull << layout;
+            outcomeLeft[result] += bitCount(cells & ~bit);
+        }
+
+        // Replace each outcome's bound by its searched value, giving up as
+        // soon as the shot cannot beat the best one
+        bool valueExact = true;
+        for (int result = 0; result < 3 && value < best; ++result) {
+            if (outcome[result] == 0) {
+                continue;
+            }
+            const int size = bitCount(outcome[result]);
+            const uint64_t childHits = result == 0 ? hits : hits ^ cellKeys[boardCell[cell]];
+            bool childExact = false;
+            const double childValue = search(outcome[result], shots | bit, childHits, depth - 1, childExact);
+            if (aborted) {
+                return 0;
+            }
+            value += (childValue - static_cast<double>(outcomeLeft[result]) / size) * size / layouts;
+            valueExact = valueExact && childExact;
+        }
+        if (value < best) {
+            best = value;
+            bestCell = cell;
+            bestExact = valueExact;
+        }
+    }
+
+    // Shots that were cut off can only be worse than an exact best, so the
+    // best one alone decides whether this value is exact
+    exact = bestExact;
+    const uint8_t storedDepth = exact ? exactDepth : static_cast<uint8_t>(std::min(depth, exactDepth - 1));
+    if (entry.key == key || entry.generation != generation || entry.depth <= storedDepth) {
+        entry = Entry{ key, static_cast<float>(best), static_cast<int16_t>(boardCell[bestCell]), storedDepth, generation };
+    }
+    if (shots == 0) {
+        rootCell = bestCell;
+    }
+    return best;
+}
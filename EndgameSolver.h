@@ -0,0 +1,110 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "Board.h"
+#include "TargetingEngine.h"
+
+struct EndgameLimits {
+    // Per move; the search deepens until the answer is exact or time is up
+    std::chrono::microseconds moveTime{ 5000 };
+    // Transposition table, rounded down to a power of two entries
+    size_t tableBytes = 4u << 20;
+    // The search takes over at this many layouts or fewer (at most 64)
+    int maxLayouts = 64;
+};
+
+// Exact play for the end of a game. Once only a few layouts of the fleet
+// still afloat agree with every shot so far, it enumerates them all and
+// searches for the shot with the fewest expected shots to finish, every
+// layout being equally likely:
+//
+//     E(S) = 1 + min over cells c of  sum over results r of  P(r) * E(S | c gives r)
+//
+// The search deepens one shot at a time. At the depth limit it uses the
+// average number of unhit ship cells, a lower bound, so a shot whose bound
+// is already worse than the best one is never searched. Positions are cached
+// in a Zobrist-hashed transposition table that lives for the whole game, so
+// the next move starts from what this one found.
+class EndgameSolver {
+public:
+    EndgameSolver(int rows, int cols, const EndgameLimits& limits = EndgameLimits());
+
+    // New game. Cached positions stay valid: a key names the layouts and hits.
+    void reset() { hitsKey = 0; }
+    // Called for every shot of the game, in order
+    void recordShot(int row, int col, ShotResult result);
+
+    // Enumerates the layouts that fit what `engine` knows. False when there
+    // are more than maxLayouts of them, or too many to tell quickly.
+    bool load(const TargetingEngine& engine);
+    // Searches the loaded layouts for at most moveTime. False if none are loaded.
+    bool solve(int& row, int& col);
+
+    int layoutCount() const { return layoutTotal; }
+    // Of the last solve(): deepest finished search, whether it was exact,
+    // the expected shots to finish the game, and positions visited
+    int depthReached() const { return depthDone; }
+    bool solvedExactly() const { return exactDone; }
+    double expectedShots() const { return valueDone; }
+    uint64_t nodesSearched() const { return nodes; }
+
+private:
+    // Search cells are the unhit ship cells of some layout, at most 64 of them
+    static constexpr int maxCells = 64;
+
+    struct Entry {
+        uint64_t key;
+        float value;
+        int16_t cell;         // best shot, board cell
+        uint8_t depth;        // exactDepth: the value is exact
+        uint8_t generation;   // solve() call that stored it
+    };
+    static constexpr uint8_t exactDepth = 255;
+
+    EndgameLimits limits;
+    std::vector<Entry> table;
+    uint64_t tableMask = 0;
+    uint8_t generation = 0;
+
+    uint64_t hitsKey = 0;                     // Zobrist key of every hit so far
+    std::vector<uint64_t> cellKeys;           // board cell -> Zobrist key
+
+    // Enumeration, sized in the constructor: one slot per ship afloat, longest
+    // first. Slots of the same length take placements in increasing order so
+    // each layout is met once.
+    std::vector<std::vector<int>> candidates;   // length -> placements a ship of it may take
+    std::vector<int> slotLength;
+    std::vector<int> chosen;                    // slot -> index into candidates
+    std::vector<std::vector<uint64_t>> blocked; // slot -> body and halo of the ships before it
+    std::vector<int> openHits;                  // hits of ships not sunk yet
+    std::vector<std::vector<int>> hitCoverers;  // open hit -> candidates through it
+    std::vector<uint64_t> hitsCovered;          // slot -> open hits on the ships before it
+    std::vector<uint64_t> lengthsLeft;          // slot -> lengths of it and later slots, as bits
+    std::vector<int> layoutShips;               // layout -> placements, slotLength.size() each
+    uint64_t enumerationSteps = 0;
+    int rowCount;
+    int colCount;
+
+    // Loaded layouts
+    int layoutTotal = 0;
+    int cellTotal = 0;
+    int boardCell[maxCells];                    // search cell -> board cell
+    std::vector<int> searchCell;                // board cell -> search cell, -1 if none
+    std::vector<uint64_t> layoutCells;          // layout -> its unhit ship cells
+    std::vector<uint64_t> shipCells;            // layout * maxCells + cell -> unhit cells of the ship on it
+    std::vector<uint64_t> layoutKeys;
+
+    // Search state
+    std::chrono::steady_clock::time_point deadline;
+    uint64_t nodes = 0;
+    bool aborted = false;
+    int rootCell = -1;
+    int depthDone = 0;
+    bool exactDone = false;
+    double valueDone = 0;
+
+    void enumerate(const TargetingEngine& engine, int slot);
+    uint64_t openHitsOn(const std::vector<int>& cells) const;
+    double search(uint64_t set, uint64_t shots, uint64_t hits, int depth, bool& exact);
+};
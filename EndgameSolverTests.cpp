@@ -0,0 +1,286 @@
+// EndgameSolver against a plain expectimax over every layout of a small
+// board: the layouts it loads, the expected shots it reports and the shot
+// it picks must all agree with the brute force.
+#include <bitset>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <utility>
+#include <vector>
+#include "EndgameSolver.h"
+#include "TargetingEngine.h"
+#include "TestCheck.h"
+
+namespace {
+
+int bitCount(uint64_t mask) {
+    return static_cast<int>(std::bitset<64>(mask).count());
+}
+
+int lowestBit(uint64_t mask) {
+    return bitCount((mask & (~mask + 1)) - 1);
+}
+
+// One ship as a mask of board cells
+struct ShipCells {
+    uint64_t cells;
+    uint64_t halo;   // the ship and every cell around it
+};
+
+// Every layout of `lengths` (longest first) on the board, ships not
+// touching, as the list of its ships
+class BruteForce {
+public:
+    BruteForce(int rows, int cols, const std::vector<int>& lengths) : rows(rows), cols(cols), lengths(lengths) {
+        chosen.resize(lengths.size());
+        place(0, 0, 0);
+        countCells();
+    }
+
+    // Drops the layouts that disagree with a shot. Once at most 64 are left
+    // they keep their indices, so what value() found stays valid.
+    void shoot(int row, int col, ShotResult result) {
+        const uint64_t bit = 1ull << (row * cols + col);
+        std::vector<std::vector<ShipCells>> kept;
+        for (size_t layout = 0; layout < layouts.size(); ++layout) {
+            if (!((alive >> layout) & 1u) && layouts.size() <= 64) {
+                continue;
+            }
+            ShotResult actual = ShotResult::MISS;
+            for (const auto& ship : layouts[layout]) {
+                if (ship.cells & bit) {
+                    actual = (ship.cells & ~(shots | bit)) == 0 ? ShotResult::SUNK : ShotResult::HIT;
+                }
+            }
+            if (actual == result) {
+                kept.push_back(layouts[layout]);
+            }
+            else if (layouts.size() <= 64) {
+                alive &= ~(1ull << layout);
+            }
+        }
+        shots |= bit;
+        if (layouts.size() > 64) {
+            layouts = kept;
+            countCells();
+        }
+    }
+
+    int layoutCount() const { return layouts.size() > 64 ? static_cast<int>(layouts.size()) : bitCount(alive); }
+    // Before any shot
+    const std::vector<ShipCells>& layout(int index) const { return layouts[index]; }
+
+    // Expected shots to sink every ship, playing the best shot every time
+    double expected() {
+        return value(alive, shots);
+    }
+    // The same, when `cell` is shot first
+    double expectedAfter(int cell) {
+        return shotValue(alive, shots, cell);
+    }
+
+private:
+    int rows;
+    int cols;
+    std::vector<int> lengths;
+    std::vector<ShipCells> chosen;
+    std::vector<std::vector<ShipCells>> layouts;
+    std::vector<uint64_t> shipCells;   // layout -> all its ship cells
+    uint64_t alive = 0;                // layouts left, while there are at most 64
+    uint64_t shots = 0;
+    std::map<std::pair<uint64_t, uint64_t>, double> known;
+
+    void place(size_t slot, int first, uint64_t taken) {
+        if (slot == lengths.size()) {
+            layouts.push_back(chosen);
+            return;
+        }
+        // Ships of the same length in increasing order, so each layout comes once
+        const bool sameAsLast = slot > 0 && lengths[slot - 1] == lengths[slot];
+        int index = 0;
+        for (int vertical = 0; vertical < 2; ++vertical) {
+            for (int row = 0; row < rows; ++row) {
+                for (int col = 0; col < cols; ++col, ++index) {
+                    if ((sameAsLast && index < first) || (lengths[slot] == 1 && vertical == 1)) {
+                        continue;
+                    }
+                    ShipCells ship{ 0, 0 };
+                    bool fits = true;
+                    for (int i = 0; i < lengths[slot] && fits; ++i) {
+                        const int r = row + i * vertical;
+                        const int c = col + i * (1 - vertical);
+                        fits = r < rows && c < cols;
+                        if (fits) {
+                            ship.cells |= 1ull << (r * cols + c);
+                            for (int nr = r - 1; nr <= r + 1; ++nr) {
+                                for (int nc = c - 1; nc <= c + 1; ++nc) {
+                                    if (nr >= 0 && nr < rows && nc >= 0 && nc < cols) {
+                                        ship.halo |= 1ull << (nr * cols + nc);
+                                    }
+                                }
+                            }
+                        }
+                    }
+                    if (!fits || (ship.cells & taken)) {
+                        continue;
+                    }
+                    chosen[slot] = ship;
+                    place(slot + 1, index + 1, taken | ship.halo);
+                }
+            }
+        }
+    }
+
+    void countCells() {
+        alive = layouts.size() >= 64 ? ~0ull : (1ull << layouts.size()) - 1;
+        shipCells.assign(layouts.size(), 0);
+        for (size_t layout = 0; layout < layouts.size(); ++layout) {
+            for (const auto& ship : layouts[layout]) {
+                shipCells[layout] |= ship.cells;
+            }
+        }
+    }
+
+    uint64_t unhit(int layout, uint64_t shot) const {
+        return shipCells[layout] & ~shot;
+    }
+
+    double value(uint64_t set, uint64_t shot) {
+        const auto at = known.find({ set, shot });
+        if (at != known.end()) {
+            return at->second;
+        }
+        // Every cell some layout still has a ship on; any other shot is wasted
+        uint64_t open = 0;
+        for (uint64_t rest = set; rest != 0; rest &= rest - 1) {
+            open |= unhit(lowestBit(rest), shot);
+        }
+        double best = 1e30;
+        for (uint64_t rest = open; rest != 0; rest &= rest - 1) {
+            best = std::min(best, shotValue(set, shot, lowestBit(rest)));
+        }
+        known[{ set, shot }] = best;
+        return best;
+    }
+
+    double shotValue(uint64_t set, uint64_t shot, int cell) {
+        const uint64_t bit = 1ull << cell;
+        uint64_t outcome[3] = {};
+        int layoutTotal = 0;
+        for (uint64_t rest = set; rest != 0; rest &= rest - 1) {
+            const int layout = lowestBit(rest);
+            ++layoutTotal;
+            if ((unhit(layout, shot) & ~bit) == 0) {
+                continue;   // the game is over
+            }
+            int result = 0;
+            for (const auto& ship : layouts[layout]) {
+                if (ship.cells & bit) {
+                    result = (ship.cells & ~(shot | bit)) == 0 ? 2 : 1;
+                }
+            }
+            outcome[result] |= 1ull << layout;
+        }
+        double expected = 1;
+        for (uint64_t part : outcome) {
+            if (part != 0) {
+                expected += value(part, shot | bit) * bitCount(part) / layoutTotal;
+            }
+        }
+        return expected;
+    }
+};
+
+struct Shot {
+    int row;
+    int col;
+    ShotResult result;
+};
+
+// The solver's answer for what `engine` knows against the brute force's
+void checkSolver(const TargetingEngine& engine, EndgameSolver& solver, BruteForce& brute) {
+    CHECK(solver.load(engine));
+    CHECK(solver.layoutCount() == brute.layoutCount());
+    int row = -1;
+    int col = -1;
+    CHECK(solver.solve(row, col));
+    CHECK(solver.solvedExactly());
+    const double expected = brute.expected();
+    if (std::abs(solver.expectedShots() - expected) > 1e-4) {
+        std::cerr << engine.rows() << "x" << engine.cols() << ", " << brute.layoutCount() << " layouts: solver "
+                  << solver.expectedShots() << ", brute force " << expected << std::endl;
+    }
+    CHECK(std::abs(solver.expectedShots() - expected) <= 1e-4);
+    // Ties are fine, a worse shot is not
+    CHECK(row >= 0 && std::abs(brute.expectedAfter(row * engine.cols() + col) - expected) <= 1e-4);
+}
+
+EndgameLimits untimed() {
+    EndgameLimits limits;
+    limits.moveTime = std::chrono::seconds(10);
+    return limits;
+}
+
+// The position after `shots`
+void checkPosition(int rows, int cols, const std::vector<int>& lengths, const std::vector<Shot>& shots) {
+    TargetingEngine engine(rows, cols, lengths);
+    EndgameSolver solver(rows, cols, untimed());
+    BruteForce brute(rows, cols, lengths);
+    for (const auto& shot : shots) {
+        engine.recordShot(shot.row, shot.col, shot.result);
+        solver.recordShot(shot.row, shot.col, shot.result);
+        brute.shoot(shot.row, shot.col, shot.result);
+    }
+    CHECK(brute.layoutCount() > 1 && brute.layoutCount() <= 64);
+    checkSolver(engine, solver, brute);
+}
+
+// A game the engine plays against one layout, checking every position with
+// few enough layouts left. One solver plays the whole game, as in
+// EndgameShooter, so its table carries over from move to move.
+void checkGame(int rows, int cols, const std::vector<int>& lengths, int truth) {
+    TargetingEngine engine(rows, cols, lengths, truth);
+    EndgameSolver solver(rows, cols, untimed());
+    BruteForce brute(rows, cols, lengths);
+    const std::vector<ShipCells> fleet = brute.layout(truth % brute.layoutCount());
+    uint64_t shots = 0;
+    int row = 0;
+    int col = 0;
+    while (brute.layoutCount() > 1 && engine.chooseTarget(row, col)) {
+        if (brute.layoutCount() <= 64) {
+            checkSolver(engine, solver, brute);
+        }
+        const uint64_t bit = 1ull << (row * cols + col);
+        ShotResult result = ShotResult::MISS;
+        for (const auto& ship : fleet) {
+            if (ship.cells & bit) {
+                result = (ship.cells & ~(shots | bit)) == 0 ? ShotResult::SUNK : ShotResult::HIT;
+            }
+        }
+        shots |= bit;
+        engine.recordShot(row, col, result);
+        solver.recordShot(row, col, result);
+        brute.shoot(row, col, result);
+    }
+    CHECK(brute.layoutCount() == 1);
+}
+
+}
+
+int main() {
+    checkPosition(3, 3, { 2, 1 }, {});
+    checkPosition(3, 4, { 2, 1 }, { { 1, 1, ShotResult::MISS } });
+    checkPosition(4, 4, { 2, 1 }, { { 0, 0, ShotResult::MISS }, { 3, 3, ShotResult::MISS }, { 1, 2, ShotResult::MISS },
+                                    { 2, 1, ShotResult::MISS }, { 0, 3, ShotResult::MISS } });
+    checkPosition(4, 4, { 3, 1 }, { { 1, 1, ShotResult::MISS }, { 2, 2, ShotResult::MISS } });
+    checkPosition(4, 4, { 2, 1, 1 }, { { 1, 1, ShotResult::HIT } });
+    checkPosition(5, 5, { 3, 2, 1 }, { { 2, 2, ShotResult::HIT }, { 1, 2, ShotResult::MISS }, { 3, 2, ShotResult::MISS },
+                                       { 0, 0, ShotResult::MISS }, { 4, 4, ShotResult::MISS }, { 0, 4, ShotResult::MISS },
+                                       { 4, 0, ShotResult::MISS }, { 0, 2, ShotResult::MISS }, { 2, 0, ShotResult::MISS } });
+    for (int truth = 0; truth < 10; ++truth) {
+        checkGame(5, 5, { 3, 2, 1 }, truth * 37);
+        checkGame(4, 5, { 2, 2, 1 }, truth * 11);
+    }
+    return testResult();
+}
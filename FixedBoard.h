@@ -0,0 +1,158 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "Board.h"
+
+// Board with its size fixed at compile time. Same interface and bit layout
+// as Board, but the masks live in std::array and the ship and halo mask of
+// every placement of a ship up to tableLength cells long is generated at
+// compile time, so a check is a couple of unrolled word ANDs. Longer ships
+// fall back to bit-by-bit loops. Use visitBoard() to pick a FixedBoard for
+// the common sizes and the runtime-sized Board for anything else.
+// Placement checks on a fleet use it (GameState, Protocol); FleetGenerator
+// counts covers per cell instead.
+template <int Rows, int Cols>
+class FixedBoard {
+public:
+    static constexpr int cellCount = Rows * Cols;
+    static constexpr int wordCount = (cellCount + 63) / 64;
+    static constexpr int tableLength = 4;
+    typedef std::array<uint64_t, wordCount> Mask;
+
+    constexpr int rows() const { return Rows; }
+    constexpr int cols() const { return Cols; }
+
+    static constexpr bool fits(int row, int col, int length, ShipDirection direction) {
+        if (row < 0 || col < 0 || length <= 0) {
+            return false;
+        }
+        if (direction == ShipDirection::HORIZONTAL) {
+            return row < Rows && col + length <= Cols;
+        }
+        return col < Cols && row + length <= Rows;
+    }
+
+    bool canPlace(int row, int col, int length, ShipDirection direction) const {
+        return fits(row, col, length, direction) && !shipIntersects(occupied, row, col, length, direction);
+    }
+    bool canPlaceWithGap(int row, int col, int length, ShipDirection direction) const {
+        return fits(row, col, length, direction) && !shipIntersects(blocked, row, col, length, direction);
+    }
+
+    // Marks the ship cells and its halo. Cells outside the board are ignored.
+    void place(int row, int col, int length, ShipDirection direction) {
+        if (length <= tableLength && fits(row, col, length, direction)) {
+            const ShipMasks& ship = masks[static_cast<int>(direction)][length - 1][row * Cols + col];
+            for (int i = 0; i < wordCount; ++i) {
+                occupied[i] |= ship.body[i];
+                blocked[i] |= ship.halo[i];
+            }
+            return;
+        }
+        const int lastRow = (direction == ShipDirection::VERTICAL) ? row + length - 1 : row;
+        const int lastCol = (direction == ShipDirection::HORIZONTAL) ? col + length - 1 : col;
+        for (int r = row - 1; r <= lastRow + 1; ++r) {
+            for (int c = col - 1; c <= lastCol + 1; ++c) {
+                if (r < 0 || r >= Rows || c < 0 || c >= Cols) {
+                    continue;
+                }
+                setBit(blocked, r * Cols + c);
+                if (r >= row && r <= lastRow && c >= col && c <= lastCol) {
+                    setBit(occupied, r * Cols + c);
+                }
+            }
+        }
+    }
+
+    bool isOccupied(int row, int col) const { return testBit(occupied, row * Cols + col); }
+    bool isBlocked(int row, int col) const { return testBit(blocked, row * Cols + col); }
+
+    void clear() {
+        occupied = Mask();
+        blocked = Mask();
+    }
+
+private:
+    struct ShipMasks {
+        Mask body;
+        Mask halo;   // body plus the surrounding cells, clipped to the board
+    };
+    // [direction][length - 1][start cell]; placements that do not fit stay empty
+    typedef std::array<std::array<std::array<ShipMasks, cellCount>, tableLength>, 2> MaskTable;
+
+    Mask occupied = Mask();
+    Mask blocked = Mask();
+
+    static constexpr void setBit(Mask& mask, int bit) { mask[bit >> 6] |= 1ull << (bit & 63); }
+    static constexpr bool testBit(const Mask& mask, int bit) { return (mask[bit >> 6] >> (bit & 63)) & 1u; }
+
+    static constexpr MaskTable buildMasks() {
+        MaskTable table{};
+        for (int direction = 0; direction < 2; ++direction) {
+            const bool vertical = direction == static_cast<int>(ShipDirection::VERTICAL);
+            for (int length = 1; length <= tableLength; ++length) {
+                for (int row = 0; row < Rows; ++row) {
+                    for (int col = 0; col < Cols; ++col) {
+                        if (!fits(row, col, length, vertical ? ShipDirection::VERTICAL : ShipDirection::HORIZONTAL)) {
+                            continue;
+                        }
+                        ShipMasks& ship = table[direction][length - 1][row * Cols + col];
+                        const int lastRow = vertical ? row + length - 1 : row;
+                        const int lastCol = vertical ? col : col + length - 1;
+                        for (int r = row - 1; r <= lastRow + 1; ++r) {
+                            for (int c = col - 1; c <= lastCol + 1; ++c) {
+                                if (r < 0 || r >= Rows || c < 0 || c >= Cols) {
+                                    continue;
+                                }
+                                setBit(ship.halo, r * Cols + c);
+                                if (r >= row && r <= lastRow && c >= col && c <= lastCol) {
+                                    setBit(ship.body, r * Cols + c);
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return table;
+    }
+
+    static constexpr MaskTable masks = buildMasks();
+
+    // The ship is known to fit
+    static bool shipIntersects(const Mask& mask, int row, int col, int length, ShipDirection direction) {
+        const int first = row * Cols + col;
+        if (length <= tableLength) {
+            const Mask& body = masks[static_cast<int>(direction)][length - 1][first].body;
+            uint64_t any = 0;
+            for (int i = 0; i < wordCount; ++i) {
+                any |= mask[i] & body[i];
+            }
+            return any != 0;
+        }
+        const int step = (direction == ShipDirection::HORIZONTAL) ? 1 : Cols;
+        for (int i = 0; i < length; ++i) {
+            if (testBit(mask, first + i * step)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// Calls `visit` with an empty board of the given size: a FixedBoard for the
+// sizes compiled in (10x10, 12x12, 15x15), the runtime-sized Board otherwise.
+// `visit` must return the same type for every board type.
+template <typename Visitor>
+auto visitBoard(int rows, int cols, Visitor&& visit) -> decltype(visit(Board(rows, cols))) {
+    if (rows == 10 && cols == 10) {
+        return visit(FixedBoard<10, 10>());
+    }
+    if (rows == 12 && cols == 12) {
+        return visit(FixedBoard<12, 12>());
+    }
+    if (rows == 15 && cols == 15) {
+        return visit(FixedBoard<15, 15>());
+    }
+    return visit(Board(rows, cols));
+}
@@ -0,0 +1,250 @@
+#include "FleetBatch.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include "FleetSampler.h"
+
+namespace {
+
+// Fleets per work unit: large enough to amortise the hand-off, small enough
+// to keep every core busy near the end of the batch
+const uint64_t chunkSize = 16384;
+
+struct Chunk {
+    std::string data;
+    bool ready = false;
+    bool failed = false;
+    std::string error;   // why it failed, if not for want of a layout
+};
+
+}
+
+uint64_t fleetSeed(uint64_t batchSeed, uint64_t index) {
+    uint64_t x = batchSeed ^ (index * 0xD1B54A32D192ED03ull);
+    return Rng::splitMix64(x);
+}
+
+bool parseFleetSpec(const std::string& spec, std::vector<int>& shipLengths) {
+    std::vector<int> lengths;
+    std::stringstream stream(spec);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        try {
+            size_t used = 0;
+            const int length = std::stoi(item, &used);
+            if (used != item.size() || length <= 0) {
+                return false;
+            }
+            lengths.push_back(length);
+        }
+        catch (const std::exception&) {
+            return false;
+        }
+    }
+    if (lengths.empty()) {
+        return false;
+    }
+    shipLengths = lengths;
+    return true;
+}
+
+bool parseBoardSize(const std::string& spec, int& rows, int& cols) {
+    const size_t x = spec.find('x');
+    if (x == std::string::npos) {
+        return false;
+    }
+    try {
+        rows = std::stoi(spec.substr(0, x));
+        cols = std::stoi(spec.substr(x + 1));
+    }
+    catch (const std::exception&) {
+        return false;
+    }
+    return rows > 0 && cols > 0 && rows <= Rules::maxSize && cols <= Rules::maxSize;
+}
+
+// Binary layout, all integers little-endian:
+//   "SBF1", uint8 rows, uint8 cols, uint8 shipCount, uint8 length[shipCount]
+//   per fleet, per ship: uint16 (row * cols + col) | (vertical << 15)
+void writeFleetHeader(std::ostream& out, const FleetBatchOptions& options) {
+    if (options.format != FleetFormat::BINARY) {
+        return;
+    }
+    std::string header = "SBF1";
+    header.push_back(static_cast<char>(options.rules.rows));
+    header.push_back(static_cast<char>(options.rules.cols));
+    header.push_back(static_cast<char>(options.rules.shipLengths.size()));
+    for (int length : options.rules.shipLengths) {
+        header.push_back(static_cast<char>(length));
+    }
+    out.write(header.data(), header.size());
+}
+
+void appendFleet(std::string& out, const std::vector<ShipPlacement>& fleet, int cols, FleetFormat format) {
+    if (format == FleetFormat::BINARY) {
+        for (const auto& ship : fleet) {
+            uint16_t value = static_cast<uint16_t>(ship.row * cols + ship.col);
+            if (ship.direction == ShipDirection::VERTICAL) {
+                value |= 0x8000;
+            }
+            out.push_back(static_cast<char>(value & 0xFF));
+            out.push_back(static_cast<char>(value >> 8));
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < fleet.size(); ++i) {
+        const auto& ship = fleet[i];
+        if (i > 0) {
+            out.push_back(' ');
+        }
+        out += std::to_string(ship.length);
+        out.push_back(':');
+        out += std::to_string(ship.row);
+        out.push_back(',');
+        out += std::to_string(ship.col);
+        out.push_back(',');
+        out.push_back(ship.direction == ShipDirection::HORIZONTAL ? 'H' : 'V');
+    }
+    out.push_back('\n');
+}
+
+bool parseFleetLine(const std::string& line, std::vector<ShipPlacement>& fleet) {
+    fleet.clear();
+    std::stringstream stream(line);
+    std::string item;
+    while (stream >> item) {
+        ShipPlacement ship;
+        char colon = 0;
+        char comma1 = 0;
+        char comma2 = 0;
+        char direction = 0;
+        std::stringstream fields(item);
+        if (!(fields >> ship.length >> colon >> ship.row >> comma1 >> ship.col >> comma2 >> direction) || colon != ':' || comma1 != ','
+            || comma2 != ',' || (direction != 'H' && direction != 'V') || fields.peek() != EOF) {
+            return false;
+        }
+        ship.direction = direction == 'H' ? ShipDirection::HORIZONTAL : ShipDirection::VERTICAL;
+        fleet.push_back(ship);
+    }
+    return !fleet.empty();
+}
+
+bool generateFleetBatch(const FleetBatchOptions& options, std::ostream& out, std::string& error) {
+    if (options.format == FleetFormat::BINARY && options.rules.shipLengths.size() > 255) {
+        error = "the binary format holds at most 255 ships";
+        return false;
+    }
+    FleetSampler sampler;
+    if (!options.uniformTables.empty() && !sampler.open(options.rules, options.uniformTables, error)) {
+        return false;
+    }
+    unsigned threadCount = options.threads ? options.threads : std::thread::hardware_concurrency();
+    threadCount = std::max(threadCount, 1u);
+
+    const uint64_t chunkCount = (options.count + chunkSize - 1) / chunkSize;
+    // At most this many chunks are buffered ahead of the writer
+    const uint64_t window = 2ull * threadCount;
+
+    std::vector<Chunk> slots(window);
+    std::mutex mutex;
+    std::condition_variable chunkDone;
+    std::condition_variable slotFree;
+    uint64_t written = 0;
+    bool failed = false;
+    std::atomic<uint64_t> nextChunk(0);
+
+    auto worker = [&]() {
+        FleetGenerator generator(options.rules, 0);
+        // Each worker maps the tables itself; a sampler has scratch space
+        FleetSampler uniform;
+        std::string openError;
+        const bool sampling = !options.uniformTables.empty();
+        const bool uniformReady = sampling && uniform.openCached(options.rules, options.uniformTables, openError);
+        Rng rng;
+        std::vector<ShipPlacement> fleet;
+        std::string buffer;
+        for (;;) {
+            const uint64_t chunk = nextChunk.fetch_add(1);
+            if (chunk >= chunkCount) {
+                return;
+            }
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                slotFree.wait(lock, [&]() { return failed || chunk < written + window; });
+                if (failed) {
+                    return;
+                }
+            }
+
+            buffer.clear();
+            bool ok = true;
+            const uint64_t first = chunk * chunkSize;
+            const uint64_t last = std::min(first + chunkSize, options.count);
+            for (uint64_t index = first; index < last && ok; ++index) {
+                if (sampling) {
+                    rng.reseed(fleetSeed(options.seed, index));
+                    ok = uniformReady;
+                    if (ok) {
+                        uniform.sample(rng, fleet);
+                    }
+                }
+                else {
+                    generator.reseed(fleetSeed(options.seed, index));
+                    ok = generator.generate(fleet) == FleetResult::OK;
+                }
+                appendFleet(buffer, fleet, options.rules.cols, options.format);
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            Chunk& slot = slots[chunk % window];
+            slot.data.swap(buffer);
+            slot.failed = !ok;
+            slot.error = sampling && !uniformReady ? openError : std::string();
+            slot.ready = true;
+            chunkDone.notify_all();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (unsigned i = 0; i < threadCount; ++i) {
+        threads.emplace_back(worker);
+    }
+
+    writeFleetHeader(out, options);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (written < chunkCount && !failed) {
+            Chunk& slot = slots[written % window];
+            chunkDone.wait(lock, [&]() { return slot.ready; });
+            if (slot.failed) {
+                failed = true;
+                error = slot.error;
+                break;
+            }
+            std::string data;
+            data.swap(slot.data);
+            slot.ready = false;
+            lock.unlock();
+            out.write(data.data(), data.size());
+            lock.lock();
+            ++written;
+            slotFree.notify_all();
+        }
+        slotFree.notify_all();
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    if (failed) {
+        if (error.empty()) {
+            error = "no layout found for the fleet on a " + std::to_string(options.rules.rows) + "x" + std::to_string(options.rules.cols) + " board";
+        }
+        return false;
+    }
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "FleetGenerator.h"
+
+enum class FleetFormat {
+    TEXT,   // one fleet per line: "length:row,col,H|V" per ship, space separated
+    BINARY  // "SBF1" header, then 2 bytes per ship (see writeFleetHeader)
+};
+
+struct FleetBatchOptions {
+    Rules rules;
+    uint64_t seed = 0;
+    uint64_t count = 0;
+    unsigned threads = 0;   // 0 - one per hardware thread
+    FleetFormat format = FleetFormat::TEXT;
+    // Table cache of FleetSampler: if set, fleets are drawn exactly uniformly
+    // instead of by FleetGenerator, and the tables are counted if missing
+    std::string uniformTables;
+};
+
+// Seed of fleet number `index` in a batch. Every fleet has its own stream,
+// so the output does not depend on how fleets are split between threads.
+uint64_t fleetSeed(uint64_t batchSeed, uint64_t index);
+
+// Parses "4,3,3,2,2,2,1,1,1,1"
+bool parseFleetSpec(const std::string& spec, std::vector<int>& shipLengths);
+// Parses "10x10", up to Rules::maxSize each way
+bool parseBoardSize(const std::string& spec, int& rows, int& cols);
+
+void writeFleetHeader(std::ostream& out, const FleetBatchOptions& options);
+void appendFleet(std::string& out, const std::vector<ShipPlacement>& fleet, int cols, FleetFormat format);
+// Parses one line of the text format
+bool parseFleetLine(const std::string& line, std::vector<ShipPlacement>& fleet);
+
+// Generates options.count fleets on all cores and writes them in index order.
+// Returns false and fills `error` if any fleet cannot be generated, or if
+// the binary format cannot hold the fleet (more than 255 ships).
+bool generateFleetBatch(const FleetBatchOptions& options, std::ostream& out, std::string& error);
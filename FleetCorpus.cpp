@@ -0,0 +1,450 @@
+#include "FleetCorpus.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <thread>
+#include "FleetBatch.h"
+#include "ThreadPool.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace {
+
+const char corpusMagic[4] = { 'S', 'B', 'C', '1' };
+
+// Layouts per pool task
+const uint64_t layoutsPerTask = 16384;
+// Output is written in blocks of about this many bytes
+const size_t writeBlockSize = 1 << 20;
+
+int lowestBit(uint64_t mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, mask);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+uint32_t readUint32(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) | (static_cast<uint32_t>(data[2]) << 16)
+           | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+uint64_t readUint64(const uint8_t* data) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+CorpusRecord readRecord(const uint8_t* data) {
+    CorpusRecord record;
+    record.key.low = readUint64(data);
+    record.key.high = readUint64(data + 8);
+    record.count = readUint32(data + 16);
+    return record;
+}
+
+void appendRecord(std::string& out, const CorpusKey& key, uint64_t count) {
+    // Counts past 2^32 - 1 stay there
+    const uint32_t stored = static_cast<uint32_t>(std::min<uint64_t>(count, UINT32_MAX));
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((key.low >> (8 * i)) & 0xFF));
+    }
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((key.high >> (8 * i)) & 0xFF));
+    }
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((stored >> (8 * i)) & 0xFF));
+    }
+}
+
+// Sorted keys as records, equal keys counted once
+bool writeRun(const std::string& path, const std::vector<CorpusKey>& keys) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    std::string buffer;
+    for (size_t i = 0; i < keys.size();) {
+        size_t next = i + 1;
+        while (next < keys.size() && keys[next] == keys[i]) {
+            ++next;
+        }
+        appendRecord(buffer, keys[i], next - i);
+        if (buffer.size() >= writeBlockSize) {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+        i = next;
+    }
+    out.write(buffer.data(), buffer.size());
+    out.close();
+    return static_cast<bool>(out);
+}
+
+void removeFiles(const std::vector<std::string>& paths) {
+    for (const auto& path : paths) {
+        std::remove(path.c_str());
+    }
+}
+
+// Sorts on every worker: each sorts a slice, then slices are merged in pairs
+void parallelSort(ThreadPool& pool, std::vector<CorpusKey>& keys) {
+    const size_t slice = std::max<size_t>(layoutsPerTask, (keys.size() + pool.size() - 1) / pool.size());
+    for (size_t first = 0; first < keys.size(); first += slice) {
+        pool.submit([&keys, first, slice](unsigned) {
+            std::sort(keys.begin() + first, keys.begin() + std::min(first + slice, keys.size()));
+        });
+    }
+    pool.wait();
+    for (size_t width = slice; width < keys.size(); width *= 2) {
+        for (size_t first = 0; first + width < keys.size(); first += 2 * width) {
+            pool.submit([&keys, first, width](unsigned) {
+                std::inplace_merge(keys.begin() + first, keys.begin() + first + width,
+                                   keys.begin() + std::min(first + 2 * width, keys.size()));
+            });
+        }
+        pool.wait();
+    }
+}
+
+// K-way merge of sorted runs into the corpus, adding up equal keys
+bool mergeRuns(const std::vector<std::string>& runPaths, std::ofstream& out, std::string& error) {
+    std::vector<std::unique_ptr<MappedFile>> runs;
+    for (const auto& runPath : runPaths) {
+        runs.push_back(std::make_unique<MappedFile>());
+        if (!runs.back()->open(runPath)) {
+            error = "cannot read " + runPath;
+            return false;
+        }
+    }
+    struct Head {
+        CorpusRecord record;
+        size_t run;
+        size_t offset;
+    };
+    auto later = [](const Head& a, const Head& b) { return b.record.key < a.record.key; };
+    std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+    for (size_t run = 0; run < runs.size(); ++run) {
+        if (runs[run]->size() >= corpusRecordSize) {
+            heads.push({ readRecord(runs[run]->data()), run, 0 });
+        }
+    }
+
+    std::string buffer;
+    while (!heads.empty()) {
+        const CorpusKey key = heads.top().record.key;
+        uint64_t count = 0;
+        while (!heads.empty() && heads.top().record.key == key) {
+            Head head = heads.top();
+            heads.pop();
+            count += head.record.count;
+            head.offset += corpusRecordSize;
+            if (head.offset + corpusRecordSize <= runs[head.run]->size()) {
+                head.record = readRecord(runs[head.run]->data() + head.offset);
+                heads.push(head);
+            }
+        }
+        appendRecord(buffer, key, count);
+        if (buffer.size() >= writeBlockSize) {
+            out.write(buffer.data(), buffer.size());
+            buffer.clear();
+        }
+    }
+    out.write(buffer.data(), buffer.size());
+    return true;
+}
+
+}
+
+CorpusKey layoutKey(const std::vector<ShipPlacement>& fleet, int cols) {
+    CorpusKey key;
+    for (const auto& ship : fleet) {
+        for (int i = 0; i < ship.length; ++i) {
+            const int row = ship.row + (ship.direction == ShipDirection::VERTICAL ? i : 0);
+            const int col = ship.col + (ship.direction == ShipDirection::HORIZONTAL ? i : 0);
+            key.set(row * cols + col);
+        }
+    }
+    return key;
+}
+
+bool keyLayout(const CorpusKey& key, int rows, int cols, std::vector<ShipPlacement>& fleet) {
+    const int cells = rows * cols;
+    fleet.clear();
+    if ((cells < 64 && (key.low >> cells) != 0) || (cells < 128 && (key.high >> std::max(0, cells - 64)) != 0)) {
+        return false;
+    }
+    CorpusKey seen;
+    for (int cell = 0; cell < cells; ++cell) {
+        if (!key.test(cell) || seen.test(cell)) {
+            continue;
+        }
+        const int row = cell / cols;
+        const int col = cell % cols;
+        ShipPlacement ship = { 1, row, col, ShipDirection::HORIZONTAL };
+        if (col + 1 < cols && key.test(cell + 1)) {
+            while (col + ship.length < cols && key.test(cell + ship.length)) {
+                seen.set(cell + ship.length);
+                ++ship.length;
+            }
+        }
+        else {
+            while (row + ship.length < rows && key.test(cell + ship.length * cols)) {
+                seen.set(cell + ship.length * cols);
+                ++ship.length;
+            }
+            if (ship.length > 1) {
+                ship.direction = ShipDirection::VERTICAL;
+            }
+        }
+        fleet.push_back(ship);
+    }
+    return true;
+}
+
+BoardSymmetries::BoardSymmetries(int rows, int cols)
+    : cellCount(rows * cols), byteCount((rows * cols + 7) / 8), symmetryCount(rows == cols ? 8 : 4) {
+    cellMaps.resize(symmetryCount * cellCount);
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            const int flippedRow = rows - 1 - row;
+            const int flippedCol = cols - 1 - col;
+            const int images[8][2] = {
+                { row, col }, { row, flippedCol }, { flippedRow, col }, { flippedRow, flippedCol },
+                // Square boards only: the same four, transposed
+                { col, row }, { col, flippedRow }, { flippedCol, row }, { flippedCol, flippedRow },
+            };
+            for (int symmetry = 0; symmetry < symmetryCount; ++symmetry) {
+                cellMaps[symmetry * cellCount + row * cols + col] = images[symmetry][0] * cols + images[symmetry][1];
+            }
+        }
+    }
+
+    byteImages.resize(symmetryCount * 16 * 256);
+    for (int symmetry = 0; symmetry < symmetryCount; ++symmetry) {
+        for (int cell = 0; cell < cellCount; ++cell) {
+            const int target = map(symmetry, cell);
+            CorpusKey* images = &byteImages[(symmetry * 16 + cell / 8) * 256];
+            for (int value = 0; value < 256; ++value) {
+                if (value & (1 << (cell % 8))) {
+                    images[value].set(target);
+                }
+            }
+        }
+    }
+}
+
+CorpusKey BoardSymmetries::apply(int symmetry, const CorpusKey& key) const {
+    const CorpusKey* images = &byteImages[symmetry * 16 * 256];
+    CorpusKey image;
+    for (int byte = 0; byte < byteCount; ++byte) {
+        const uint64_t word = byte < 8 ? key.low : key.high;
+        const CorpusKey& part = images[byte * 256 + ((word >> (8 * (byte % 8))) & 0xFF)];
+        image.low |= part.low;
+        image.high |= part.high;
+    }
+    return image;
+}
+
+CorpusKey BoardSymmetries::canonical(const CorpusKey& key) const {
+    CorpusKey best = key;
+    for (int symmetry = 1; symmetry < symmetryCount; ++symmetry) {
+        best = std::min(best, apply(symmetry, key));
+    }
+    return best;
+}
+
+bool buildCorpus(const CorpusBuildOptions& options, const std::string& path, std::string& error) {
+    const Rules& rules = options.rules;
+    if (rules.shipsMayTouch) {
+        error = "a corpus only holds layouts where ships may not touch";
+        return false;
+    }
+    if (rules.cellCount() > corpusMaxCells || rules.shipLengths.size() > 255) {
+        error = "a corpus holds boards of at most " + std::to_string(corpusMaxCells) + " cells and 255 ships";
+        return false;
+    }
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "cannot write " + path;
+        return false;
+    }
+
+    const BoardSymmetries symmetries(rules.rows, rules.cols);
+    ThreadPool pool(options.threads);
+    struct WorkerState {
+        std::unique_ptr<FleetGenerator> generator;
+        std::vector<ShipPlacement> placements;
+        bool failed = false;
+    };
+    std::vector<WorkerState> workers(pool.size());
+    for (auto& worker : workers) {
+        worker.generator = std::make_unique<FleetGenerator>(rules, 0);
+    }
+
+    // Sorted runs of at most keysPerRun layouts each
+    const uint64_t keysPerRun = std::max<uint64_t>(options.keysPerRun, 1);
+    std::vector<CorpusKey> keys;
+    std::vector<std::string> runPaths;
+    for (uint64_t first = 0; first < options.count; first += keysPerRun) {
+        const uint64_t last = std::min(first + keysPerRun, options.count);
+        keys.resize(last - first);
+        for (uint64_t task = first; task < last; task += layoutsPerTask) {
+            pool.submit([&, task, first, last](unsigned index) {
+                WorkerState& worker = workers[index];
+                const uint64_t end = std::min(task + layoutsPerTask, last);
+                for (uint64_t layout = task; layout < end; ++layout) {
+                    worker.generator->reseed(fleetSeed(options.seed, layout));
+                    if (worker.generator->generate(worker.placements) != FleetResult::OK) {
+                        worker.failed = true;
+                        return;
+                    }
+                    keys[layout - first] = symmetries.canonical(layoutKey(worker.placements, rules.cols));
+                }
+            });
+        }
+        pool.wait();
+        for (const auto& worker : workers) {
+            if (worker.failed) {
+                removeFiles(runPaths);
+                error = "no layout found for the fleet on a " + std::to_string(rules.rows) + "x" + std::to_string(rules.cols) + " board";
+                return false;
+            }
+        }
+        parallelSort(pool, keys);
+        runPaths.push_back(path + ".run" + std::to_string(runPaths.size()));
+        if (!writeRun(runPaths.back(), keys)) {
+            removeFiles(runPaths);
+            error = "cannot write " + runPaths.back();
+            return false;
+        }
+    }
+    keys.clear();
+    keys.shrink_to_fit();
+
+    std::string header(corpusMagic, sizeof(corpusMagic));
+    header.push_back(static_cast<char>(rules.rows));
+    header.push_back(static_cast<char>(rules.cols));
+    header.push_back(static_cast<char>(rules.shipLengths.size()));
+    for (int length : rules.shipLengths) {
+        header.push_back(static_cast<char>(length));
+    }
+    out.write(header.data(), header.size());
+    const bool merged = mergeRuns(runPaths, out, error);
+    removeFiles(runPaths);
+    out.close();
+    if (merged && !out) {
+        error = "cannot write " + path;
+    }
+    return merged && static_cast<bool>(out);
+}
+
+bool FleetCorpus::open(const std::string& path, std::string& error) {
+    if (!file.open(path)) {
+        error = "cannot open " + path;
+        return false;
+    }
+    const uint8_t* data = file.data();
+    if (file.size() < 7 || !std::equal(corpusMagic, corpusMagic + 4, data)) {
+        error = path + " is not a fleet corpus";
+        return false;
+    }
+    rowCount = data[4];
+    colCount = data[5];
+    const int shipCount = data[6];
+    if (file.size() < 7u + shipCount || rowCount == 0 || colCount == 0 || rowCount * colCount > corpusMaxCells) {
+        error = path + ": bad header";
+        return false;
+    }
+    lengths.assign(data + 7, data + 7 + shipCount);
+    dataStart = 7 + shipCount;
+    if ((file.size() - dataStart) % corpusRecordSize != 0) {
+        error = path + " is cut off";
+        return false;
+    }
+    recordCount = (file.size() - dataStart) / corpusRecordSize;
+    symmetries = BoardSymmetries(rowCount, colCount);
+    return true;
+}
+
+CorpusRecord FleetCorpus::record(uint64_t index) const {
+    return readRecord(file.data() + dataStart + index * corpusRecordSize);
+}
+
+uint64_t FleetCorpus::count(const std::vector<ShipPlacement>& fleet) const {
+    const CorpusKey key = symmetries.canonical(layoutKey(fleet, colCount));
+    uint64_t first = 0;
+    uint64_t last = recordCount;
+    while (first < last) {
+        const uint64_t middle = first + (last - first) / 2;
+        const CorpusRecord found = record(middle);
+        if (found.key == key) {
+            return found.count;
+        }
+        if (found.key < key) {
+            first = middle + 1;
+        }
+        else {
+            last = middle;
+        }
+    }
+    return 0;
+}
+
+CorpusStats FleetCorpus::stats(unsigned threads) const {
+    unsigned threadCount = threads ? threads : std::thread::hardware_concurrency();
+    threadCount = static_cast<unsigned>(std::max<uint64_t>(1, std::min<uint64_t>(std::max(threadCount, 1u), recordCount)));
+
+    // Per thread: layouts, then ships per cell, over its share of the records
+    const int cellCount = rowCount * colCount;
+    std::vector<std::vector<uint64_t>> totals(threadCount, std::vector<uint64_t>(corpusMaxCells + 1, 0));
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this, i, threadCount, &totals]() {
+            std::vector<uint64_t>& total = totals[i];
+            const uint64_t first = recordCount * i / threadCount;
+            const uint64_t last = recordCount * (i + 1) / threadCount;
+            for (uint64_t index = first; index < last; ++index) {
+                const CorpusRecord found = record(index);
+                total[0] += found.count;
+                for (uint64_t mask = found.key.low; mask != 0; mask &= mask - 1) {
+                    total[1 + lowestBit(mask)] += found.count;
+                }
+                for (uint64_t mask = found.key.high; mask != 0; mask &= mask - 1) {
+                    total[65 + lowestBit(mask)] += found.count;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    CorpusStats stats;
+    stats.records = recordCount;
+    std::vector<uint64_t> cellTotals(cellCount, 0);
+    for (const auto& total : totals) {
+        stats.layouts += total[0];
+        for (int cell = 0; cell < cellCount; ++cell) {
+            cellTotals[cell] += total[1 + cell];
+        }
+    }
+    // Keys are canonical images: spread each cell over its mirror cells
+    stats.cellFrequency.assign(cellCount, 0.0);
+    if (stats.layouts == 0) {
+        return stats;
+    }
+    const double share = 1.0 / (static_cast<double>(stats.layouts) * symmetries.count());
+    for (int symmetry = 0; symmetry < symmetries.count(); ++symmetry) {
+        for (int cell = 0; cell < cellCount; ++cell) {
+            stats.cellFrequency[symmetries.map(symmetry, cell)] += cellTotals[cell] * share;
+        }
+    }
+    return stats;
+}
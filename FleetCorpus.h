@@ -0,0 +1,118 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FleetGenerator.h"
+#include "MappedFile.h"
+#include "Rules.h"
+
+// Fleet-layout corpus ("SBC1"): a sorted, deduplicated set of layouts,
+// little-endian:
+//
+//   header  "SBC1", rows, cols, ship count, ship lengths (one byte each)
+//   record  key low 64 bits, key high 64 bits, count (4 bytes)
+//
+// A key is the occupancy mask of a layout (bit row * cols + col), taken in
+// the smallest of the layout's mirror images so all of them share one
+// record. Ships may not touch, so the mask alone fixes every ship boundary:
+// each ship is a maximal straight run of cells. Boards are limited to 128
+// cells; at 20 bytes a record, a billion layouts fit in 20 GB.
+const int corpusMaxCells = 128;
+const size_t corpusRecordSize = 20;
+
+struct CorpusKey {
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    bool operator==(const CorpusKey& other) const { return low == other.low && high == other.high; }
+    bool operator!=(const CorpusKey& other) const { return !(*this == other); }
+    bool operator<(const CorpusKey& other) const { return high != other.high ? high < other.high : low < other.low; }
+
+    bool test(int cell) const { return ((cell < 64 ? low >> cell : high >> (cell - 64)) & 1) != 0; }
+    void set(int cell) { (cell < 64 ? low : high) |= 1ull << (cell & 63); }
+};
+
+struct CorpusRecord {
+    CorpusKey key;
+    uint32_t count;   // layouts added with this key, saturating
+};
+
+// Occupancy mask of a layout
+CorpusKey layoutKey(const std::vector<ShipPlacement>& fleet, int cols);
+// Ships back from a mask of a no-touch layout, in row-major order of their
+// first cells. False if the mask has a cell off the board.
+bool keyLayout(const CorpusKey& key, int rows, int cols, std::vector<ShipPlacement>& fleet);
+
+// The mirror images of a board: the 8 rotations and reflections of a square
+// board, or the 4 flips of any other. Masks are mapped a byte at a time
+// through precomputed tables, so a canonical key costs a few dozen lookups.
+class BoardSymmetries {
+public:
+    BoardSymmetries(int rows, int cols);
+
+    int count() const { return symmetryCount; }
+    // Where `cell` goes under symmetry `symmetry` (0 is the identity)
+    int map(int symmetry, int cell) const { return cellMaps[symmetry * cellCount + cell]; }
+    CorpusKey apply(int symmetry, const CorpusKey& key) const;
+    // Smallest of the key's images
+    CorpusKey canonical(const CorpusKey& key) const;
+
+private:
+    int cellCount;
+    int byteCount;
+    int symmetryCount;
+    std::vector<int> cellMaps;
+    std::vector<CorpusKey> byteImages;   // [(symmetry * 16 + byte) * 256 + value]
+};
+
+struct CorpusBuildOptions {
+    Rules rules;   // no-touch only, at most corpusMaxCells cells
+    uint64_t seed = 0;
+    uint64_t count = 0;
+    unsigned threads = 0;   // 0 - one per hardware thread
+    // Keys sorted in memory at a time (16 bytes each); each sorted run goes
+    // to a temporary file next to the corpus and the runs are merged at the end
+    uint64_t keysPerRun = 1 << 23;
+};
+
+// Generates options.count layouts (layout i from fleetSeed(seed, i), as
+// generate does) and writes their corpus. Memory use is bounded by
+// keysPerRun however large the corpus.
+bool buildCorpus(const CorpusBuildOptions& options, const std::string& path, std::string& error);
+
+struct CorpusStats {
+    uint64_t records = 0;   // distinct canonical layouts
+    uint64_t layouts = 0;   // layouts added, duplicates included
+    // Per cell, row-major: share of layouts with a ship there. Every layout
+    // is spread evenly over its mirror images, as the generator would.
+    std::vector<double> cellFrequency;
+};
+
+// Memory-mapped corpus. Lookups binary-search the mapping and statistics
+// scan it, so neither loads the file into memory.
+class FleetCorpus {
+public:
+    FleetCorpus() : symmetries(1, 1) {}
+
+    bool open(const std::string& path, std::string& error);
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+    const std::vector<int>& shipLengths() const { return lengths; }
+    uint64_t size() const { return recordCount; }
+
+    CorpusRecord record(uint64_t index) const;
+    // Times the layout or any of its mirror images was added; O(log n)
+    uint64_t count(const std::vector<ShipPlacement>& fleet) const;
+    // One pass over every record, split between `threads` threads
+    CorpusStats stats(unsigned threads = 0) const;
+
+private:
+    MappedFile file;
+    size_t dataStart = 0;
+    uint64_t recordCount = 0;
+    int rowCount = 0;
+    int colCount = 0;
+    std::vector<int> lengths;
+    BoardSymmetries symmetries;
+};
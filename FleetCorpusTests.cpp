@@ -0,0 +1,117 @@
+// BoardSymmetries and FleetCorpus: a canonical key is the same for every
+// mirror image of a layout, and a corpus keeps one record for all of them.
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+#include "FleetBatch.h"
+#include "FleetCorpus.h"
+#include "FleetGenerator.h"
+#include "TestCheck.h"
+
+namespace {
+
+void checkSymmetries(const Rules& rules, int expectedCount) {
+    const BoardSymmetries symmetries(rules.rows, rules.cols);
+    CHECK(symmetries.count() == expectedCount);
+    FleetGenerator generator(rules, 0);
+    std::vector<ShipPlacement> fleet;
+    std::vector<ShipPlacement> image;
+    for (uint64_t seed = 0; seed < 200; ++seed) {
+        generator.reseed(seed);
+        CHECK(generator.generate(fleet) == FleetResult::OK);
+        const CorpusKey key = layoutKey(fleet, rules.cols);
+        const CorpusKey canonical = symmetries.canonical(key);
+        CHECK(symmetries.apply(0, key) == key);
+        bool found = false;
+        for (int symmetry = 0; symmetry < symmetries.count(); ++symmetry) {
+            const CorpusKey mirrored = symmetries.apply(symmetry, key);
+            // The table lookup agrees with mapping cell by cell
+            CorpusKey cells;
+            for (int cell = 0; cell < rules.cellCount(); ++cell) {
+                if (key.test(cell)) {
+                    cells.set(symmetries.map(symmetry, cell));
+                }
+            }
+            CHECK(mirrored == cells);
+            CHECK(symmetries.canonical(mirrored) == canonical);
+            CHECK(!(mirrored < canonical));
+            found = found || mirrored == canonical;
+            // An image of a layout is a layout with the same ships
+            CHECK(keyLayout(mirrored, rules.rows, rules.cols, image) && image.size() == fleet.size());
+        }
+        CHECK(found);
+    }
+}
+
+// A corpus of many layouts on a small board, where mirror images keep
+// coming up, against the same layouts grouped by canonical key here
+void checkCorpus() {
+    CorpusBuildOptions options;
+    options.rules.rows = 5;
+    options.rules.cols = 5;
+    options.rules.shipLengths = { 3, 2, 1 };
+    options.seed = 9;
+    options.count = 5000;
+    options.threads = 2;
+    options.keysPerRun = 700;   // several runs to merge
+    const std::string path = "corpus-test.sbc";
+    std::string error;
+    CHECK(buildCorpus(options, path, error));
+
+    const BoardSymmetries symmetries(5, 5);
+    FleetGenerator generator(options.rules, 0);
+    std::vector<ShipPlacement> fleet;
+    std::vector<std::vector<ShipPlacement>> fleets;
+    std::map<CorpusKey, uint64_t> orbits;
+    for (uint64_t index = 0; index < options.count; ++index) {
+        generator.reseed(fleetSeed(options.seed, index));
+        CHECK(generator.generate(fleet) == FleetResult::OK);
+        fleets.push_back(fleet);
+        ++orbits[symmetries.canonical(layoutKey(fleet, 5))];
+    }
+
+    FleetCorpus corpus;
+    CHECK(corpus.open(path, error));
+    CHECK(corpus.size() == orbits.size());
+    uint64_t total = 0;
+    for (uint64_t i = 0; i < corpus.size(); ++i) {
+        const CorpusRecord record = corpus.record(i);
+        CHECK(i == 0 || corpus.record(i - 1).key < record.key);
+        const auto orbit = orbits.find(record.key);
+        CHECK(orbit != orbits.end() && orbit->second == record.count);
+        total += record.count;
+    }
+    CHECK(total == options.count);
+    CHECK(corpus.stats(2).records == orbits.size() && corpus.stats(2).layouts == options.count);
+
+    // Every image of a layout finds the same record
+    std::vector<ShipPlacement> image;
+    for (size_t i = 0; i < fleets.size(); i += 97) {
+        const CorpusKey key = layoutKey(fleets[i], 5);
+        const uint64_t expected = orbits[symmetries.canonical(key)];
+        for (int symmetry = 0; symmetry < symmetries.count(); ++symmetry) {
+            CHECK(keyLayout(symmetries.apply(symmetry, key), 5, 5, image));
+            CHECK(corpus.count(image) == expected);
+        }
+    }
+    std::remove(path.c_str());
+}
+
+}
+
+int main() {
+    Rules classic;
+    checkSymmetries(classic, 8);
+    Rules wide;
+    wide.rows = 8;
+    wide.cols = 13;
+    wide.shipLengths = { 4, 3, 3, 2, 1, 1 };
+    checkSymmetries(wide, 4);
+    Rules odd;
+    odd.rows = 11;
+    odd.cols = 11;
+    checkSymmetries(odd, 8);
+    checkCorpus();
+    return testResult();
+}
@@ -0,0 +1,134 @@
+#include "FleetGenerator.h"
+#include <algorithm>
+#include <numeric>
+
+FleetGenerator::FleetGenerator(const Rules& rules, uint64_t seed)
+    : rowCount(rules.rows), colCount(rules.cols), shipsMayTouch(rules.shipsMayTouch), lengths(rules.shipLengths), rng(seed) {
+    order.resize(lengths.size());
+    std::iota(order.begin(), order.end(), 0);
+    // Long ships first: they have the fewest options, so dead ends show up early
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return lengths[a] > lengths[b]; });
+
+    const int maxLength = rules.maxShipLength();
+    table.resize(maxLength + 1);
+    decks.resize(maxLength + 1);
+    for (int length = 1; length <= maxLength; ++length) {
+        if (std::find(lengths.begin(), lengths.end(), length) == lengths.end()) {
+            continue;
+        }
+        for (int row = 0; row < rowCount; ++row) {
+            for (int col = 0; col < colCount; ++col) {
+                if (col + length <= colCount) {
+                    table[length].push_back({ row, col, ShipDirection::HORIZONTAL });
+                }
+                // A single cell is the same ship either way, list it once
+                if (length > 1 && row + length <= rowCount) {
+                    table[length].push_back({ row, col, ShipDirection::VERTICAL });
+                }
+            }
+        }
+        decks[length].resize(table[length].size());
+        std::iota(decks[length].begin(), decks[length].end(), 0);
+    }
+
+    covered.assign(rowCount * colCount, 0);
+    swaps.reserve(64 * lengths.size());
+    chosen.resize(lengths.size());
+}
+
+FleetGenerator::FleetGenerator(int rows, int cols, const std::vector<int>& shipLengths, uint64_t seed)
+    : FleetGenerator(Rules{ rows, cols, shipLengths, false }, seed) {
+}
+
+FleetResult FleetGenerator::generate(std::vector<ShipPlacement>& fleet) {
+    fleet.clear();
+    probes = 0;
+    std::fill(covered.begin(), covered.end(), 0);
+    const bool found = search(0);
+    // Decks back in their starting order: the next layout depends on its seed only
+    undoSwaps(0);
+    if (!found) {
+        return probes >= probeLimit ? FleetResult::LIMIT_REACHED : FleetResult::NO_LAYOUT;
+    }
+
+    fleet.resize(lengths.size());
+    for (size_t depth = 0; depth < order.size(); ++depth) {
+        const Candidate& c = chosen[depth];
+        fleet[order[depth]] = { lengths[order[depth]], c.row, c.col, c.direction };
+    }
+    return FleetResult::OK;
+}
+
+bool FleetGenerator::search(int depth) {
+    if (depth == static_cast<int>(order.size())) {
+        return true;
+    }
+    const int length = lengths[order[depth]];
+    const std::vector<Candidate>& candidates = table[length];
+    std::vector<int>& deck = decks[length];
+    const size_t mark = swaps.size();
+
+    // Lazy Fisher-Yates over the deck: draw candidates in random order
+    // without repeats. The first legal draw is uniform over the legal
+    // placements, and after a dead end the next draw continues the same
+    // permutation. Deeper ships of the same length shuffle the same deck
+    // further and put it back before this level draws again.
+    for (size_t remaining = deck.size(); remaining > 0; --remaining) {
+        if (probes >= probeLimit) {
+            break;
+        }
+        ++probes;
+
+        const int pick = static_cast<int>(rng.below(static_cast<uint32_t>(remaining)));
+        const int last = static_cast<int>(remaining - 1);
+        std::swap(deck[pick], deck[last]);
+        swaps.push_back({ length, pick, last });
+
+        const Candidate& c = candidates[deck[last]];
+        if (!isFree(c, length)) {
+            continue;
+        }
+        cover(c, length, 1);
+        chosen[depth] = c;
+        if (search(depth + 1)) {
+            return true;
+        }
+        cover(c, length, -1);
+    }
+    undoSwaps(mark);
+    return false;
+}
+
+bool FleetGenerator::isFree(const Candidate& ship, int length) const {
+    const int first = ship.row * colCount + ship.col;
+    const int step = ship.direction == ShipDirection::HORIZONTAL ? 1 : colCount;
+    for (int i = 0; i < length; ++i) {
+        if (covered[first + i * step] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void FleetGenerator::cover(const Candidate& ship, int length, int delta) {
+    const int lastRow = ship.row + (ship.direction == ShipDirection::VERTICAL ? length - 1 : 0);
+    const int lastCol = ship.col + (ship.direction == ShipDirection::HORIZONTAL ? length - 1 : 0);
+    const int halo = shipsMayTouch ? 0 : 1;
+    const int left = std::max(ship.col - halo, 0);
+    const int right = std::min(lastCol + halo, colCount - 1);
+    for (int row = std::max(ship.row - halo, 0); row <= std::min(lastRow + halo, rowCount - 1); ++row) {
+        uint8_t* cells = &covered[row * colCount];
+        for (int col = left; col <= right; ++col) {
+            cells[col] = static_cast<uint8_t>(cells[col] + delta);
+        }
+    }
+}
+
+void FleetGenerator::undoSwaps(size_t mark) {
+    while (swaps.size() > mark) {
+        const Swap& swap = swaps.back();
+        std::vector<int>& deck = decks[swap.length];
+        std::swap(deck[swap.a], deck[swap.b]);
+        swaps.pop_back();
+    }
+}
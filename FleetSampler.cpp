@@ -0,0 +1,567 @@
+#include "FleetSampler.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <xmmintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define SAMPLER_PREFETCH(address) __builtin_prefetch(address)
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#define SAMPLER_PREFETCH(address) _mm_prefetch(reinterpret_cast<const char*>(address), _MM_HINT_T0)
+#else
+#define SAMPLER_PREFETCH(address)
+#endif
+
+namespace {
+
+const char samplerMagic[4] = { 'S', 'B', 'U', '1' };
+const size_t entrySize = 16;
+// Stage tables are split into buckets of about this many entries by a hash of
+// the state, so a lookup reads the bucket start and one or two cache lines
+const uint64_t entriesPerBucket = 4;
+
+// Profile entries: water, part of a finished ship, or a vertical ship
+// still growing (growingBase + length - 1)
+const int water = 0;
+const int finishedShip = 1;
+const int growingBase = 2;
+const int maxShipLength = 7 - growingBase + 1;
+const int maxCols = 16;
+
+// Per row boundary, the live states and their completions, sorted by state
+using Table = std::vector<std::pair<uint64_t, uint64_t>>;
+
+uint32_t readUint32(const uint8_t* data) {
+    return data[0] | (data[1] << 8) | (data[2] << 16) | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+uint64_t readUint64(const uint8_t* data) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+void appendUint32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+void appendUint64(std::string& out, uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((value >> (8 * i)) & 0xFF));
+    }
+}
+
+int bucketBits(uint64_t entries) {
+    int bits = 0;
+    while ((entriesPerBucket << bits) < entries) {
+        ++bits;
+    }
+    return bits;
+}
+
+uint64_t bucketOf(uint64_t state, int bits) {
+    return bits == 0 ? 0 : (state * 0x9E3779B97F4A7C15ull) >> (64 - bits);
+}
+
+std::vector<int> sortedFleet(const std::vector<int>& lengths) {
+    std::vector<int> sorted = lengths;
+    std::sort(sorted.begin(), sorted.end(), std::greater<int>());
+    return sorted;
+}
+
+// Every state one cell on from `layer`, sorted and without duplicates
+std::vector<uint64_t> expand(const FleetSampler::StateCoder& coder, const std::vector<uint64_t>& layer, int col) {
+    std::vector<uint64_t> next;
+    next.reserve(layer.size() * 2);
+    uint64_t state = 0;
+    for (uint64_t from : layer) {
+        for (bool occupied : { false, true }) {
+            if (coder.step(from, col, occupied, state)) {
+                next.push_back(state);
+            }
+        }
+    }
+    std::sort(next.begin(), next.end());
+    next.erase(std::unique(next.begin(), next.end()), next.end());
+    return next;
+}
+
+// Tables sit at the start of every row and at its middle column, so a
+// sample picks half a row at a time from a few dozen candidates
+int stagesPerRow(int cols) {
+    return cols >= 2 ? 2 : 1;
+}
+
+int stageBegin(int stage, int cols) {
+    return stage % stagesPerRow(cols) == 0 ? 0 : cols / 2;
+}
+
+int stageEnd(int stage, int cols) {
+    return stage % stagesPerRow(cols) == stagesPerRow(cols) - 1 ? cols : cols / 2;
+}
+
+bool addCount(uint64_t& sum, uint64_t value) {
+    sum += value;
+    return sum >= value;
+}
+
+// Forward over the cells to find every reachable state at each row start,
+// then backward row by row to count completions. A row's cell layers are
+// expanded again on the way back, so only row starts are kept throughout.
+// tables[stage] gets the live states where each stage begins.
+bool countLayouts(const FleetSampler::StateCoder& coder, int rows, std::vector<Table>& tables, std::string& error) {
+    const int cols = coder.cols();
+    const int perRow = stagesPerRow(cols);
+    std::vector<std::vector<uint64_t>> rowStarts(rows);
+    rowStarts[0].push_back(0);
+    for (int row = 0; row + 1 < rows; ++row) {
+        std::vector<uint64_t> layer = rowStarts[row];
+        for (int col = 0; col < cols; ++col) {
+            layer = expand(coder, layer, col);
+        }
+        rowStarts[row + 1].swap(layer);
+    }
+
+    // Only states that lead to a whole layout are kept
+    auto keepLive = [&](int stage, const std::vector<uint64_t>& layer, const std::vector<uint64_t>& weights) {
+        for (size_t i = 0; i < layer.size(); ++i) {
+            if (weights[i] > 0) {
+                tables[stage].emplace_back(layer[i], weights[i]);
+            }
+        }
+        return tables[stage].size() <= UINT32_MAX;
+    };
+    tables.assign(rows * perRow, Table());
+    for (int row = rows - 1; row >= 0; --row) {
+        std::vector<std::vector<uint64_t>> cells(cols);
+        cells[0].swap(rowStarts[row]);
+        for (int col = 1; col < cols; ++col) {
+            cells[col] = expand(coder, cells[col - 1], col - 1);
+        }
+        // Completions from each state of the cell layer after this one
+        std::vector<uint64_t> after;
+        std::vector<uint64_t> weights;
+        for (int col = cols - 1; col >= 0; --col) {
+            weights.assign(cells[col].size(), 0);
+            for (size_t i = 0; i < cells[col].size(); ++i) {
+                for (bool occupied : { false, true }) {
+                    uint64_t next = 0;
+                    if (!coder.step(cells[col][i], col, occupied, next)) {
+                        continue;
+                    }
+                    uint64_t ways = 0;
+                    if (col + 1 < cols) {
+                        const auto& nextLayer = cells[col + 1];
+                        ways = after[std::lower_bound(nextLayer.begin(), nextLayer.end(), next) - nextLayer.begin()];
+                    }
+                    else if (row + 1 == rows) {
+                        ways = coder.complete(next) ? 1 : 0;
+                    }
+                    else {
+                        const Table& nextRow = tables[(row + 1) * perRow];
+                        auto found = std::lower_bound(nextRow.begin(), nextRow.end(), std::make_pair(next, uint64_t(0)));
+                        ways = found != nextRow.end() && found->first == next ? found->second : 0;
+                    }
+                    if (!addCount(weights[i], ways)) {
+                        error = "more layouts than 64 bits can count";
+                        return false;
+                    }
+                }
+            }
+            after.swap(weights);
+            if (col + 1 < cols) {
+                cells[col + 1].clear();
+                cells[col + 1].shrink_to_fit();
+            }
+            const int stage = row * perRow + (col == 0 ? 0 : 1);
+            if ((col == 0 || (perRow == 2 && col == cols / 2)) && !keepLive(stage, cells[col], after)) {
+                error = "too many states to cache";
+                return false;
+            }
+        }
+    }
+    if (tables[0].empty()) {
+        error = "the fleet has no layout on the board";
+        return false;
+    }
+    return true;
+}
+
+// Header "SBU1", rows, cols, ship count, lengths longest first, zero
+// padding to 8 bytes, then per stage (half row) its entry count and bucket
+// bits (8 bytes each). Then per stage: the first entry of every bucket and the end
+// (4 bytes each, padded to 8 bytes) and the entries bucket by bucket, each
+// a state and its completions (8 bytes each).
+bool writeTables(const std::string& path, int rows, int cols, const std::vector<int>& lengths, const std::vector<Table>& tables) {
+    std::string header(samplerMagic, sizeof(samplerMagic));
+    header.push_back(static_cast<char>(rows));
+    header.push_back(static_cast<char>(cols));
+    header.push_back(static_cast<char>(lengths.size()));
+    for (int length : lengths) {
+        header.push_back(static_cast<char>(length));
+    }
+    header.resize((header.size() + 7) / 8 * 8, '\0');
+    for (const auto& table : tables) {
+        appendUint64(header, table.size());
+        appendUint64(header, bucketBits(table.size()));
+    }
+
+    // Written next to the cache and renamed, so a cut-off file is never mapped
+    const std::string partPath = path + ".part";
+    std::ofstream out(partPath, std::ios::binary | std::ios::trunc);
+    out.write(header.data(), header.size());
+    std::string block;
+    std::vector<uint32_t> starts;
+    std::vector<uint32_t> order;
+    for (const auto& table : tables) {
+        // Counting sort by bucket
+        const int bits = bucketBits(table.size());
+        starts.assign((1ull << bits) + 1, 0);
+        for (const auto& entry : table) {
+            ++starts[bucketOf(entry.first, bits) + 1];
+        }
+        for (size_t bucket = 1; bucket < starts.size(); ++bucket) {
+            starts[bucket] += starts[bucket - 1];
+        }
+        order.assign(table.size(), 0);
+        std::vector<uint32_t> next(starts.begin(), starts.end() - 1);
+        for (size_t i = 0; i < table.size(); ++i) {
+            order[next[bucketOf(table[i].first, bits)]++] = static_cast<uint32_t>(i);
+        }
+
+        for (uint32_t start : starts) {
+            appendUint32(block, start);
+        }
+        block.resize((block.size() + 7) / 8 * 8, '\0');
+        for (uint32_t index : order) {
+            appendUint64(block, table[index].first);
+            appendUint64(block, table[index].second);
+            if (block.size() >= (1u << 20)) {
+                out.write(block.data(), block.size());
+                block.clear();
+            }
+        }
+    }
+    out.write(block.data(), block.size());
+    out.close();
+    std::remove(path.c_str());
+    if (!out || std::rename(partPath.c_str(), path.c_str()) != 0) {
+        std::remove(partPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+}
+
+bool FleetSampler::StateCoder::init(const Rules& rules, std::string& error) {
+    if (rules.shipsMayTouch) {
+        error = "exact counting needs ships that may not touch";
+        return false;
+    }
+    if (rules.cols > maxCols || rules.maxShipLength() > maxShipLength) {
+        error = "exact counting handles up to " + std::to_string(maxCols) + " columns and ships of length " + std::to_string(maxShipLength);
+        return false;
+    }
+    colCount = rules.cols;
+    maxLength = rules.maxShipLength();
+    counts.assign(maxLength + 1, 0);
+    for (int length : rules.shipLengths) {
+        ++counts[length];
+    }
+    diagShift = 3 * colCount;
+    runShift = diagShift + 3;
+    fleetShift = runShift + 3;
+    // Each length gets just enough bits to count its ships
+    fieldMasks.assign(maxLength + 1, 0);
+    fieldFull.assign(maxLength + 1, 0);
+    fieldOne.assign(maxLength + 1, 0);
+    fullFleet = 0;
+    int shift = 0;
+    for (int length = 1; length <= maxLength; ++length) {
+        int width = 0;
+        while ((1 << width) <= counts[length]) {
+            ++width;
+        }
+        if (fleetShift + shift + width > 64) {
+            error = "too many columns and ship kinds for exact counting";
+            return false;
+        }
+        fieldOne[length] = 1ull << shift;
+        fieldMasks[length] = ((1ull << width) - 1) << shift;
+        fieldFull[length] = static_cast<uint64_t>(counts[length]) << shift;
+        fullFleet |= fieldFull[length];
+        shift += width;
+    }
+    return true;
+}
+
+// No division: finishing a ship is a compare and an add on its length's field
+bool FleetSampler::StateCoder::finishShip(uint64_t& finished, int length) const {
+    if (length > maxLength || (finished & fieldMasks[length]) == fieldFull[length]) {
+        return false;
+    }
+    finished += fieldOne[length];
+    return true;
+}
+
+bool FleetSampler::StateCoder::step(uint64_t state, int col, bool occupied, uint64_t& next) const {
+    auto entry = [&](int at) { return static_cast<int>((state >> (3 * at)) & 7); };
+    const int above = entry(col);
+    const int aboveRight = col + 1 < colCount ? entry(col + 1) : water;
+    const int left = col > 0 ? entry(col - 1) : water;
+    const int diag = static_cast<int>((state >> diagShift) & 7);
+    int run = static_cast<int>((state >> runShift) & 7);
+    uint64_t finished = state >> fleetShift;
+    uint64_t profile = state & ((1ull << diagShift) - 1);
+    auto setEntry = [&](int at, int value) { profile = (profile & ~(7ull << (3 * at))) | (static_cast<uint64_t>(value) << (3 * at)); };
+
+    if (!occupied) {
+        // Ends the horizontal ship to the left and the vertical one above
+        if (run >= 2 && !finishShip(finished, run)) {
+            return false;
+        }
+        run = 0;
+        if (above >= growingBase && !finishShip(finished, above - growingBase + 1)) {
+            return false;
+        }
+        setEntry(col, water);
+    }
+    else if (above == finishedShip) {
+        return false;
+    }
+    else if (above >= growingBase) {
+        // Grows the vertical ship above; nothing beside it can be a ship
+        if (above - growingBase + 1 >= maxLength || left != water) {
+            return false;
+        }
+        setEntry(col, above + 1);
+        run = 0;
+    }
+    else if (diag != water || aboveRight != water) {
+        return false;
+    }
+    else if (left != water) {
+        // Extends the horizontal ship to the left, which a vertical ship cannot be
+        if (run == 0 || run >= maxLength) {
+            return false;
+        }
+        setEntry(col - 1, finishedShip);
+        setEntry(col, finishedShip);
+        ++run;
+    }
+    else {
+        // A new ship: horizontal if the next cell joins it, else it may grow down
+        setEntry(col, growingBase);
+        run = 1;
+    }
+
+    int nextDiag = above;
+    if (col + 1 == colCount) {
+        if (run >= 2 && !finishShip(finished, run)) {
+            return false;
+        }
+        run = 0;
+        nextDiag = water;
+    }
+    next = profile | (static_cast<uint64_t>(nextDiag) << diagShift) | (static_cast<uint64_t>(run) << runShift) | (finished << fleetShift);
+    return true;
+}
+
+bool FleetSampler::StateCoder::complete(uint64_t state) const {
+    uint64_t finished = state >> fleetShift;
+    for (int col = 0; col < colCount; ++col) {
+        const int entry = static_cast<int>((state >> (3 * col)) & 7);
+        if (entry >= growingBase && !finishShip(finished, entry - growingBase + 1)) {
+            return false;
+        }
+    }
+    return finished == fullFleet;
+}
+
+std::string FleetSampler::defaultCachePath(const Rules& rules) {
+    std::string path = "layouts-" + std::to_string(rules.rows) + "x" + std::to_string(rules.cols) + "-";
+    for (int length : sortedFleet(rules.shipLengths)) {
+        path += std::to_string(length);
+    }
+    return path + ".sbu";
+}
+
+bool FleetSampler::open(const Rules& rules, const std::string& cachePath, std::string& error) {
+    if (openCached(rules, cachePath, error)) {
+        return true;
+    }
+    // Whatever is there may be tables someone still wants for other rules
+    if (std::ifstream(cachePath, std::ios::binary)) {
+        error += "; remove it to count the layouts again";
+        return false;
+    }
+    StateCoder counter;
+    if (!counter.init(rules, error)) {
+        return false;
+    }
+    std::cerr << "Counting layouts for " << cachePath << "..." << std::endl;
+    std::vector<Table> tables;
+    if (!countLayouts(counter, rules.rows, tables, error)) {
+        return false;
+    }
+    if (!writeTables(cachePath, rules.rows, rules.cols, sortedFleet(rules.shipLengths), tables)) {
+        error = "cannot write " + cachePath;
+        return false;
+    }
+    return openCached(rules, cachePath, error);
+}
+
+bool FleetSampler::openCached(const Rules& rules, const std::string& cachePath, std::string& error) {
+    file.close();
+    layers.clear();
+    if (!coder.init(rules, error)) {
+        return false;
+    }
+    if (!file.open(cachePath)) {
+        error = "cannot open " + cachePath;
+        return false;
+    }
+    const uint8_t* data = file.data();
+    const std::vector<int> lengths = sortedFleet(rules.shipLengths);
+    const size_t headerSize = (7 + lengths.size() + 7) / 8 * 8;
+    const int stageCount = rules.rows * stagesPerRow(rules.cols);
+    if (file.size() < headerSize + 16 * stageCount || !std::equal(samplerMagic, samplerMagic + 4, data) || data[4] != rules.rows
+        || data[5] != rules.cols || data[6] != lengths.size() || !std::equal(lengths.begin(), lengths.end(), data + 7)) {
+        error = cachePath + " is not a layout table for these rules";
+        return false;
+    }
+    rows = rules.rows;
+    cols = rules.cols;
+    size_t offset = headerSize + 16 * stageCount;
+    for (int stage = 0; stage < stageCount; ++stage) {
+        Layer layer;
+        layer.size = readUint64(data + headerSize + 16 * stage);
+        const uint64_t bits = readUint64(data + headerSize + 16 * stage + 8);
+        if (layer.size > UINT32_MAX || bits != static_cast<uint64_t>(bucketBits(layer.size))) {
+            error = cachePath + " is damaged";
+            return false;
+        }
+        layer.bucketBits = static_cast<int>(bits);
+        const size_t bucketBytes = ((4ull << bits) + 4 + 7) / 8 * 8;
+        if (bucketBytes + layer.size * entrySize > file.size() - offset) {
+            error = cachePath + " is cut off";
+            return false;
+        }
+        layer.buckets = data + offset;
+        layer.entries = data + offset + bucketBytes;
+        layers.push_back(layer);
+        offset += bucketBytes + layer.size * entrySize;
+    }
+    totalLayouts = completions(0, 0);
+    if (offset != file.size() || totalLayouts == 0) {
+        error = cachePath + " is damaged";
+        return false;
+    }
+    rowCells.assign(rows, 0);
+    return true;
+}
+
+uint64_t FleetSampler::completions(int stage, uint64_t state) const {
+    const Layer& layer = layers[stage];
+    const uint8_t* bucket = layer.buckets + 4 * bucketOf(state, layer.bucketBits);
+    // Clamped so that a damaged file cannot read past the mapping
+    const uint64_t last = std::min<uint64_t>(readUint32(bucket + 4), layer.size);
+    for (uint64_t i = readUint32(bucket); i < last; ++i) {
+        if (readUint64(layer.entries + i * entrySize) == state) {
+            return readUint64(layer.entries + i * entrySize + 8);
+        }
+    }
+    return 0;
+}
+
+void FleetSampler::addSegments(uint64_t state, int col, int last, uint32_t cells) {
+    if (col == last) {
+        candidates.push_back({ state, cells, 0 });
+        return;
+    }
+    uint64_t next = 0;
+    if (coder.step(state, col, false, next)) {
+        addSegments(next, col + 1, last, cells);
+    }
+    if (coder.step(state, col, true, next)) {
+        addSegments(next, col + 1, last, cells | (1u << col));
+    }
+}
+
+void FleetSampler::weighSegments(int nextStage) {
+    if (nextStage == static_cast<int>(layers.size())) {
+        for (auto& candidate : candidates) {
+            candidate.weight = coder.complete(candidate.state) ? 1 : 0;
+        }
+        return;
+    }
+    // Almost every lookup is a cache miss: touching all the buckets first,
+    // then all the entries, lets the misses overlap
+    const Layer& layer = layers[nextStage];
+    for (const auto& candidate : candidates) {
+        SAMPLER_PREFETCH(layer.buckets + 4 * bucketOf(candidate.state, layer.bucketBits));
+    }
+    for (const auto& candidate : candidates) {
+        const uint8_t* bucket = layer.buckets + 4 * bucketOf(candidate.state, layer.bucketBits);
+        SAMPLER_PREFETCH(layer.entries + std::min<uint64_t>(readUint32(bucket), layer.size) * entrySize);
+    }
+    for (auto& candidate : candidates) {
+        candidate.weight = completions(nextStage, candidate.state);
+    }
+}
+
+void FleetSampler::sample(Rng& rng, std::vector<ShipPlacement>& fleet) {
+    std::fill(rowCells.begin(), rowCells.end(), 0);
+    uint64_t state = 0;
+    uint64_t ways = totalLayouts;
+    const int perRow = stagesPerRow(cols);
+    for (int stage = 0; stage < static_cast<int>(layers.size()); ++stage) {
+        candidates.clear();
+        addSegments(state, stageBegin(stage, cols), stageEnd(stage, cols), 0);
+        weighSegments(stage + 1);
+        // The weights add up to the completions of `state`
+        uint64_t pick = rng.below64(ways);
+        size_t chosen = 0;
+        while (pick >= candidates[chosen].weight) {
+            pick -= candidates[chosen].weight;
+            ++chosen;
+        }
+        state = candidates[chosen].state;
+        ways = candidates[chosen].weight;
+        rowCells[stage / perRow] |= candidates[chosen].cells;
+    }
+
+    // Ships are the maximal straight runs of cells
+    fleet.clear();
+    auto occupied = [&](int row, int col) { return row < rows && col < cols && ((rowCells[row] >> col) & 1) != 0; };
+    for (int row = 0; row < rows; ++row) {
+        for (int col = 0; col < cols; ++col) {
+            if (!occupied(row, col) || (row > 0 && occupied(row - 1, col)) || (col > 0 && occupied(row, col - 1))) {
+                continue;
+            }
+            ShipPlacement ship = { 1, row, col, ShipDirection::HORIZONTAL };
+            if (occupied(row, col + 1)) {
+                while (occupied(row, col + ship.length)) {
+                    ++ship.length;
+                }
+            }
+            else {
+                while (occupied(row + ship.length, col)) {
+                    ++ship.length;
+                }
+                ship.direction = ship.length > 1 ? ShipDirection::VERTICAL : ShipDirection::HORIZONTAL;
+            }
+            fleet.push_back(ship);
+        }
+    }
+    std::stable_sort(fleet.begin(), fleet.end(), [](const ShipPlacement& a, const ShipPlacement& b) { return a.length > b.length; });
+}
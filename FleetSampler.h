@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "FleetGenerator.h"
+#include "MappedFile.h"
+#include "Random.h"
+#include "Rules.h"
+
+// Exactly uniform layouts of a no-touch fleet. FleetGenerator places ships
+// one at a time and so favours some layouts over others; this counts every
+// layout instead, with a DP over the cells in row-major order. Its state is
+// the profile of the row above (per column: water, part of a finished ship,
+// or a vertical ship still growing and its length so far), the horizontal
+// ship being built and how many ships of each length are finished.
+//
+// For every live state at the start and the middle of a row the tables keep
+// the number of ways to complete the board. A sample walks down the board
+// half a row at a time and picks each next half row with probability
+// proportional to the completions it leaves, so every layout comes up with
+// probability exactly 1 / layoutCount().
+//
+// Counting the classic game takes about a minute. The tables are cached in
+// a file ("SBU1", about 190 MB for 10x10) that later runs only map in.
+class FleetSampler {
+public:
+    // Maps the tables cached in `cachePath`; if there is no such file, counts
+    // first and writes it. False, leaving the file alone, if it holds tables
+    // for other rules or is damaged. False for rules the DP cannot hold
+    // (touching ships, more than 16 columns, ships longer than 6) or with
+    // more layouts than 64 bits can count.
+    bool open(const Rules& rules, const std::string& cachePath, std::string& error);
+    // Maps the cache only; false if it is missing or for other rules
+    bool openCached(const Rules& rules, const std::string& cachePath, std::string& error);
+
+    // Layouts of the fleet, ships of equal length being interchangeable
+    uint64_t layoutCount() const { return totalLayouts; }
+
+    // Ships longest first. Needs no more memory once the first sample has
+    // been drawn; one sampler per thread.
+    void sample(Rng& rng, std::vector<ShipPlacement>& fleet);
+
+    // Cache file name for `rules`, e.g. "layouts-10x10-4332221111.sbu"
+    static std::string defaultCachePath(const Rules& rules);
+
+    // DP state packed into 64 bits: 3 bits per column of the profile, the
+    // profile entry of the cell up-left, the length of the horizontal ship
+    // being built, then per ship length a field counting its finished ships
+    class StateCoder {
+    public:
+        // False if the rules do not fit the packing
+        bool init(const Rules& rules, std::string& error);
+
+        int cols() const { return colCount; }
+        // One cell, water or ship; false if that breaks the rules
+        bool step(uint64_t state, int col, bool occupied, uint64_t& next) const;
+        // After the last row: true if finishing the growing ships completes the fleet exactly
+        bool complete(uint64_t state) const;
+
+    private:
+        int colCount = 0;
+        int maxLength = 0;
+        int diagShift = 0;
+        int runShift = 0;
+        int fleetShift = 0;
+        std::vector<int> counts;            // ships per length, index 0 unused
+        std::vector<uint64_t> fieldMasks;   // finished-ship field of each length, in place
+        std::vector<uint64_t> fieldFull;    // the field with every ship of the length finished
+        std::vector<uint64_t> fieldOne;     // one ship in the field
+        uint64_t fullFleet = 0;
+
+        bool finishShip(uint64_t& finished, int length) const;
+    };
+
+private:
+    // A candidate for the next half row: the state it leads to, its cells
+    // and weight
+    struct Segment {
+        uint64_t state;
+        uint32_t cells;
+        uint64_t weight;
+    };
+
+    MappedFile file;
+    StateCoder coder;
+    int rows = 0;
+    int cols = 0;
+    uint64_t totalLayouts = 0;
+    // Per stage, where each half row begins: (state, completions) pairs,
+    // grouped in buckets by a hash of the state
+    struct Layer {
+        const uint8_t* buckets;
+        const uint8_t* entries;
+        uint64_t size;
+        int bucketBits;
+    };
+    std::vector<Layer> layers;
+
+    std::vector<Segment> candidates;
+    std::vector<uint32_t> rowCells;
+
+    uint64_t completions(int stage, uint64_t state) const;
+    // Every way to fill columns `col` .. `last` - 1 after `state`
+    void addSegments(uint64_t state, int col, int last, uint32_t cells);
+    // Completions each candidate leaves, 0 for a dead end
+    void weighSegments(int nextStage);
+};
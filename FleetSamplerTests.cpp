@@ -0,0 +1,179 @@
+// FleetSampler on a board small enough to list every layout: the DP's count
+// must match the list, and samples must hit every layout about equally often.
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+#include "FleetSampler.h"
+#include "TestCheck.h"
+
+namespace {
+
+// A layout as the cell masks of its ships, sorted, so that ships of equal
+// length are interchangeable
+using Layout = std::vector<uint32_t>;
+
+// Every no-touch layout of `lengths` (longest first)
+class LayoutList {
+public:
+    LayoutList(int rows, int cols, const std::vector<int>& lengths) : rows(rows), cols(cols), lengths(lengths) {
+        place(0, 0, 0);
+    }
+
+    // Index of the layout, -1 if it is not one
+    int find(const std::vector<ShipPlacement>& fleet) const {
+        Layout layout;
+        for (const auto& ship : fleet) {
+            layout.push_back(shipCells(ship.row, ship.col, ship.length, ship.direction == ShipDirection::VERTICAL));
+        }
+        std::sort(layout.begin(), layout.end());
+        const auto at = index.find(layout);
+        return at != index.end() ? at->second : -1;
+    }
+
+    int size() const { return static_cast<int>(index.size()); }
+
+private:
+    int rows;
+    int cols;
+    std::vector<int> lengths;
+    Layout chosen;
+    std::map<Layout, int> index;
+
+    // 0 if the ship leaves the board
+    uint32_t shipCells(int row, int col, int length, bool vertical) const {
+        uint32_t cells = 0;
+        for (int i = 0; i < length; ++i) {
+            const int r = row + (vertical ? i : 0);
+            const int c = col + (vertical ? 0 : i);
+            if (r >= rows || c >= cols) {
+                return 0;
+            }
+            cells |= 1u << (r * cols + c);
+        }
+        return cells;
+    }
+
+    uint32_t halo(uint32_t cells) const {
+        uint32_t around = 0;
+        for (int cell = 0; cell < rows * cols; ++cell) {
+            if (!((cells >> cell) & 1u)) {
+                continue;
+            }
+            for (int r = cell / cols - 1; r <= cell / cols + 1; ++r) {
+                for (int c = cell % cols - 1; c <= cell % cols + 1; ++c) {
+                    if (r >= 0 && r < rows && c >= 0 && c < cols) {
+                        around |= 1u << (r * cols + c);
+                    }
+                }
+            }
+        }
+        return around;
+    }
+
+    void place(size_t slot, int first, uint32_t taken) {
+        if (slot == lengths.size()) {
+            Layout layout = chosen;
+            std::sort(layout.begin(), layout.end());
+            index.emplace(layout, static_cast<int>(index.size()));
+            return;
+        }
+        // Ships of the same length in increasing order, so each layout comes once
+        const bool sameAsLast = slot > 0 && lengths[slot - 1] == lengths[slot];
+        for (int start = sameAsLast ? first : 0; start < 2 * rows * cols; ++start) {
+            const bool vertical = start >= rows * cols;
+            if (vertical && lengths[slot] == 1) {
+                break;
+            }
+            const int cell = start % (rows * cols);
+            const uint32_t cells = shipCells(cell / cols, cell % cols, lengths[slot], vertical);
+            if (cells == 0 || (cells & taken)) {
+                continue;
+            }
+            chosen.push_back(cells);
+            place(slot + 1, start + 1, taken | halo(cells));
+            chosen.pop_back();
+        }
+    }
+};
+
+void checkUniform(int rows, int cols, const std::vector<int>& lengths, int samplesPerLayout) {
+    Rules rules;
+    rules.rows = rows;
+    rules.cols = cols;
+    rules.shipLengths = lengths;
+    const std::string path = "sampler-test-" + std::to_string(rows) + "x" + std::to_string(cols) + ".sbu";
+    std::remove(path.c_str());
+    FleetSampler sampler;
+    std::string error;
+    CHECK(sampler.open(rules, path, error));
+
+    const LayoutList layouts(rows, cols, lengths);
+    CHECK(sampler.layoutCount() == static_cast<uint64_t>(layouts.size()));
+
+    const int samples = samplesPerLayout * layouts.size();
+    std::vector<int> seen(layouts.size(), 0);
+    Rng rng(5);
+    std::vector<ShipPlacement> fleet;
+    int invalid = 0;
+    for (int i = 0; i < samples; ++i) {
+        sampler.sample(rng, fleet);
+        const int layout = layouts.find(fleet);
+        if (layout < 0) {
+            ++invalid;
+            continue;
+        }
+        ++seen[layout];
+    }
+    CHECK(invalid == 0);
+
+    // Chi-square against the uniform distribution: the statistic has mean
+    // `freedom` and deviation sqrt(2 * freedom); five deviations are allowed
+    const double expected = static_cast<double>(samples) / layouts.size();
+    double chiSquare = 0;
+    for (int count : seen) {
+        chiSquare += (count - expected) * (count - expected) / expected;
+    }
+    const double freedom = layouts.size() - 1;
+    if (chiSquare > freedom + 5 * std::sqrt(2 * freedom)) {
+        std::cerr << rows << "x" << cols << ": chi-square " << chiSquare << " with " << freedom << " degrees of freedom" << std::endl;
+    }
+    CHECK(chiSquare <= freedom + 5 * std::sqrt(2 * freedom));
+    CHECK(*std::min_element(seen.begin(), seen.end()) > 0);
+    std::remove(path.c_str());
+}
+
+// An explicit tables file built for other rules is refused, not overwritten
+void checkOtherRules() {
+    Rules small;
+    small.rows = 4;
+    small.cols = 4;
+    small.shipLengths = { 2, 1 };
+    Rules other = small;
+    other.shipLengths = { 2, 1, 1 };
+    const std::string path = "sampler-test-rules.sbu";
+    std::remove(path.c_str());
+    FleetSampler sampler;
+    std::string error;
+    CHECK(sampler.open(small, path, error));
+    const uint64_t count = sampler.layoutCount();
+    FleetSampler second;
+    CHECK(!second.open(other, path, error));
+    FleetSampler third;
+    CHECK(third.openCached(small, path, error) && third.layoutCount() == count);
+    std::remove(path.c_str());
+}
+
+}
+
+int main() {
+    checkUniform(5, 5, { 3, 2, 1, 1 }, 30);
+    checkUniform(4, 6, { 3, 2, 2, 1 }, 30);
+    checkOtherRules();
+    return testResult();
+}
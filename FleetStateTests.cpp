@@ -0,0 +1,117 @@
+// FleetState::undo() against snapshots taken before every fire(): taking
+// all shots back in reverse must restore every mark and every ship's state,
+// with and without the touching rule.
+#include <utility>
+#include <vector>
+#include "GameState.h"
+#include "Random.h"
+#include "TestCheck.h"
+
+namespace {
+
+// Everything FleetState shows about the shots so far
+struct Snapshot {
+    std::vector<CellMark> marks;
+    std::vector<bool> sunk;
+    int shipsLeft;
+    int shotsFired;
+
+    explicit Snapshot(const FleetState& state) : shipsLeft(state.shipsLeft()), shotsFired(state.shotsFired()) {
+        for (int row = 0; row < state.rows(); ++row) {
+            for (int col = 0; col < state.cols(); ++col) {
+                marks.push_back(state.mark(row, col));
+            }
+        }
+        for (size_t ship = 0; ship < state.ships().size(); ++ship) {
+            sunk.push_back(state.isSunk(static_cast<int>(ship)));
+        }
+    }
+
+    bool operator==(const Snapshot& other) const {
+        return marks == other.marks && sunk == other.sunk && shipsLeft == other.shipsLeft && shotsFired == other.shotsFired;
+    }
+};
+
+// Shoots every cell in a random order, some of them twice, then undoes it all
+void checkUndo(const Rules& rules, uint64_t seed) {
+    std::vector<Ship> ships;
+    autoPlaceShipsInPlacement(ships, rules, seed);
+    CHECK(!ships.empty());
+    FleetState state(rules.rows, rules.cols, rules.shipsMayTouch);
+    state.setFleet(ships);
+
+    const int cells = rules.cellCount();
+    std::vector<int> order;
+    for (int cell = 0; cell < cells; ++cell) {
+        order.push_back(cell);
+    }
+    Rng rng(seed);
+    for (int i = cells - 1; i > 0; --i) {
+        std::swap(order[i], order[rng.below(i + 1)]);
+    }
+    for (int i = 0; i < cells / 4; ++i) {
+        order.insert(order.begin() + rng.below(order.size()), order[rng.below(order.size())]);
+    }
+
+    std::vector<Snapshot> before;
+    for (int cell : order) {
+        before.emplace_back(state);
+        const int row = cell / rules.cols;
+        const int col = cell % rules.cols;
+        const CellMark was = state.mark(row, col);
+        const ShotResult result = state.fire(row, col);
+        CHECK(state.shotsFired() == static_cast<int>(before.size()));
+        if (was != CellMark::NONE) {
+            // Reports the mark again and changes nothing
+            CHECK(result == (was == CellMark::HIT ? ShotResult::HIT : ShotResult::MISS));
+            CHECK(Snapshot(state).marks == before.back().marks);
+        }
+        else {
+            CHECK((result == ShotResult::MISS) == (state.shipAt(row, col) < 0));
+            CHECK(state.mark(row, col) == (result == ShotResult::MISS ? CellMark::MISS : CellMark::HIT));
+        }
+    }
+    CHECK(state.defeated());
+    while (!before.empty()) {
+        state.undo();
+        CHECK(Snapshot(state) == before.back());
+        before.pop_back();
+    }
+}
+
+// Sinking marks the water around the ship, and undo takes it back
+void checkHalo() {
+    FleetState state(4, 4);
+    state.setFleet({ { 2, 1, 1, ShipDirection::HORIZONTAL } });
+    CHECK(state.fire(1, 1) == ShotResult::HIT);
+    CHECK(state.mark(0, 0) == CellMark::NONE);
+    CHECK(state.fire(1, 2) == ShotResult::SUNK);
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 4; ++col) {
+            CHECK(state.mark(row, col) == (row == 1 && (col == 1 || col == 2) ? CellMark::HIT : CellMark::MISS));
+        }
+    }
+    CHECK(state.mark(3, 0) == CellMark::NONE);
+    state.undo();
+    CHECK(state.mark(0, 0) == CellMark::NONE && state.mark(1, 2) == CellMark::NONE && state.mark(1, 1) == CellMark::HIT);
+    CHECK(!state.isSunk(0) && state.shipsLeft() == 1);
+}
+
+}
+
+int main() {
+    Rules classic;
+    Rules touching;
+    touching.shipsMayTouch = true;
+    Rules large;
+    large.rows = 20;
+    large.cols = 24;
+    large.shipLengths = { 5, 4, 4, 3, 3, 3, 2, 2, 2, 2, 1, 1 };
+    for (uint64_t seed = 0; seed < 20; ++seed) {
+        checkUndo(classic, seed);
+        checkUndo(touching, seed);
+        checkUndo(large, seed);
+    }
+    checkHalo();
+    return testResult();
+}
@@ -0,0 +1,121 @@
+#include "FrameLoop.h"
+#include <iostream>
+#include "Profiler.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+namespace {
+
+// How often CPU usage is sampled (and logged, if enabled)
+const float statsIntervalSeconds = 5.0f;
+
+// Startup budget from process start to the first frame on screen
+const float firstFrameBudgetMs = 50;
+
+// CPU time used by the whole process so far
+double processCpuSeconds() {
+#ifdef _WIN32
+    // std::clock() is wall time on MSVC
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+        return 0;
+    }
+    auto toSeconds = [](const FILETIME& time) {
+        return ((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 1e-7;
+    };
+    return toSeconds(kernel) + toSeconds(user);
+#else
+    return static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+#endif
+}
+
+}
+
+FrameLoop::FrameLoop(sf::RenderWindow& window, const FrameLoopSettings& settings)
+    : window(window), settings(settings), statsCpuStart(processCpuSeconds()) {
+    applyPacing();
+}
+
+bool FrameLoop::pollEvent(sf::Event& event) {
+    if (!dirty && !animating && !waitedThisFrame && window.isOpen()) {
+        // Nothing to draw: sleep until the OS has something for us
+        waitedThisFrame = true;
+        if (window.waitEvent(event)) {
+            dirty = true;
+            return true;
+        }
+        return false;
+    }
+    if (window.pollEvent(event)) {
+        dirty = true;
+        return true;
+    }
+    return false;
+}
+
+void FrameLoop::setAnimating(bool value) {
+    if (animating == value) {
+        return;
+    }
+    animating = value;
+    applyPacing();
+}
+
+bool FrameLoop::beginFrame() {
+    waitedThisFrame = false;
+    updateCpuUsage();
+    if (!window.isOpen() || (!dirty && !animating)) {
+        return false;
+    }
+    frameClock.restart();
+    return true;
+}
+
+void FrameLoop::endFrame() {
+    {
+        ProfileScope scope("RenderWindow::display");
+        window.display();
+    }
+    dirty = false;
+    frameStats.drawCalls = Profiler::takeDrawCalls();
+
+    const float frameMs = frameClock.getElapsedTime().asMicroseconds() / 1000.0f;
+    if (frameStats.frames == 0) {
+        frameStats.firstFrameMs = Profiler::now() / 1e6f;
+        if (settings.logStats) {
+            std::cout << "First frame after " << frameStats.firstFrameMs << " ms"
+                      << (frameStats.firstFrameMs > firstFrameBudgetMs ? " (over budget)" : "") << std::endl;
+        }
+    }
+    ++frameStats.frames;
+    frameStats.lastFrameMs = frameMs;
+    // Exponential moving average, enough for a status readout
+    frameStats.averageFrameMs += (frameMs - frameStats.averageFrameMs) * 0.05f;
+}
+
+void FrameLoop::applyPacing() {
+    const bool useVsync = animating && settings.vsync;
+    window.setVerticalSyncEnabled(useVsync);
+    window.setFramerateLimit(useVsync ? 0 : settings.frameLimit);
+}
+
+void FrameLoop::updateCpuUsage() {
+    const float wallSeconds = statsClock.getElapsedTime().asSeconds();
+    if (wallSeconds < statsIntervalSeconds) {
+        return;
+    }
+    const double now = processCpuSeconds();
+    frameStats.cpuPercent = static_cast<float>(100.0 * (now - statsCpuStart) / wallSeconds);
+    statsCpuStart = now;
+    statsClock.restart();
+
+    if (settings.logStats) {
+        std::cout << "frames: " << frameStats.frames << ", frame time: " << frameStats.averageFrameMs
+                  << " ms, CPU: " << frameStats.cpuPercent << "%" << std::endl;
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+
+struct FrameLoopSettings {
+    unsigned frameLimit = 60;   // cap while redrawing, 0 - none
+    bool vsync = false;         // used instead of the cap while animating
+    bool logStats = false;      // print the first frame time, then FrameStats every few seconds, to stdout
+};
+
+struct FrameStats {
+    uint64_t frames = 0;        // frames actually drawn
+    float lastFrameMs = 0;      // draw + display time of the last frame
+    float averageFrameMs = 0;   // running average of the same
+    float cpuPercent = 0;       // process CPU time / wall time over the last interval
+    unsigned drawCalls = 0;     // of the last frame, as counted with Profiler::countDrawCalls
+    float firstFrameMs = 0;     // from process start (the profiler's epoch) to the first display()
+};
+
+// Event loop shared by every window. When nothing is animating and nothing
+// changed, pollEvent() blocks in waitEvent() so an idle screen costs no CPU;
+// any event (or requestRedraw()) marks the frame dirty and exactly one frame
+// is drawn for it. While animating, frames are paced by vsync or the limit.
+//
+//     FrameLoop frames(window);
+//     while (window.isOpen()) {
+//         sf::Event event;
+//         while (frames.pollEvent(event)) { ... }
+//         if (!frames.beginFrame()) continue;
+//         ... draw ...
+//         frames.endFrame();   // calls window.display()
+//     }
+class FrameLoop {
+public:
+    explicit FrameLoop(sf::RenderWindow& window, const FrameLoopSettings& settings = FrameLoopSettings());
+
+    bool pollEvent(sf::Event& event);
+
+    void requestRedraw() { dirty = true; }
+    void setAnimating(bool animating);
+
+    // True if this iteration has to draw; starts the frame timer
+    bool beginFrame();
+    void endFrame();
+
+    const FrameStats& stats() const { return frameStats; }
+
+private:
+    sf::RenderWindow& window;
+    FrameLoopSettings settings;
+    FrameStats frameStats;
+    bool dirty = true;
+    bool animating = false;
+    bool waitedThisFrame = false;
+
+    sf::Clock frameClock;
+    sf::Clock statsClock;
+    double statsCpuStart;
+
+    void applyPacing();
+    void updateCpuUsage();
+};
@@ -0,0 +1,193 @@
+#include "GameScene.h"
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include "ReplayScene.h"
+
+namespace {
+
+const int windowWidth = 1400;
+const int windowHeight = 700;
+
+const int boardMarginLeft = 50;
+const int boardMarginTop = 50;
+const int boardMarginBottom = 50;
+const int boardMarginRight = 50;
+
+const int gridRows = 10;
+const int gridCols = 10;
+
+const int spaceBetweenBoards = 250;
+
+const float cellSizeX = static_cast<float>(windowWidth - boardMarginLeft - boardMarginRight - spaceBetweenBoards) / (2 * gridCols);
+const float cellSizeY = static_cast<float>(windowHeight - boardMarginTop - boardMarginBottom) / gridRows;
+
+const float opponentBoardLeft = boardMarginLeft + gridCols * cellSizeX + spaceBetweenBoards;
+const BoardLayout playerLayout = { static_cast<float>(boardMarginLeft), static_cast<float>(boardMarginTop), cellSizeX, cellSizeY, gridRows, gridCols };
+const BoardLayout opponentLayout = { opponentBoardLeft, static_cast<float>(boardMarginTop), cellSizeX, cellSizeY, gridRows, gridCols };
+
+// Zoom per wheel notch
+const float wheelZoom = 1.25f;
+
+}
+
+GameScene::GameScene(SceneStack& stack, std::vector<Ship> playerShips, bool withComputer)
+    : Scene(stack),
+      font(stack.assets().font("arial.ttf")),
+      pauseButton("Pause", *font, sf::Color::White, sf::Color::Yellow, sf::Color::Red, windowWidth / 2.0f, windowHeight / 2.0f - 50),   // Centered
+      exitButton("Exit", *font, sf::Color::White, sf::Color::Yellow, sf::Color::Red, windowWidth / 2.0f, windowHeight / 2.0f + 50),     // Centered
+      playerShips(std::move(playerShips)),
+      views{ BoardView(playerLayout.bounds(), stack.rules().rows, stack.rules().cols),
+             BoardView(opponentLayout.bounds(), stack.rules().rows, stack.rules().cols) },
+      session(stack.rules(), this->playerShips, withComputer, std::random_device()(), lastGameReplay),
+      text(font) {
+    input.addBoard(views[0], [](int row, int col) { std::cout << "Clicked on cell: " << row << ", " << col << std::endl; });
+    // Player's shot at the computer fleet
+    input.addBoard(views[1], [this](int row, int col) {
+        if (!isPaused) {
+            session.shoot(row, col);
+        }
+    });
+    input.addButton(pauseButton, [this]() { togglePause(); });
+    // Back to the main menu
+    input.addButton(exitButton, [this]() { this->stack.pop(); });
+}
+
+sf::Vector2u battleWindowSize() {
+    return sf::Vector2u(windowWidth, windowHeight);
+}
+
+const BoardLayout& battleBoardLayout(int side) {
+    return side == 0 ? playerLayout : opponentLayout;
+}
+
+sf::Vector2u GameScene::size() const {
+    return sf::Vector2u(windowWidth, windowHeight);
+}
+
+bool GameScene::load() {
+    // Both boards share one texture; the cache has it loaded already
+    std::shared_ptr<const sf::Texture> boardTexture = stack.assets().texture("field.png");
+    if (!boardTexture) {
+        return false;
+    }
+    if (!boardLayer.create(windowWidth, windowHeight)) {
+        std::cerr << "Error creating board layer!" << std::endl;
+        return false;
+    }
+    bakeBoards();
+
+    // Worst case: every own cell a ship (outline and fill) plus a mark, every opponent cell a mark
+    const size_t cellCount = stack.rules().cellCount();
+    cells[0].reserve(3 * cellCount);
+    cells[1].reserve(cellCount);
+    return true;
+}
+
+int GameScene::boardAt(sf::Vector2f point) const {
+    for (int side = 0; side < 2; ++side) {
+        if (views[side].area().contains(point)) {
+            return side;
+        }
+    }
+    return -1;
+}
+
+void GameScene::togglePause() {
+    isPaused = !isPaused;
+    pauseButton.setLabel(isPaused ? "Continue" : "Pause");
+}
+
+void GameScene::bakeBoards() {
+    std::shared_ptr<const sf::Texture> boardTexture = stack.assets().texture("field.png");
+    sf::RenderTexture& canvas = boardLayer.canvas();
+    boardLayer.clear();
+    for (const BoardView& view : views) {
+        canvas.setView(view.clipView(canvas.getSize()));
+        drawBoardImage(canvas, *boardTexture, view);
+    }
+    canvas.setView(canvas.getDefaultView());
+    boardLayer.finish();
+    viewChanged = false;
+}
+
+void GameScene::bakeText() {
+    text.clear();
+    for (const BoardView& view : views) {
+        addCoordinateLabels(text, view);
+    }
+    pauseButton.addTo(text);
+    exitButton.addTo(text);
+}
+
+void GameScene::handleEvent(const sf::Event& event) {
+    // Zoom and pan, each board on its own
+    if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Right) {
+        dragFrom = sf::Vector2f(static_cast<float>(event.mouseButton.x), static_cast<float>(event.mouseButton.y));
+        dragging = boardAt(dragFrom);
+    }
+    if (event.type == sf::Event::MouseMoved && dragging >= 0) {
+        sf::Vector2f point(static_cast<float>(event.mouseMove.x), static_cast<float>(event.mouseMove.y));
+        if (views[dragging].pan(point - dragFrom)) {
+            viewChanged = true;
+        }
+        dragFrom = point;
+    }
+    if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Right) {
+        dragging = -1;
+    }
+    if (event.type == sf::Event::MouseWheelScrolled && event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel) {
+        sf::Vector2f point(static_cast<float>(event.mouseWheelScroll.x), static_cast<float>(event.mouseWheelScroll.y));
+        int side = boardAt(point);
+        if (side >= 0 && views[side].zoom(std::pow(wheelZoom, event.mouseWheelScroll.delta), point)) {
+            viewChanged = true;
+        }
+    }
+    if (viewChanged) {
+        boardChanged = true;
+    }
+
+    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
+        stack.pop();
+    }
+}
+
+void GameScene::draw(sf::RenderWindow& window) {
+    // Keep drawing at full rate while the battle thread works, so its
+    // shots show up as they come and the buttons stay live
+    if (session.update()) {
+        boardChanged = true;
+    }
+    stack.frames().setAnimating(session.busy());
+
+    if (viewChanged || pauseButton.changed || exitButton.changed) {
+        bakeText();
+    }
+    if (viewChanged) {
+        bakeBoards();
+    }
+    if (boardChanged) {
+        const BattleSnapshot& shown = session.snapshot();
+        for (int side = 0; side < 2; ++side) {
+            const CellRange visible = views[side].visibleCells();
+            cells[side].clear();
+            if (side == 0) {
+                cells[side].addShips(views[side].layout(), playerShips, visible);
+            }
+            cells[side].addMarks(views[side].layout(), shown.marks[side], visible);
+            cells[side].commit();
+        }
+        boardChanged = false;
+    }
+    window.draw(boardLayer);
+    const sf::View screen = window.getView();
+    for (int side = 0; side < 2; ++side) {
+        window.setView(views[side].clipView(window.getSize()));
+        window.draw(cells[side]);
+    }
+    window.setView(screen);
+
+    // Labels, Pause/Continue and Exit buttons
+    window.draw(text);
+}
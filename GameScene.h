@@ -0,0 +1,62 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "BattleSession.h"
+#include "BoardRenderer.h"
+#include "Button.h"
+#include "GameState.h"
+#include "Scene.h"
+
+// Battle screen geometry, shared with the replay viewer: board 0 is the
+// player's on the left, board 1 the opponent's on the right
+sf::Vector2u battleWindowSize();
+const BoardLayout& battleBoardLayout(int side);
+
+// The battle: player's board on the left, opponent's on the right. With the
+// computer, the player shoots at a hidden fleet and the computer answers
+// on the battle thread; this scene only queues clicks and draws snapshots.
+// Boards of any size fill the same areas; on large boards the mouse wheel
+// zooms the board under the cursor and dragging with the right button pans.
+class GameScene : public Scene {
+public:
+    GameScene(SceneStack& stack, std::vector<Ship> playerShips, bool withComputer = false);
+
+    sf::Vector2u size() const override;
+    std::string title() const override { return "Sea Battle - Game"; }
+
+    bool load() override;
+    void handleEvent(const sf::Event& event) override;
+    void draw(sf::RenderWindow& window) override;
+
+private:
+    std::shared_ptr<const sf::Font> font;
+    Button pauseButton;
+    Button exitButton;
+
+    std::vector<Ship> playerShips;
+    bool isPaused = false;
+    // Player's board, then the opponent's
+    BoardView views[2];
+    int dragging = -1;   // board being panned, -1 if none
+    sf::Vector2f dragFrom;
+
+    // Saves the game to lastGameReplay when it ends
+    BattleSession session;
+
+    // Board images: baked again only when a view moves
+    StaticLayer boardLayer;
+    bool viewChanged = true;
+    // Coordinate labels and button captions in one draw call, baked again
+    // when a view moves or a button changes
+    TextBatch text;
+    // Ships and shot marks in view, one batch per board so each can be
+    // clipped to its area; rebuilt only on a new snapshot or view move
+    CellBatch cells[2];
+    bool boardChanged = true;
+
+    // Index of the board under the point, -1 if none
+    int boardAt(sf::Vector2f point) const;
+    void togglePause();
+    void bakeBoards();
+    void bakeText();
+};
@@ -0,0 +1,180 @@
+#include "GameState.h"
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include "FixedBoard.h"
+#include "FleetGenerator.h"
+
+namespace {
+
+template <typename BoardType>
+BoardType& addFleet(BoardType& board, const std::vector<Ship>& ships) {
+    for (const auto& ship : ships) {
+        board.place(ship.startRow, ship.startCol, ship.length, ship.direction);
+    }
+    return board;
+}
+
+}
+
+Board makeBoard(const std::vector<Ship>& ships, int gridRows, int gridCols) {
+    Board board(gridRows, gridCols);
+    return addFleet(board, ships);
+}
+
+// The throwaway board is a FixedBoard for the common sizes: no allocation
+bool canPlaceShip(const std::vector<Ship>& ships, int row, int col, int length, ShipDirection direction, int gridRows, int gridCols) {
+    return visitBoard(gridRows, gridCols, [&](auto board) { return addFleet(board, ships).canPlace(row, col, length, direction); });
+}
+
+bool canPlaceShipWithGap(const std::vector<Ship>& ships, int row, int col, int length, ShipDirection direction, int gridRows, int gridCols) {
+    return visitBoard(gridRows, gridCols, [&](auto board) { return addFleet(board, ships).canPlaceWithGap(row, col, length, direction); });
+}
+
+void autoPlaceShipsInPlacement(std::vector<Ship>& ships, const Rules& rules, uint64_t seed) {
+    FleetGenerator generator(rules, seed);
+    std::vector<ShipPlacement> fleet;
+
+    ships.clear();
+    if (generator.generate(fleet) != FleetResult::OK) {
+        std::cerr << "Could not place the fleet on a " << rules.rows << "x" << rules.cols << " board!" << std::endl;
+        return;
+    }
+    for (const auto& ship : fleet) {
+        ships.push_back({ ship.length, ship.row, ship.col, ship.direction });
+    }
+}
+
+void autoPlaceShipsInPlacement(std::vector<Ship>& ships, const Rules& rules) {
+    // One entropy read per process, every layout after that comes from the seeded stream
+    static Rng seeds(std::random_device{}());
+    autoPlaceShipsInPlacement(ships, rules, seeds.next());
+}
+
+void autoPlaceShipsInPlacement(std::vector<Ship>& ships, int gridRows, int gridCols, uint64_t seed) {
+    autoPlaceShipsInPlacement(ships, Rules{ gridRows, gridCols, standardFleet(), false }, seed);
+}
+
+void autoPlaceShipsInPlacement(std::vector<Ship>& ships, int gridRows, int gridCols) {
+    autoPlaceShipsInPlacement(ships, Rules{ gridRows, gridCols, standardFleet(), false });
+}
+
+bool fleetFollowsRules(const std::vector<Ship>& ships, const Rules& rules) {
+    if (ships.size() != rules.shipLengths.size()) {
+        return false;
+    }
+    // Ships still expected, by length
+    std::vector<int> expected(rules.maxShipLength() + 1, 0);
+    for (int length : rules.shipLengths) {
+        ++expected[length];
+    }
+    Board board(rules.rows, rules.cols);
+    for (const Ship& ship : ships) {
+        if (ship.length <= 0 || ship.length >= static_cast<int>(expected.size()) || expected[ship.length] == 0) {
+            return false;
+        }
+        --expected[ship.length];
+        const bool free = rules.shipsMayTouch ? board.canPlace(ship.startRow, ship.startCol, ship.length, ship.direction)
+                                              : board.canPlaceWithGap(ship.startRow, ship.startCol, ship.length, ship.direction);
+        if (!free) {
+            return false;
+        }
+        board.place(ship.startRow, ship.startCol, ship.length, ship.direction);
+    }
+    return true;
+}
+
+FleetState::FleetState(int rows, int cols, bool shipsMayTouch)
+    : rowCount(rows), colCount(cols), touching(shipsMayTouch), marks(rows * cols, CellMark::NONE), shipIndex(rows * cols, -1), haloBegin(1, 0) {
+    // Every cell changes at most once per game, repeated shots aside
+    history.reserve(rows * cols);
+    autoWater.reserve(rows * cols);
+}
+
+void FleetState::setFleet(const std::vector<Ship>& ships) {
+    const int gridRows = rowCount;
+    const int gridCols = colCount;
+    fleet = ships;
+    std::fill(marks.begin(), marks.end(), CellMark::NONE);
+    std::fill(shipIndex.begin(), shipIndex.end(), -1);
+    hits.assign(ships.size(), 0);
+    haloCells.clear();
+    haloBegin.assign(1, 0);
+    history.clear();
+    autoWater.clear();
+    afloat = static_cast<int>(ships.size());
+
+    for (int i = 0; i < static_cast<int>(ships.size()); ++i) {
+        const Ship& ship = ships[i];
+        const int dRow = (ship.direction == ShipDirection::VERTICAL) ? 1 : 0;
+        const int dCol = (ship.direction == ShipDirection::HORIZONTAL) ? 1 : 0;
+        const int lastRow = ship.startRow + (ship.length - 1) * dRow;
+        const int lastCol = ship.startCol + (ship.length - 1) * dCol;
+        for (int r = std::max(ship.startRow - 1, 0); r <= std::min(lastRow + 1, gridRows - 1); ++r) {
+            for (int c = std::max(ship.startCol - 1, 0); c <= std::min(lastCol + 1, gridCols - 1); ++c) {
+                if (r >= ship.startRow && r <= lastRow && c >= ship.startCol && c <= lastCol) {
+                    shipIndex[r * gridCols + c] = i;
+                }
+                else if (!touching) {
+                    haloCells.push_back(r * gridCols + c);
+                }
+            }
+        }
+        haloBegin.push_back(static_cast<int>(haloCells.size()));
+    }
+}
+
+ShotResult FleetState::fire(int row, int col) {
+    const int cell = row * colCount + col;
+    CellMark& target = marks[cell];
+    if (target != CellMark::NONE) {
+        history.push_back({ -1, 0 });
+        return target == CellMark::HIT ? ShotResult::HIT : ShotResult::MISS;
+    }
+    const int ship = shipIndex[cell];
+    if (ship < 0) {
+        target = CellMark::MISS;
+        history.push_back({ cell, 0 });
+        return ShotResult::MISS;
+    }
+    target = CellMark::HIT;
+    if (++hits[ship] < fleet[ship].length) {
+        history.push_back({ cell, 0 });
+        return ShotResult::HIT;
+    }
+
+    int waterMarked = 0;
+    for (int i = haloBegin[ship]; i < haloBegin[ship + 1]; ++i) {
+        if (marks[haloCells[i]] == CellMark::NONE) {
+            marks[haloCells[i]] = CellMark::MISS;
+            autoWater.push_back(haloCells[i]);
+            ++waterMarked;
+        }
+    }
+    history.push_back({ cell, waterMarked });
+    --afloat;
+    return ShotResult::SUNK;
+}
+
+void FleetState::undo() {
+    if (history.empty()) {
+        return;
+    }
+    const Move move = history.back();
+    history.pop_back();
+    if (move.cell < 0) {
+        return;
+    }
+    for (int i = 0; i < move.waterMarked; ++i) {
+        marks[autoWater.back()] = CellMark::NONE;
+        autoWater.pop_back();
+    }
+    const int ship = shipIndex[move.cell];
+    if (ship >= 0) {
+        if (hits[ship] == fleet[ship].length) {
+            ++afloat;
+        }
+        --hits[ship];
+    }
+    marks[move.cell] = CellMark::NONE;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Board.h"
+#include "Rules.h"
+
+struct Ship {
+    int length;
+    int startRow;
+    int startCol;
+    ShipDirection direction;
+};
+
+enum class CellMark {
+    NONE,
+    MISS,
+    HIT
+};
+
+// Builds the occupancy bitboard for an existing fleet
+Board makeBoard(const std::vector<Ship>& ships, int gridRows, int gridCols);
+
+bool canPlaceShip(const std::vector<Ship>& ships, int row, int col, int length, ShipDirection direction, int gridRows, int gridCols);
+bool canPlaceShipWithGap(const std::vector<Ship>& ships, int row, int col, int length, ShipDirection direction, int gridRows, int gridCols);
+
+// Random fleet under the rules. Leaves `ships` empty if the fleet does not fit.
+void autoPlaceShipsInPlacement(std::vector<Ship>& ships, const Rules& rules, uint64_t seed);
+void autoPlaceShipsInPlacement(std::vector<Ship>& ships, const Rules& rules);
+// Standard fleet, classic rules
+void autoPlaceShipsInPlacement(std::vector<Ship>& ships, int gridRows, int gridCols, uint64_t seed);
+void autoPlaceShipsInPlacement(std::vector<Ship>& ships, int gridRows, int gridCols);
+
+// The fleet has exactly the rules' ship lengths, in any order, and every
+// ship lies on the board clear of the others (and of their halo unless
+// ships may touch). One pass over a Board: linear in fleet and board size,
+// where canPlaceShip() per ship would be quadratic in the fleet.
+bool fleetFollowsRules(const std::vector<Ship>& ships, const Rules& rules);
+
+// One player's fleet and every shot taken at it. Every cell knows the ship
+// on it and every ship counts its hits, so a shot is resolved without
+// looking at the other ships, and every shot can be taken back. Storage is
+// sized on the first setFleet() of a fleet that big and reused afterwards,
+// so replaying games on one FleetState does not allocate.
+class FleetState {
+public:
+    // Where ships may touch, sinking one tells nothing about its neighbours
+    FleetState(int rows = 10, int cols = 10, bool shipsMayTouch = false);
+
+    void setFleet(const std::vector<Ship>& fleet);
+
+    // Resolves a shot and records it. Once a ship is sunk, the water around
+    // it is marked as well (unless ships may touch). Shooting a marked cell again changes nothing.
+    ShotResult fire(int row, int col);
+    // Takes back the last fire(), including the water its sinking marked,
+    // so a search can make and unmake moves without copying the state
+    void undo();
+    int shotsFired() const { return static_cast<int>(history.size()); }
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+    CellMark mark(int row, int col) const { return marks[row * colCount + col]; }
+    const std::vector<Ship>& ships() const { return fleet; }
+    // Index into ships() of the ship on the cell, -1 for water
+    int shipAt(int row, int col) const { return shipIndex[row * colCount + col]; }
+    bool isSunk(int ship) const { return hits[ship] == fleet[ship].length; }
+    int shipsLeft() const { return afloat; }
+    bool defeated() const { return afloat == 0; }
+
+private:
+    struct Move {
+        int cell;          // -1: the shot changed nothing
+        int waterMarked;   // halo cells the shot turned to MISS, top of `autoWater`
+    };
+
+    int rowCount;
+    int colCount;
+    bool touching;
+    std::vector<Ship> fleet;
+    std::vector<CellMark> marks;
+    std::vector<int> shipIndex;    // cell -> ship, -1 for water
+    std::vector<int> hits;         // ship -> cells hit
+    std::vector<int> haloCells;    // halo of ship i is [haloBegin[i], haloBegin[i + 1])
+    std::vector<int> haloBegin;
+    std::vector<Move> history;
+    std::vector<int> autoWater;
+    int afloat = 0;
+};
@@ -0,0 +1,186 @@
+#include "InputLayer.h"
+#include <algorithm>
+#include <cmath>
+#include "Profiler.h"
+
+namespace {
+
+// Screens are a few hundred pixels across; this bounds the grid for
+// targets spread unusually far
+const int maxGridSize = 256;
+
+}
+
+HitGrid::HitGrid(float cellSize) : cellSize(cellSize), inverseCellSize(1.0f / cellSize) {
+}
+
+void HitGrid::clear() {
+    bounds.clear();
+    dirty = true;
+}
+
+int HitGrid::add(const sf::FloatRect& area) {
+    bounds.push_back(area);
+    dirty = true;
+    return static_cast<int>(bounds.size()) - 1;
+}
+
+int HitGrid::at(sf::Vector2f point) {
+    if (dirty) {
+        rebuild();
+    }
+    const int col = static_cast<int>(std::floor((point.x - origin.x) * inverseCellSize));
+    const int row = static_cast<int>(std::floor((point.y - origin.y) * inverseCellSize));
+    if (col < 0 || row < 0 || col >= gridCols || row >= gridRows) {
+        return -1;
+    }
+    const int cell = row * gridCols + col;
+    // Ids ascend within a cell: the last match is the topmost
+    for (uint32_t i = cellStart[cell + 1]; i > cellStart[cell]; --i) {
+        const int id = cellItems[i - 1];
+        if (bounds[id].contains(point)) {
+            return id;
+        }
+    }
+    return -1;
+}
+
+void HitGrid::rebuild() {
+    dirty = false;
+    gridCols = 0;
+    gridRows = 0;
+    if (bounds.empty()) {
+        return;
+    }
+    float left = bounds[0].left;
+    float top = bounds[0].top;
+    float right = left;
+    float bottom = top;
+    for (const auto& area : bounds) {
+        left = std::min(left, area.left);
+        top = std::min(top, area.top);
+        right = std::max(right, area.left + area.width);
+        bottom = std::max(bottom, area.top + area.height);
+    }
+    // Coarser cells rather than an outsized grid
+    cellSize = std::max(cellSize, std::max(right - left, bottom - top) / maxGridSize);
+    inverseCellSize = 1.0f / cellSize;
+    origin = sf::Vector2f(left, top);
+    gridCols = std::max(1, static_cast<int>(std::ceil((right - left) * inverseCellSize)));
+    gridRows = std::max(1, static_cast<int>(std::ceil((bottom - top) * inverseCellSize)));
+
+    // Cells a target overlaps, clamped to the grid
+    auto span = [&](const sf::FloatRect& area, int& firstCol, int& lastCol, int& firstRow, int& lastRow) {
+        firstCol = std::max(0, static_cast<int>((area.left - origin.x) * inverseCellSize));
+        lastCol = std::min(gridCols - 1, static_cast<int>((area.left + area.width - origin.x) * inverseCellSize));
+        firstRow = std::max(0, static_cast<int>((area.top - origin.y) * inverseCellSize));
+        lastRow = std::min(gridRows - 1, static_cast<int>((area.top + area.height - origin.y) * inverseCellSize));
+    };
+    int firstCol, lastCol, firstRow, lastRow;
+    cellStart.assign(gridCols * gridRows + 1, 0);
+    for (const auto& area : bounds) {
+        span(area, firstCol, lastCol, firstRow, lastRow);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int col = firstCol; col <= lastCol; ++col) {
+                ++cellStart[row * gridCols + col + 1];
+            }
+        }
+    }
+    for (size_t cell = 1; cell < cellStart.size(); ++cell) {
+        cellStart[cell] += cellStart[cell - 1];
+    }
+    cellItems.assign(cellStart.back(), 0);
+    std::vector<uint32_t> next(cellStart.begin(), cellStart.end() - 1);
+    for (size_t id = 0; id < bounds.size(); ++id) {
+        span(bounds[id], firstCol, lastCol, firstRow, lastRow);
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int col = firstCol; col <= lastCol; ++col) {
+                cellItems[next[row * gridCols + col]++] = static_cast<int>(id);
+            }
+        }
+    }
+}
+
+int InputLayer::addButton(Button& button, std::function<void()> onClick) {
+    targets.push_back({ &button, nullptr, std::move(onClick), nullptr });
+    return grid.add(boundsOf(targets.back()));
+}
+
+int InputLayer::addBoard(const BoardView& view, std::function<void(int, int)> onCell) {
+    targets.push_back({ nullptr, &view, nullptr, std::move(onCell) });
+    return grid.add(boundsOf(targets.back()));
+}
+
+void InputLayer::handleEvent(const sf::Event& event) {
+    switch (event.type) {
+    case sf::Event::MouseMoved:
+        pointer = sf::Vector2f(static_cast<float>(event.mouseMove.x), static_cast<float>(event.mouseMove.y));
+        pointerInside = true;
+        pointerMoved = true;
+        break;
+    case sf::Event::MouseLeft:
+        pointerInside = false;
+        pointerMoved = true;
+        break;
+    case sf::Event::MouseButtonPressed: {
+        pointer = sf::Vector2f(static_cast<float>(event.mouseButton.x), static_cast<float>(event.mouseButton.y));
+        pointerInside = true;
+        pointerMoved = true;
+        if (event.mouseButton.button != sf::Mouse::Left) {
+            break;
+        }
+        const int id = grid.at(pointer);
+        if (id < 0) {
+            break;
+        }
+        Target& target = targets[id];
+        int row = 0;
+        int col = 0;
+        if (target.button) {
+            target.button->setPressed(true);
+            pressed = id;
+        }
+        else if (target.board->cellAt(pointer, row, col)) {
+            target.onCell(row, col);
+        }
+        break;
+    }
+    case sf::Event::MouseButtonReleased:
+        // A pressed button fires wherever the button is let go
+        if (event.mouseButton.button == sf::Mouse::Left && pressed >= 0) {
+            const int id = pressed;
+            pressed = -1;
+            targets[id].button->setPressed(false);
+            targets[id].onClick();
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void InputLayer::update() {
+    if (!pointerMoved) {
+        return;
+    }
+    ProfileScope scope("InputLayer::update");
+    pointerMoved = false;
+    setHovered(pointerInside ? grid.at(pointer) : -1);
+}
+
+sf::FloatRect InputLayer::boundsOf(const Target& target) const {
+    return target.button ? target.button->bounds : target.board->area();
+}
+
+void InputLayer::setHovered(int id) {
+    if (id == hovered) {
+        return;
+    }
+    if (hovered >= 0 && targets[hovered].button) {
+        targets[hovered].button->setHovered(false);
+    }
+    hovered = id;
+    if (hovered >= 0 && targets[hovered].button) {
+        targets[hovered].button->setHovered(true);
+    }
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "BoardRenderer.h"
+#include "Button.h"
+
+// Uniform grid over the screen for hit testing. Each grid cell lists the
+// targets whose bounds overlap it, so a lookup tests only the few targets
+// near the point whatever the number on screen. The grid is built on the
+// first lookup after targets were added.
+class HitGrid {
+public:
+    explicit HitGrid(float cellSize = 32.0f);
+
+    void clear();
+    // Targets added later lie on top; returns the id at() reports
+    int add(const sf::FloatRect& bounds);
+
+    // Topmost target containing the point, -1 if none
+    int at(sf::Vector2f point);
+
+private:
+    float cellSize;
+    float inverseCellSize;
+    std::vector<sf::FloatRect> bounds;
+    bool dirty = true;
+
+    // Grid over the bounding box of every target
+    sf::Vector2f origin;
+    int gridCols = 0;
+    int gridRows = 0;
+    // Target ids per grid cell, cell i in cellItems[cellStart[i] .. cellStart[i + 1])
+    std::vector<uint32_t> cellStart;
+    std::vector<int> cellItems;
+
+    void rebuild();
+};
+
+// Pointer input of one scene. Events are fed in as they arrive and only
+// update the pointer position; hover is resolved through a HitGrid once per
+// frame in update(), and a button is re-coloured only when it gains or loses
+// the hover. Left clicks go to the handler of the target under the pointer:
+//
+//     input.addButton(exitButton, [this]() { stack.pop(); });
+//     input.addBoard(view, [this](int row, int col) { shoot(row, col); });
+//
+// A button pressed with the left button fires on release; a board fires on
+// the press, with the cell under the pointer.
+class InputLayer {
+public:
+    int addButton(Button& button, std::function<void()> onClick);
+    int addBoard(const BoardView& view, std::function<void(int, int)> onCell);
+
+    void handleEvent(const sf::Event& event);
+    // Once per frame, before drawing
+    void update();
+
+private:
+    struct Target {
+        Button* button;
+        const BoardView* board;
+        std::function<void()> onClick;
+        std::function<void(int, int)> onCell;
+    };
+
+    HitGrid grid;
+    std::vector<Target> targets;
+    sf::Vector2f pointer;
+    bool pointerInside = false;
+    bool pointerMoved = false;
+    int hovered = -1;
+    int pressed = -1;
+
+    sf::FloatRect boundsOf(const Target& target) const;
+    void setHovered(int id);
+};
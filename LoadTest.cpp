@@ -0,0 +1,279 @@
+#include "LoadTest.h"
+#include <SFML/Network.hpp>
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include "FleetGenerator.h"
+#include "Random.h"
+#include "TargetingEngine.h"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+// Give up when the server stays silent this long
+const double idleTimeoutSeconds = 10.0;
+
+// TargetingEngine also knows the water the server marks around sunk ships,
+// so it never fires at an already marked cell
+struct GameSlot {
+    std::unique_ptr<TargetingEngine> shooter;
+    Clock::time_point shotSent;
+    int shipsSunk = 0;
+};
+
+struct Connection {
+    sf::TcpSocket socket;
+    MessageReader reader;
+    std::vector<uint8_t> outbox;
+    size_t sent = 0;
+    std::vector<GameSlot> games;
+};
+
+class LoadClient {
+public:
+    LoadClient(const LoadTestOptions& options, LoadTestReport& report, std::string& error)
+        : options(options), report(report), error(error),
+          generator(protocolRows, protocolCols, standardFleet(), options.seed), seedState(~options.seed) {
+        // Against players every match takes two of our fleets
+        fleetsToSend = options.matches * (options.opponent == Opponent::PLAYER ? 2 : 1);
+    }
+
+    bool run();
+
+private:
+    const LoadTestOptions& options;
+    LoadTestReport& report;
+    std::string& error;
+
+    FleetGenerator generator;
+    uint64_t seedState;
+    uint64_t fleetsToSend = 0;
+    uint64_t fleetsSent = 0;
+    std::vector<uint32_t> latencies;   // microseconds
+
+    std::vector<std::unique_ptr<Connection>> connections;
+    sf::SocketSelector selector;
+
+    bool connect();
+    void startGame(Connection& connection, uint16_t game);
+    void shoot(Connection& connection, uint16_t game);
+    bool handle(Connection& connection, const Message& message);
+    bool receive(Connection& connection);
+    bool flush(Connection& connection);
+    void summarize(double seconds);
+};
+
+bool LoadClient::connect() {
+    const sf::IpAddress address(options.host);
+    for (unsigned i = 0; i < options.connections; ++i) {
+        std::unique_ptr<Connection> connection(new Connection());
+        if (connection->socket.connect(address, options.port, sf::seconds(5)) != sf::Socket::Done) {
+            error = "cannot connect to " + options.host + ":" + std::to_string(options.port);
+            return false;
+        }
+        connection->socket.setBlocking(false);
+        selector.add(connection->socket);
+        connection->games.resize(options.gamesPerConnection);
+        for (auto& game : connection->games) {
+            game.shooter.reset(new TargetingEngine(protocolRows, protocolCols, standardFleet()));
+        }
+        connections.push_back(std::move(connection));
+    }
+    return true;
+}
+
+void LoadClient::startGame(Connection& connection, uint16_t game) {
+    if (fleetsSent >= fleetsToSend) {
+        return;
+    }
+    std::vector<ShipPlacement> placements;
+    if (generator.generate(placements) != FleetResult::OK) {
+        return;
+    }
+    std::vector<Ship> fleet;
+    for (const auto& placement : placements) {
+        fleet.push_back({ placement.length, placement.row, placement.col, placement.direction });
+    }
+    GameSlot& slot = connection.games[game];
+    slot.shooter->reset();
+    slot.shooter->reseed(Rng::splitMix64(seedState));
+    slot.shipsSunk = 0;
+    appendMessage(fleetMessage(game, options.opponent, fleet), connection.outbox);
+    ++fleetsSent;
+}
+
+void LoadClient::shoot(Connection& connection, uint16_t game) {
+    GameSlot& slot = connection.games[game];
+    int row = 0;
+    int col = 0;
+    // The last sinking shot is followed by GAME_OVER, not by our turn
+    if (slot.shipsSunk == protocolFleetSize || !slot.shooter->chooseTarget(row, col)) {
+        return;
+    }
+    appendMessage(shotMessage(game, row, col), connection.outbox);
+    slot.shotSent = Clock::now();
+}
+
+bool LoadClient::handle(Connection& connection, const Message& message) {
+    if (message.game >= connection.games.size()) {
+        error = "message for unknown game " + std::to_string(message.game);
+        return false;
+    }
+    GameSlot& slot = connection.games[message.game];
+    switch (message.type) {
+    case MessageType::MATCHED:
+        if (message.flags) {
+            shoot(connection, message.game);
+        }
+        return true;
+    case MessageType::SHOT_RESULT:
+        if (message.flags == 0) {
+            latencies.push_back(static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - slot.shotSent).count()));
+            ++report.moves;
+            slot.shooter->recordShot(message.row, message.col, message.result);
+            if (message.result == ShotResult::SUNK) {
+                ++slot.shipsSunk;
+            }
+            if (message.result != ShotResult::MISS) {
+                shoot(connection, message.game);
+            }
+        }
+        else if (message.result == ShotResult::MISS) {
+            shoot(connection, message.game);
+        }
+        return true;
+    case MessageType::GAME_OVER:
+        // A match between two of our games ends with one GAME_OVER each
+        if (options.opponent == Opponent::COMPUTER || message.flags) {
+            ++report.matches;
+        }
+        startGame(connection, message.game);
+        return true;
+    case MessageType::ERROR:
+        error = "server error " + std::to_string(message.flags) + " in game " + std::to_string(message.game);
+        return false;
+    default:
+        error = "unexpected message type " + std::to_string(static_cast<int>(message.type));
+        return false;
+    }
+}
+
+bool LoadClient::receive(Connection& connection) {
+    uint8_t buffer[4096];
+    for (;;) {
+        size_t received = 0;
+        const sf::Socket::Status status = connection.socket.receive(buffer, sizeof(buffer), received);
+        if (status == sf::Socket::NotReady) {
+            break;
+        }
+        if (status != sf::Socket::Done && status != sf::Socket::Partial) {
+            error = "server closed the connection";
+            return false;
+        }
+        connection.reader.feed(buffer, received);
+        if (received < sizeof(buffer)) {
+            break;
+        }
+    }
+    Message message;
+    while (connection.reader.next(message)) {
+        if (!handle(connection, message)) {
+            return false;
+        }
+    }
+    if (connection.reader.failed()) {
+        error = "corrupt message stream from the server";
+        return false;
+    }
+    return true;
+}
+
+bool LoadClient::flush(Connection& connection) {
+    if (connection.outbox.empty()) {
+        return true;
+    }
+    size_t sent = 0;
+    const sf::Socket::Status status = connection.socket.send(connection.outbox.data() + connection.sent, connection.outbox.size() - connection.sent, sent);
+    if (status == sf::Socket::Disconnected || status == sf::Socket::Error) {
+        error = "server closed the connection";
+        return false;
+    }
+    connection.sent += sent;
+    if (connection.sent == connection.outbox.size()) {
+        connection.outbox.clear();
+        connection.sent = 0;
+    }
+    return true;
+}
+
+bool LoadClient::run() {
+    if (options.connections == 0 || options.gamesPerConnection == 0 || options.gamesPerConnection > 65536) {
+        error = "need at least one connection and 1..65536 games per connection";
+        return false;
+    }
+    if (!connect()) {
+        return false;
+    }
+
+    const Clock::time_point start = Clock::now();
+    for (auto& connection : connections) {
+        for (size_t game = 0; game < connection->games.size(); ++game) {
+            startGame(*connection, static_cast<uint16_t>(game));
+        }
+    }
+
+    Clock::time_point lastInput = Clock::now();
+    bool outputPending = true;
+    while (report.matches < options.matches) {
+        if (selector.wait(outputPending ? sf::milliseconds(1) : sf::milliseconds(100))) {
+            for (auto& connection : connections) {
+                if (selector.isReady(connection->socket)) {
+                    if (!receive(*connection)) {
+                        return false;
+                    }
+                    lastInput = Clock::now();
+                }
+            }
+        }
+        else if (std::chrono::duration<double>(Clock::now() - lastInput).count() > idleTimeoutSeconds) {
+            error = "the server stopped answering";
+            return false;
+        }
+
+        outputPending = false;
+        for (auto& connection : connections) {
+            if (!flush(*connection)) {
+                return false;
+            }
+            outputPending = outputPending || !connection->outbox.empty();
+        }
+    }
+    summarize(std::chrono::duration<double>(Clock::now() - start).count());
+    return true;
+}
+
+void LoadClient::summarize(double seconds) {
+    report.seconds = seconds;
+    report.matchesPerSecond = seconds > 0 ? report.matches / seconds : 0;
+    if (latencies.empty()) {
+        return;
+    }
+    std::sort(latencies.begin(), latencies.end());
+    auto percentile = [this](double fraction) {
+        return static_cast<double>(latencies[static_cast<size_t>(fraction * (latencies.size() - 1))]);
+    };
+    report.p50LatencyUs = percentile(0.50);
+    report.p90LatencyUs = percentile(0.90);
+    report.p99LatencyUs = percentile(0.99);
+    report.maxLatencyUs = latencies.back();
+}
+
+}
+
+bool runLoadTest(const LoadTestOptions& options, LoadTestReport& report, std::string& error) {
+    report = LoadTestReport();
+    LoadClient client(options, report, error);
+    return client.run();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include "NetServer.h"
+#include "Protocol.h"
+
+struct LoadTestOptions {
+    std::string host = "127.0.0.1";
+    unsigned short port = defaultServerPort;
+    unsigned connections = 4;
+    unsigned gamesPerConnection = 256;   // games kept running at once on each connection
+    uint64_t matches = 10000;
+    Opponent opponent = Opponent::COMPUTER;
+    uint64_t seed = 0;
+};
+
+struct LoadTestReport {
+    uint64_t matches = 0;
+    uint64_t moves = 0;           // shots fired by the load client
+    double seconds = 0;
+    double matchesPerSecond = 0;
+    // Time from sending a SHOT to receiving its SHOT_RESULT
+    double p50LatencyUs = 0;
+    double p90LatencyUs = 0;
+    double p99LatencyUs = 0;
+    double maxLatencyUs = 0;
+};
+
+// Plays `matches` games against a running server over `connections` TCP
+// connections, every connection keeping `gamesPerConnection` games going.
+// Against Opponent::PLAYER the client's own games are paired by the server.
+bool runLoadTest(const LoadTestOptions& options, LoadTestReport& report, std::string& error);
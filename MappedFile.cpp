@@ -0,0 +1,103 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        file = nullptr;
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        close();
+        return false;
+    }
+    length = static_cast<size_t>(fileSize.QuadPart);
+    // An empty file cannot be mapped; it is simply empty
+    if (length == 0) {
+        return true;
+    }
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping == nullptr) {
+        close();
+        return false;
+    }
+    bytes = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (bytes == nullptr) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes != nullptr) {
+        UnmapViewOfFile(bytes);
+    }
+    if (mapping != nullptr) {
+        CloseHandle(mapping);
+    }
+    if (file != nullptr) {
+        CloseHandle(file);
+    }
+    bytes = nullptr;
+    mapping = nullptr;
+    file = nullptr;
+    length = 0;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path) {
+    close();
+    descriptor = ::open(path.c_str(), O_RDONLY);
+    if (descriptor < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(descriptor, &info) != 0) {
+        close();
+        return false;
+    }
+    length = static_cast<size_t>(info.st_size);
+    // An empty file cannot be mapped; it is simply empty
+    if (length == 0) {
+        return true;
+    }
+    void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    if (address == MAP_FAILED) {
+        close();
+        return false;
+    }
+    // Logs are read front to back
+    madvise(address, length, MADV_SEQUENTIAL);
+    bytes = static_cast<const uint8_t*>(address);
+    return true;
+}
+
+void MappedFile::close() {
+    if (bytes != nullptr) {
+        munmap(const_cast<uint8_t*>(bytes), length);
+    }
+    if (descriptor >= 0) {
+        ::close(descriptor);
+    }
+    bytes = nullptr;
+    descriptor = -1;
+    length = 0;
+}
+
+#endif
@@ -0,0 +1,225 @@
+#include "MatchHost.h"
+
+MatchHost::MatchHost(SendFunction send, uint64_t seed)
+    : send(std::move(send)), rng(seed), generator(protocolRows, protocolCols, standardFleet(), Rng::splitMix64(seed)), seats(&seatNodes) {
+}
+
+void MatchHost::receive(ClientId client, const Message& message) {
+    switch (message.type) {
+    case MessageType::FLEET:
+        joinGame(client, message);
+        break;
+    case MessageType::SHOT:
+        takeShot(client, message);
+        break;
+    default:
+        // Server-to-client types are ignored
+        break;
+    }
+}
+
+void MatchHost::disconnect(ClientId client) {
+    if (hasWaiting && waiting.client == client) {
+        seats.erase(seatKey(waiting.client, waiting.game));
+        hasWaiting = false;
+    }
+    for (int i = 0; i < static_cast<int>(matches.size()); ++i) {
+        Match& match = matches[i];
+        if (!match.active) {
+            continue;
+        }
+        for (int side = 0; side < 2; ++side) {
+            const Seat& seat = match.seats[side];
+            if (!seat.computer && seat.client == client) {
+                // The leaving side loses; nothing is sent back to it
+                seats.erase(seatKey(seat.client, seat.game));
+                match.seats[side].computer = true;
+                finishMatch(i, 1 - side);
+                break;
+            }
+        }
+    }
+}
+
+void MatchHost::joinGame(ClientId client, const Message& message) {
+    const uint64_t key = seatKey(client, message.game);
+    if (seats.count(key) != 0) {
+        sendError(client, message.game, ProtocolError::GAME_EXISTS);
+        return;
+    }
+    joinFleet.assign(message.fleet.begin(), message.fleet.end());
+    const std::vector<Ship>& fleet = joinFleet;
+    if (!isValidFleet(fleet)) {
+        sendError(client, message.game, ProtocolError::BAD_FLEET);
+        return;
+    }
+
+    Seat seat;
+    seat.client = client;
+    seat.game = message.game;
+    if (static_cast<Opponent>(message.flags) == Opponent::PLAYER) {
+        if (!hasWaiting) {
+            hasWaiting = true;
+            waiting = seat;
+            waitingFleet = fleet;
+            seats[key] = { -1, 0 };
+            return;
+        }
+        hasWaiting = false;
+        startMatch(waiting, waitingFleet, seat, fleet);
+        return;
+    }
+
+    if (generator.generate(computerPlacements) != FleetResult::OK) {
+        sendError(client, message.game, ProtocolError::BAD_FLEET);
+        return;
+    }
+    computerFleet.clear();
+    for (const auto& placement : computerPlacements) {
+        computerFleet.push_back({ placement.length, placement.row, placement.col, placement.direction });
+    }
+    Seat computer;
+    computer.computer = true;
+    const int matchIndex = startMatch(seat, fleet, computer, computerFleet);
+    if (matches[matchIndex].turn == 1) {
+        playComputer(matchIndex);
+    }
+}
+
+int MatchHost::startMatch(const Seat& first, const std::vector<Ship>& firstFleet, const Seat& second, const std::vector<Ship>& secondFleet) {
+    int matchIndex;
+    if (!freeMatches.empty()) {
+        matchIndex = freeMatches.back();
+        freeMatches.pop_back();
+    }
+    else {
+        matchIndex = static_cast<int>(matches.size());
+        matches.emplace_back();
+    }
+    Match& match = matches[matchIndex];
+    match.seats[0] = first;
+    match.seats[1] = second;
+    match.fleets[0].setFleet(firstFleet);
+    match.fleets[1].setFleet(secondFleet);
+    match.turn = static_cast<int>(rng.below(2));
+    match.active = true;
+
+    if (second.computer) {
+        // Engines are expensive to build; finished games hand theirs back
+        if (!idleEngines.empty()) {
+            match.computer = std::move(idleEngines.back());
+            idleEngines.pop_back();
+            match.computer->reset();
+        }
+        else {
+            match.computer.reset(new TargetingEngine(protocolRows, protocolCols, standardFleet()));
+        }
+        match.computer->reseed(rng.next());
+    }
+
+    for (int side = 0; side < 2; ++side) {
+        if (!match.seats[side].computer) {
+            seats[seatKey(match.seats[side].client, match.seats[side].game)] = { matchIndex, side };
+            sendTo(match.seats[side], MessageType::MATCHED, match.turn == side ? 1 : 0);
+        }
+    }
+    return matchIndex;
+}
+
+void MatchHost::takeShot(ClientId client, const Message& message) {
+    auto it = seats.find(seatKey(client, message.game));
+    if (it == seats.end() || it->second.match < 0) {
+        sendError(client, message.game, ProtocolError::UNKNOWN_GAME);
+        return;
+    }
+    const int matchIndex = it->second.match;
+    const int side = it->second.side;
+    Match& match = matches[matchIndex];
+    if (match.turn != side) {
+        sendError(client, message.game, ProtocolError::NOT_YOUR_TURN);
+        return;
+    }
+    const FleetState& target = match.fleets[1 - side];
+    if (message.row >= target.rows() || message.col >= target.cols() || target.mark(message.row, message.col) != CellMark::NONE) {
+        sendError(client, message.game, ProtocolError::BAD_SHOT);
+        return;
+    }
+    fire(matchIndex, side, message.row, message.col);
+    if (match.active && match.turn == 1 && match.seats[1].computer) {
+        playComputer(matchIndex);
+    }
+}
+
+ShotResult MatchHost::fire(int matchIndex, int side, int row, int col) {
+    Match& match = matches[matchIndex];
+    FleetState& target = match.fleets[1 - side];
+    const ShotResult result = target.fire(row, col);
+    ++moves;
+
+    Message report;
+    report.type = MessageType::SHOT_RESULT;
+    report.row = static_cast<uint8_t>(row);
+    report.col = static_cast<uint8_t>(col);
+    report.result = result;
+    for (int receiver = 0; receiver < 2; ++receiver) {
+        const Seat& seat = match.seats[receiver];
+        if (!seat.computer) {
+            report.game = seat.game;
+            report.flags = receiver == side ? 0 : 1;
+            send(seat.client, report);
+        }
+    }
+
+    if (target.defeated()) {
+        finishMatch(matchIndex, side);
+    }
+    else if (result == ShotResult::MISS) {
+        match.turn = 1 - side;
+    }
+    return result;
+}
+
+void MatchHost::playComputer(int matchIndex) {
+    int row = 0;
+    int col = 0;
+    while (matches[matchIndex].active && matches[matchIndex].turn == 1) {
+        TargetingEngine& computer = *matches[matchIndex].computer;
+        if (!computer.chooseTarget(row, col)) {
+            break;
+        }
+        computer.recordShot(row, col, fire(matchIndex, 1, row, col));
+    }
+}
+
+void MatchHost::finishMatch(int matchIndex, int winner) {
+    Match& match = matches[matchIndex];
+    for (int side = 0; side < 2; ++side) {
+        const Seat& seat = match.seats[side];
+        if (!seat.computer) {
+            seats.erase(seatKey(seat.client, seat.game));
+            sendTo(seat, MessageType::GAME_OVER, side == winner ? 1 : 0);
+        }
+    }
+    if (match.computer) {
+        idleEngines.push_back(std::move(match.computer));
+    }
+    match.active = false;
+    freeMatches.push_back(matchIndex);
+    ++finished;
+}
+
+void MatchHost::sendTo(const Seat& seat, MessageType type, uint8_t flags) {
+    Message message;
+    message.type = type;
+    message.game = seat.game;
+    message.flags = flags;
+    send(seat.client, message);
+}
+
+void MatchHost::sendError(ClientId client, uint16_t game, ProtocolError error) {
+    Message message;
+    message.type = MessageType::ERROR;
+    message.game = game;
+    message.flags = static_cast<uint8_t>(error);
+    send(client, message);
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <unordered_map>
+#include <vector>
+#include "FleetGenerator.h"
+#include "GameState.h"
+#include "Protocol.h"
+#include "Random.h"
+#include "TargetingEngine.h"
+
+typedef uint32_t ClientId;
+
+// Authoritative rules of every game the server hosts, without any sockets:
+// the transport feeds it decoded messages and delivers what it sends. A
+// client's game is keyed by (client, game id); against the computer the
+// host plays the other side itself. As in the GUI, a hit keeps the turn.
+// Match slots, engines and seat entries are recycled, so once the host has
+// seen its peak load, new matches and moves allocate nothing.
+class MatchHost {
+public:
+    typedef std::function<void(ClientId client, const Message& message)> SendFunction;
+
+    explicit MatchHost(SendFunction send, uint64_t seed = 0);
+
+    void receive(ClientId client, const Message& message);
+    // Ends the client's games; a human opponent wins them
+    void disconnect(ClientId client);
+
+    size_t activeMatches() const { return matches.size() - freeMatches.size(); }
+    uint64_t finishedMatches() const { return finished; }
+    uint64_t movesPlayed() const { return moves; }
+
+private:
+    struct Seat {
+        ClientId client = 0;
+        uint16_t game = 0;
+        bool computer = false;
+    };
+    struct Match {
+        Seat seats[2];
+        FleetState fleets[2];   // fleets[i] belongs to seats[i]
+        int turn = 0;
+        bool active = false;
+        std::unique_ptr<TargetingEngine> computer;   // plays seats[1] against the computer
+    };
+    struct SeatRef {
+        int match;   // -1 - still waiting for an opponent
+        int side;
+    };
+
+    SendFunction send;
+    Rng rng;
+    FleetGenerator generator;
+
+    std::vector<Match> matches;
+    std::vector<int> freeMatches;
+    std::vector<std::unique_ptr<TargetingEngine>> idleEngines;
+    // Seat entries come and go with every match: their nodes are recycled
+    // through this pool rather than the global heap
+    std::pmr::unsynchronized_pool_resource seatNodes;
+    std::pmr::unordered_map<uint64_t, SeatRef> seats;   // seatKey() -> where it plays
+
+    bool hasWaiting = false;
+    Seat waiting;
+    std::vector<Ship> waitingFleet;
+
+    // joinGame() scratch, kept so a warmed-up host does not allocate
+    std::vector<Ship> joinFleet;
+    std::vector<ShipPlacement> computerPlacements;
+    std::vector<Ship> computerFleet;
+
+    uint64_t finished = 0;
+    uint64_t moves = 0;
+
+    static uint64_t seatKey(ClientId client, uint16_t game) { return (static_cast<uint64_t>(client) << 16) | game; }
+
+    void joinGame(ClientId client, const Message& message);
+    void takeShot(ClientId client, const Message& message);
+    int startMatch(const Seat& first, const std::vector<Ship>& firstFleet, const Seat& second, const std::vector<Ship>& secondFleet);
+    // Resolves and reports the shot; ends the match when the fleet is gone
+    ShotResult fire(int matchIndex, int side, int row, int col);
+    void playComputer(int matchIndex);
+    void finishMatch(int matchIndex, int winner);
+    void sendTo(const Seat& seat, MessageType type, uint8_t flags);
+    void sendError(ClientId client, uint16_t game, ProtocolError error);
+};
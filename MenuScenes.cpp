@@ -0,0 +1,123 @@
+#include "MenuScenes.h"
+#include <vector>
+#include "GameScene.h"
+#include "PlacementScene.h"
+#include "ReplayScene.h"
+
+namespace {
+
+const int menuWindowWidth = 400;
+const int menuWindowHeight = 300;
+
+const int modeMenuWidth = 400;
+const int modeMenuHeight = 400;
+
+const sf::Vector2f progressBarSize(240, 12);
+
+}
+
+LoadingScene::LoadingScene(SceneStack& stack, std::function<void(SceneStack&)> start)
+    : Scene(stack), start(std::move(start)), frame(progressBarSize) {
+    const sf::Vector2f origin((menuWindowWidth - progressBarSize.x) / 2, (menuWindowHeight - progressBarSize.y) / 2);
+    frame.setPosition(origin);
+    frame.setFillColor(sf::Color::Transparent);
+    frame.setOutlineColor(sf::Color::White);
+    frame.setOutlineThickness(1);
+    bar.setPosition(origin);
+    bar.setFillColor(sf::Color::White);
+}
+
+// Same size as the main menu, so the window does not jump when it takes over
+sf::Vector2u LoadingScene::size() const {
+    return sf::Vector2u(menuWindowWidth, menuWindowHeight);
+}
+
+void LoadingScene::handleEvent(const sf::Event& event) {
+    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
+        stack.pop();
+    }
+}
+
+void LoadingScene::draw(sf::RenderWindow& window) {
+    const AssetState state = done ? AssetState::READY : stack.assets().poll();
+    // Redraws keep coming while the loader works; no input is needed
+    stack.frames().setAnimating(state == AssetState::LOADING);
+    if (state != AssetState::LOADING && !done) {
+        done = true;
+        stack.pop();
+        if (state == AssetState::READY) {
+            start(stack);
+        }
+    }
+
+    window.draw(frame);
+    bar.setSize(sf::Vector2f(progressBarSize.x * stack.assets().progress(), progressBarSize.y));
+    window.draw(bar);
+}
+
+// LoadingScene hands over only once the font is in, so the lookup cannot fail here
+MainMenuScene::MainMenuScene(SceneStack& stack)
+    : Scene(stack),
+      font(stack.assets().font("arial.ttf")),
+      playButton("Play", *font, sf::Color::White, sf::Color::Yellow, sf::Color::Red, menuWindowWidth / 2.0f, menuWindowHeight / 2.0f - 70),   // Centered
+      replayButton("Replay", *font, sf::Color::White, sf::Color::Yellow, sf::Color::Red, menuWindowWidth / 2.0f, menuWindowHeight / 2.0f),
+      exitButton("Exit", *font, sf::Color::White, sf::Color::Yellow, sf::Color::Red, menuWindowWidth / 2.0f, menuWindowHeight / 2.0f + 70),  // Centered
+      text(font) {
+    input.addButton(playButton, [this]() { this->stack.push(std::make_unique<GameModeScene>(this->stack)); });
+    // A missing log just leaves the menu on top
+    input.addButton(replayButton, [this]() { this->stack.push(std::make_unique<ReplayScene>(this->stack, lastGameReplay)); });
+    input.addButton(exitButton, [this]() { this->stack.pop(); });
+}
+
+sf::Vector2u MainMenuScene::size() const {
+    return sf::Vector2u(menuWindowWidth, menuWindowHeight);
+}
+
+void MainMenuScene::handleEvent(const sf::Event& event) {
+    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
+        stack.pop();
+    }
+}
+
+void MainMenuScene::draw(sf::RenderWindow& window) {
+    if (playButton.changed || replayButton.changed || exitButton.changed) {
+        text.clear();
+        playButton.addTo(text);
+        replayButton.addTo(text);
+        exitButton.addTo(text);
+    }
+    window.draw(text);
+}
+
+GameModeScene::GameModeScene(SceneStack& stack)
+    : Scene(stack),
+      font(stack.assets().font("arial.ttf")),
+      withComputerButton("With Computer", *font, sf::Color::White, sf::Color::Yellow, sf::Color::Red, modeMenuWidth / 2.0f, modeMenuHeight / 2.0f - 50),
+      withFriendButton("With Friend", *font, sf::Color::White, sf::Color::Yellow, sf::Color::Red, modeMenuWidth / 2.0f, modeMenuHeight / 2.0f + 50),
+      backButton("Back", *font, sf::Color::White, sf::Color::Yellow, sf::Color::Red, modeMenuWidth / 2.0f, modeMenuHeight / 2.0f + 150),
+      text(font) {
+    // The mode menu is replaced, not covered: leaving the next screen returns to the main menu
+    input.addButton(withComputerButton, [this]() { this->stack.replace(std::make_unique<PlacementScene>(this->stack)); });
+    input.addButton(withFriendButton, [this]() { this->stack.replace(std::make_unique<GameScene>(this->stack, std::vector<Ship>())); });
+    input.addButton(backButton, [this]() { this->stack.pop(); });
+}
+
+sf::Vector2u GameModeScene::size() const {
+    return sf::Vector2u(modeMenuWidth, modeMenuHeight);
+}
+
+void GameModeScene::handleEvent(const sf::Event& event) {
+    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
+        stack.pop();
+    }
+}
+
+void GameModeScene::draw(sf::RenderWindow& window) {
+    if (withComputerButton.changed || withFriendButton.changed || backButton.changed) {
+        text.clear();
+        withComputerButton.addTo(text);
+        withFriendButton.addTo(text);
+        backButton.addTo(text);
+    }
+    window.draw(text);
+}
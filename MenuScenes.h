@@ -0,0 +1,67 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include "Button.h"
+#include "Scene.h"
+
+// Shown while AssetCache::loadAsync runs, so the window has its first frame
+// before any asset is decoded: a progress bar, drawn without the font. Once
+// everything is in it pops itself and calls `start` to push the real
+// screens; if an asset fails it just pops, which ends the game.
+class LoadingScene : public Scene {
+public:
+    LoadingScene(SceneStack& stack, std::function<void(SceneStack&)> start);
+
+    sf::Vector2u size() const override;
+    std::string title() const override { return "Sea Battle"; }
+
+    void handleEvent(const sf::Event& event) override;
+    void draw(sf::RenderWindow& window) override;
+
+private:
+    std::function<void(SceneStack&)> start;
+    bool done = false;
+    // Built once; a frame only resizes the bar
+    sf::RectangleShape frame;
+    sf::RectangleShape bar;
+};
+
+// First screen: Play / Replay (the last game against the computer) / Exit
+class MainMenuScene : public Scene {
+public:
+    explicit MainMenuScene(SceneStack& stack);
+
+    sf::Vector2u size() const override;
+    std::string title() const override { return "Main Menu"; }
+
+    void handleEvent(const sf::Event& event) override;
+    void draw(sf::RenderWindow& window) override;
+
+private:
+    std::shared_ptr<const sf::Font> font;
+    Button playButton;
+    Button replayButton;
+    Button exitButton;
+    // Button captions and backgrounds, baked again when one changes
+    TextBatch text;
+};
+
+// With Computer / With Friend / Back
+class GameModeScene : public Scene {
+public:
+    explicit GameModeScene(SceneStack& stack);
+
+    sf::Vector2u size() const override;
+    std::string title() const override { return "Select Game Mode"; }
+    sf::Color background() const override { return sf::Color::Cyan; }
+
+    void handleEvent(const sf::Event& event) override;
+    void draw(sf::RenderWindow& window) override;
+
+private:
+    std::shared_ptr<const sf::Font> font;
+    Button withComputerButton;
+    Button withFriendButton;
+    Button backButton;
+    TextBatch text;
+};
@@ -0,0 +1,134 @@
+#include "NetServer.h"
+#include <iostream>
+
+namespace {
+
+const float statsIntervalSeconds = 5.0f;
+
+}
+
+NetServer::NetServer(uint64_t seed)
+    : matchHost([this](ClientId id, const Message& message) {
+                    auto it = clients.find(id);
+                    if (it != clients.end()) {
+                        appendMessage(message, it->second.outbox);
+                    }
+                }, seed) {
+}
+
+bool NetServer::listen(unsigned short port) {
+    if (listener.listen(port) != sf::Socket::Done) {
+        std::cerr << "Error listening on port " << port << "!" << std::endl;
+        return false;
+    }
+    selector.add(listener);
+    return true;
+}
+
+void NetServer::run(const std::atomic<bool>& stop, bool logStats) {
+    sf::Clock statsClock;
+    uint64_t statsFinished = matchHost.finishedMatches();
+    uint64_t statsMoves = matchHost.movesPlayed();
+    bool outputPending = false;
+    std::vector<ClientId> dropped;
+
+    while (!stop) {
+        // Sockets with unsent output are retried soon; otherwise sleep until input
+        if (selector.wait(outputPending ? sf::milliseconds(1) : sf::milliseconds(100))) {
+            if (selector.isReady(listener)) {
+                acceptClient();
+            }
+            for (auto& entry : clients) {
+                if (selector.isReady(*entry.second.socket) && !readClient(entry.first, entry.second)) {
+                    dropped.push_back(entry.first);
+                }
+            }
+        }
+        for (ClientId id : dropped) {
+            dropClient(id);
+        }
+        dropped.clear();
+
+        outputPending = false;
+        for (auto& entry : clients) {
+            if (!flushClient(entry.second)) {
+                dropped.push_back(entry.first);
+            }
+            outputPending = outputPending || !entry.second.outbox.empty();
+        }
+
+        const float seconds = statsClock.getElapsedTime().asSeconds();
+        if (logStats && seconds >= statsIntervalSeconds) {
+            std::cout << "clients: " << clients.size() << ", active matches: " << matchHost.activeMatches()
+                      << ", finished: " << matchHost.finishedMatches()
+                      << ", matches/s: " << (matchHost.finishedMatches() - statsFinished) / seconds
+                      << ", moves/s: " << (matchHost.movesPlayed() - statsMoves) / seconds << std::endl;
+            statsFinished = matchHost.finishedMatches();
+            statsMoves = matchHost.movesPlayed();
+            statsClock.restart();
+        }
+    }
+}
+
+void NetServer::acceptClient() {
+    std::unique_ptr<sf::TcpSocket> socket(new sf::TcpSocket());
+    if (listener.accept(*socket) != sf::Socket::Done) {
+        return;
+    }
+    socket->setBlocking(false);
+    selector.add(*socket);
+    Client& client = clients[nextClient++];
+    client.socket = std::move(socket);
+}
+
+bool NetServer::readClient(ClientId id, Client& client) {
+    uint8_t buffer[4096];
+    for (;;) {
+        size_t received = 0;
+        const sf::Socket::Status status = client.socket->receive(buffer, sizeof(buffer), received);
+        if (status == sf::Socket::NotReady) {
+            break;
+        }
+        if (status != sf::Socket::Done && status != sf::Socket::Partial) {
+            return false;
+        }
+        client.reader.feed(buffer, received);
+        if (received < sizeof(buffer)) {
+            break;
+        }
+    }
+    Message message;
+    while (client.reader.next(message)) {
+        matchHost.receive(id, message);
+    }
+    // A corrupt stream cannot be resynchronised
+    return !client.reader.failed();
+}
+
+bool NetServer::flushClient(Client& client) {
+    if (client.outbox.empty()) {
+        return true;
+    }
+    size_t sent = 0;
+    const sf::Socket::Status status = client.socket->send(client.outbox.data() + client.sent, client.outbox.size() - client.sent, sent);
+    if (status == sf::Socket::Disconnected || status == sf::Socket::Error) {
+        return false;
+    }
+    client.sent += sent;
+    if (client.sent == client.outbox.size()) {
+        client.outbox.clear();
+        client.sent = 0;
+    }
+    return true;
+}
+
+void NetServer::dropClient(ClientId id) {
+    auto it = clients.find(id);
+    if (it == clients.end()) {
+        return;
+    }
+    selector.remove(*it->second.socket);
+    clients.erase(it);
+    // After the erase: whatever the host still sends to this client is dropped
+    matchHost.disconnect(id);
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <SFML/Network.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "MatchHost.h"
+#include "Protocol.h"
+
+const unsigned short defaultServerPort = 53000;
+
+// TCP front end of MatchHost: one thread, one SocketSelector, non-blocking
+// sockets. Clients usually run many games over one connection, so thousands
+// of matches need only a handful of sockets (select() caps the number of
+// sockets, not the number of games).
+class NetServer {
+public:
+    explicit NetServer(uint64_t seed = 0);
+
+    // Port 0 picks a free port, see port()
+    bool listen(unsigned short port);
+    unsigned short port() const { return listener.getLocalPort(); }
+
+    // Serves until `stop` is set; looks at it at least every 100 ms
+    void run(const std::atomic<bool>& stop, bool logStats = false);
+
+    const MatchHost& host() const { return matchHost; }
+
+private:
+    struct Client {
+        std::unique_ptr<sf::TcpSocket> socket;
+        MessageReader reader;
+        std::vector<uint8_t> outbox;
+        size_t sent = 0;   // bytes of outbox already on the wire
+    };
+
+    sf::TcpListener listener;
+    sf::SocketSelector selector;
+    std::unordered_map<ClientId, Client> clients;
+    ClientId nextClient = 1;
+    MatchHost matchHost;
+
+    void acceptClient();
+    // False when the client has to be dropped
+    bool readClient(ClientId id, Client& client);
+    bool flushClient(Client& client);
+    void dropClient(ClientId id);
+};
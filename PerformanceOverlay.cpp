@@ -0,0 +1,120 @@
+#include "PerformanceOverlay.h"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+namespace {
+
+const size_t frameHistory = 240;
+const float refreshSeconds = 0.25f;
+const size_t scopesShown = 8;
+
+}
+
+void PerformanceOverlay::setFont(std::shared_ptr<const sf::Font> value) {
+    font = std::move(value);
+    if (font) {
+        text.setFont(*font);
+    }
+    text.setCharacterSize(14);
+    text.setFillColor(sf::Color::White);
+    text.setPosition(8, 6);
+    panel.setFillColor(sf::Color(0, 0, 0, 180));
+    panel.setPosition(4, 4);
+}
+
+void PerformanceOverlay::setVisible(bool value) {
+    shown = value;
+    if (!shown) {
+        return;
+    }
+    // Start from now: whatever the rings hold is stale
+    frameMs.clear();
+    frameCount = 0;
+    framesSinceRefresh = 0;
+    samples.clear();
+    Profiler::read(Profiler::threadIndex(), cursor, samples);
+    samples.clear();
+    refreshClock.restart();
+    text.setString("measuring...");
+    const sf::FloatRect bounds = text.getLocalBounds();
+    panel.setSize(sf::Vector2f(bounds.left + bounds.width + 8, bounds.top + bounds.height + 8));
+}
+
+void PerformanceOverlay::frameDone(const FrameStats& stats) {
+    if (!shown) {
+        return;
+    }
+    if (frameMs.size() < frameHistory) {
+        frameMs.push_back(stats.lastFrameMs);
+    }
+    else {
+        frameMs[frameCount % frameHistory] = stats.lastFrameMs;
+    }
+    ++frameCount;
+    ++framesSinceRefresh;
+    lastDrawCalls = stats.drawCalls;
+    firstFrameMs = stats.firstFrameMs;
+    if (refreshClock.getElapsedTime().asSeconds() >= refreshSeconds) {
+        refresh();
+    }
+}
+
+void PerformanceOverlay::refresh() {
+    const float seconds = refreshClock.restart().asSeconds();
+    const uint64_t frames = std::max<uint64_t>(framesSinceRefresh, 1);
+
+    std::vector<float> sorted(frameMs);
+    std::sort(sorted.begin(), sorted.end());
+    auto percentile = [&](double fraction) {
+        return sorted.empty() ? 0.0f : sorted[static_cast<size_t>(fraction * (sorted.size() - 1))];
+    };
+
+    // Render thread scopes since the last refresh, summed by name
+    samples.clear();
+    Profiler::read(Profiler::threadIndex(), cursor, samples);
+    totals.clear();
+    for (const auto& sample : samples) {
+        auto it = std::find_if(totals.begin(), totals.end(), [&](const ScopeTotal& total) {
+            return total.name == sample.name || std::strcmp(total.name, sample.name) == 0;
+        });
+        if (it == totals.end()) {
+            totals.push_back({ sample.name, 0, 0 });
+            it = totals.end() - 1;
+        }
+        it->nanoseconds += sample.end - sample.start;
+        ++it->calls;
+    }
+    std::sort(totals.begin(), totals.end(), [](const ScopeTotal& a, const ScopeTotal& b) {
+        return a.nanoseconds > b.nanoseconds;
+    });
+
+    std::ostringstream out;
+    out.setf(std::ios::fixed);
+    out.precision(1);
+    out << "FPS " << framesSinceRefresh / seconds << "   draw calls " << lastDrawCalls << "   first frame " << firstFrameMs << " ms\n";
+    out.precision(2);
+    out << "frame ms  p50 " << percentile(0.5) << "  p90 " << percentile(0.9) << "  p99 " << percentile(0.99)
+        << "  max " << percentile(1.0) << "\n";
+    for (size_t i = 0; i < totals.size() && i < scopesShown; ++i) {
+        out << totals[i].nanoseconds / 1e6 / frames << " ms  " << totals[i].name;
+        if (totals[i].calls > frames) {
+            out << " x" << totals[i].calls / frames;
+        }
+        out << "\n";
+    }
+    framesSinceRefresh = 0;
+
+    text.setString(out.str());
+    const sf::FloatRect bounds = text.getLocalBounds();
+    panel.setSize(sf::Vector2f(bounds.left + bounds.width + 8, bounds.top + bounds.height + 8));
+}
+
+void PerformanceOverlay::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    if (!shown || !font) {
+        return;
+    }
+    target.draw(panel, states);
+    target.draw(text, states);
+    Profiler::countDrawCalls(2);
+}
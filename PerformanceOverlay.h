@@ -0,0 +1,49 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "FrameLoop.h"
+#include "Profiler.h"
+
+// Top-left readout of FPS, frame-time percentiles, draw calls and the
+// render thread's busiest scopes (ms per frame). Refreshed a few times a
+// second from the frames drawn since the last refresh; while hidden it
+// does nothing at all.
+class PerformanceOverlay : public sf::Drawable {
+public:
+    void setFont(std::shared_ptr<const sf::Font> font);
+
+    bool visible() const { return shown; }
+    void setVisible(bool value);
+
+    // Once per frame drawn, after FrameLoop::endFrame()
+    void frameDone(const FrameStats& stats);
+
+private:
+    struct ScopeTotal {
+        const char* name;
+        uint64_t nanoseconds;
+        unsigned calls;
+    };
+
+    std::shared_ptr<const sf::Font> font;
+    sf::Text text;
+    sf::RectangleShape panel;
+    bool shown = false;
+
+    // Frame times of the last frameHistory frames
+    std::vector<float> frameMs;
+    size_t frameCount = 0;
+    uint64_t framesSinceRefresh = 0;
+    unsigned lastDrawCalls = 0;
+    float firstFrameMs = 0;
+    sf::Clock refreshClock;
+
+    uint64_t cursor = 0;
+    std::vector<ProfileSample> samples;
+    std::vector<ScopeTotal> totals;
+
+    void refresh();
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+};
@@ -0,0 +1,185 @@
+#include "PlacementScene.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include "GameScene.h"
+
+namespace {
+
+const int windowWidth = 1000;
+const int windowHeight = 700;
+const int boardSize = 500;
+
+// Board Margin
+const int boardMarginLeft = 50;
+const int boardMarginTop = 50;
+
+//  Position of Ships:
+const int shipPanelPositionX = boardMarginLeft + boardSize + 50;
+const int shipPanelTop = 100;
+const int shipPanelBottom = windowHeight - 100;
+// Panel cells and rows shrink only when a fleet does not fit otherwise
+const float panelCellSize = 25.0f;
+const float panelRowSpacing = 40.0f;
+
+const sf::FloatRect boardArea(static_cast<float>(boardMarginLeft), static_cast<float>(boardMarginTop), boardSize, boardSize);
+
+// Zoom per wheel notch
+const float wheelZoom = 1.25f;
+
+}
+
+PlacementScene::PlacementScene(SceneStack& stack)
+    : Scene(stack),
+      font(stack.assets().font("arial.ttf")),
+      autoButton("Auto", *font, sf::Color::White, sf::Color::Yellow, sf::Color::Red, boardMarginLeft + boardSize / 2.0f - 50, windowHeight - 50),
+      battleButton("To Battle", *font, sf::Color::White, sf::Color::Yellow, sf::Color::Red, boardMarginLeft + boardSize + 100, windowHeight - 50),
+      rotateButton("Rotate", *font, sf::Color::White, sf::Color::Yellow, sf::Color::Red, shipPanelPositionX, 50),
+      rng(std::random_device{}()),
+      view(boardArea, stack.rules().rows, stack.rules().cols),
+      text(font) {
+    std::string error;
+    uniformReady = uniform.openCached(stack.rules(), FleetSampler::defaultCachePath(stack.rules()), error);
+    placeAutomatically();
+
+    input.addButton(autoButton, [this]() {
+        placeAutomatically();
+        shipsChanged = true;
+    });
+    input.addButton(battleButton, [this]() { this->stack.replace(std::make_unique<GameScene>(this->stack, placedShips, true)); });
+    input.addButton(rotateButton, []() { std::cout << "Rotate" << std::endl; });
+}
+
+sf::Vector2u PlacementScene::size() const {
+    return sf::Vector2u(windowWidth, windowHeight);
+}
+
+bool PlacementScene::load() {
+    if (!stack.assets().texture("field.png")) {
+        return false;
+    }
+    if (!boardLayer.create(windowWidth, windowHeight) || !panelLayer.create(windowWidth, windowHeight)) {
+        std::cerr << "Error creating board layer!" << std::endl;
+        return false;
+    }
+    bakeBoard();
+
+    // Ships to place: one row per length, longest first, with its count
+    std::map<int, int, std::greater<int>> shipCounts;
+    for (int length : stack.rules().shipLengths) {
+        ++shipCounts[length];
+    }
+    const float cellSize = std::min(panelCellSize, (windowWidth - shipPanelPositionX - 60.0f) / stack.rules().maxShipLength());
+    const float rowSpacing = std::min(panelRowSpacing, static_cast<float>(shipPanelBottom - shipPanelTop) / shipCounts.size());
+    const BoardLayout panelLayout = { static_cast<float>(shipPanelPositionX), static_cast<float>(shipPanelTop), cellSize, cellSize, 1, 1 };
+
+    CellBatch panel;
+    sf::Text count("", *font, 18);
+    count.setFillColor(sf::Color::White);
+    int i = 0;
+    for (const auto& entry : shipCounts) {
+        const float row = i * rowSpacing / cellSize;
+        for (int j = 0; j < entry.first; ++j) {
+            panel.addCell(panelLayout, row, static_cast<float>(j), shipColor(entry.first), true);
+        }
+        count.setString("x" + std::to_string(entry.second));
+        count.setPosition(shipPanelPositionX + entry.first * cellSize + 10, shipPanelTop + i * rowSpacing);
+        panelLayer.canvas().draw(count);
+        ++i;
+    }
+    panel.commit();
+    panelLayer.canvas().draw(panel);
+    panelLayer.finish();
+
+    shipCells.reserve(2 * stack.rules().cellCount());
+    return true;
+}
+
+void PlacementScene::bakeBoard() {
+    sf::RenderTexture& canvas = boardLayer.canvas();
+    boardLayer.clear();
+    canvas.setView(view.clipView(canvas.getSize()));
+    drawBoardImage(canvas, *stack.assets().texture("field.png"), view);
+    canvas.setView(canvas.getDefaultView());
+    boardLayer.finish();
+    viewChanged = false;
+}
+
+void PlacementScene::bakeText() {
+    text.clear();
+    addCoordinateLabels(text, view);
+    autoButton.addTo(text);
+    battleButton.addTo(text);
+    rotateButton.addTo(text);
+}
+
+void PlacementScene::placeAutomatically() {
+    if (!uniformReady) {
+        autoPlaceShipsInPlacement(placedShips, stack.rules());
+        return;
+    }
+    uniform.sample(rng, sampled);
+    placedShips.clear();
+    for (const auto& ship : sampled) {
+        placedShips.push_back({ ship.length, ship.row, ship.col, ship.direction });
+    }
+}
+
+void PlacementScene::handleEvent(const sf::Event& event) {
+    // Zoom and pan
+    if (event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Right) {
+        dragFrom = sf::Vector2f(static_cast<float>(event.mouseButton.x), static_cast<float>(event.mouseButton.y));
+        dragging = view.area().contains(dragFrom);
+    }
+    if (event.type == sf::Event::MouseMoved && dragging) {
+        sf::Vector2f point(static_cast<float>(event.mouseMove.x), static_cast<float>(event.mouseMove.y));
+        if (view.pan(point - dragFrom)) {
+            viewChanged = true;
+        }
+        dragFrom = point;
+    }
+    if (event.type == sf::Event::MouseButtonReleased && event.mouseButton.button == sf::Mouse::Right) {
+        dragging = false;
+    }
+    if (event.type == sf::Event::MouseWheelScrolled && event.mouseWheelScroll.wheel == sf::Mouse::VerticalWheel) {
+        sf::Vector2f point(static_cast<float>(event.mouseWheelScroll.x), static_cast<float>(event.mouseWheelScroll.y));
+        if (view.area().contains(point) && view.zoom(std::pow(wheelZoom, event.mouseWheelScroll.delta), point)) {
+            viewChanged = true;
+        }
+    }
+    if (viewChanged) {
+        shipsChanged = true;
+    }
+
+    if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::Escape) {
+        stack.pop();
+    }
+}
+
+void PlacementScene::draw(sf::RenderWindow& window) {
+    if (viewChanged || autoButton.changed || battleButton.changed || rotateButton.changed) {
+        bakeText();
+    }
+    if (viewChanged) {
+        bakeBoard();
+    }
+    if (shipsChanged) {
+        shipCells.clear();
+        shipCells.addShips(view.layout(), placedShips, view.visibleCells());
+        shipCells.commit();
+        shipsChanged = false;
+    }
+    window.draw(panelLayer);
+    window.draw(boardLayer);
+    const sf::View screen = window.getView();
+    window.setView(view.clipView(window.getSize()));
+    window.draw(shipCells);
+    window.setView(screen);
+
+    // Labels and buttons
+    window.draw(text);
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "BoardRenderer.h"
+#include "Button.h"
+#include "FleetSampler.h"
+#include "GameState.h"
+#include "Scene.h"
+
+// Player's fleet layout before a game against the computer, for the
+// session's rules. Large boards zoom with the mouse wheel and pan with the
+// right button, as in the battle.
+class PlacementScene : public Scene {
+public:
+    explicit PlacementScene(SceneStack& stack);
+
+    sf::Vector2u size() const override;
+    std::string title() const override { return "Ship Placement"; }
+
+    bool load() override;
+    void handleEvent(const sf::Event& event) override;
+    void draw(sf::RenderWindow& window) override;
+
+private:
+    std::shared_ptr<const sf::Font> font;
+    Button autoButton;
+    Button battleButton;
+    Button rotateButton;
+
+    std::vector<Ship> placedShips;
+    // Auto draws uniformly from the layout tables if `SeaBattleCli layouts`
+    // has cached them for these rules, else it uses the quick generator
+    FleetSampler uniform;
+    bool uniformReady = false;
+    Rng rng;
+    std::vector<ShipPlacement> sampled;
+    BoardView view;
+    bool dragging = false;
+    sf::Vector2f dragFrom;
+
+    // Ship panel: never changes, baked once in load()
+    StaticLayer panelLayer;
+    // Board image, baked again when the view moves
+    StaticLayer boardLayer;
+    bool viewChanged = true;
+    // Coordinate labels and button captions in one draw call, baked again
+    // when the view moves or a button changes
+    TextBatch text;
+    // Placed ships in view, rebuilt only when the layout or view changes
+    CellBatch shipCells;
+    bool shipsChanged = true;
+
+    void bakeBoard();
+    void bakeText();
+    void placeAutomatically();
+};
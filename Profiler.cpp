@@ -0,0 +1,187 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+
+std::atomic<bool> Profiler::on(false);
+thread_local unsigned Profiler::drawCalls = 0;
+
+namespace {
+
+// Written only by the thread that owns it. A slot is filled before `head`
+// moves past it; a reader that finds `head` more than a ring ahead of a slot
+// drops it.
+struct Ring {
+    struct Slot {
+        std::atomic<const char*> name;
+        std::atomic<uint64_t> start;
+        std::atomic<uint64_t> end;
+    };
+    Slot slots[Profiler::ringCapacity];
+    std::atomic<uint64_t> head{ 0 };
+    // First sample of the current owner; older ones belong to an exited thread
+    std::atomic<uint64_t> ownerStart{ 0 };
+    std::string name;   // under registryMutex
+};
+
+const auto epoch = std::chrono::steady_clock::now();
+
+// A thread gets a ring on its first sample. When it exits the ring goes on
+// the free list: its samples stay readable until another thread takes it
+// over, and memory follows the number of threads alive, not ever started.
+std::mutex registryMutex;
+std::vector<std::unique_ptr<Ring>> rings;
+std::vector<int> freeRings;
+
+struct RingOwner {
+    Ring* ring = nullptr;
+    int index = -1;
+    std::string name;   // kept until the ring exists
+
+    ~RingOwner() {
+        if (ring != nullptr) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            freeRings.push_back(index);
+        }
+    }
+};
+
+thread_local RingOwner owner;
+
+Ring& threadRing() {
+    if (owner.ring == nullptr) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        if (freeRings.empty()) {
+            rings.push_back(std::make_unique<Ring>());
+            owner.index = static_cast<int>(rings.size()) - 1;
+        }
+        else {
+            owner.index = freeRings.back();
+            freeRings.pop_back();
+        }
+        owner.ring = rings[owner.index].get();
+        owner.ring->ownerStart.store(owner.ring->head.load(std::memory_order_relaxed), std::memory_order_release);
+        owner.ring->name = owner.name.empty() ? "thread " + std::to_string(owner.index) : owner.name;
+    }
+    return *owner.ring;
+}
+
+Ring* ringAt(int thread) {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return thread >= 0 && thread < static_cast<int>(rings.size()) ? rings[thread].get() : nullptr;
+}
+
+void writeEscaped(std::ostream& out, const std::string& text) {
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out << '\\';
+        }
+        out << c;
+    }
+}
+
+}
+
+uint64_t Profiler::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void Profiler::record(const char* name, uint64_t start, uint64_t end) {
+    Ring& ring = threadRing();
+    const uint64_t index = ring.head.load(std::memory_order_relaxed);
+    Ring::Slot& slot = ring.slots[index & (ringCapacity - 1)];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.end.store(end, std::memory_order_relaxed);
+    ring.head.store(index + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const std::string& name) {
+    owner.name = name;
+    if (owner.ring != nullptr) {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        owner.ring->name = name;
+    }
+}
+
+int Profiler::threadIndex() {
+    return owner.index;
+}
+
+int Profiler::threadCount() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    return static_cast<int>(rings.size());
+}
+
+void Profiler::read(int thread, uint64_t& cursor, std::vector<ProfileSample>& out) {
+    Ring* ring = ringAt(thread);
+    if (ring == nullptr) {
+        return;
+    }
+    const uint64_t head = ring->head.load(std::memory_order_acquire);
+    const uint64_t oldest = std::max(ring->ownerStart.load(std::memory_order_acquire), head > ringCapacity ? head - ringCapacity : 0);
+    const uint64_t first = std::max(cursor, oldest);
+    const size_t copied = out.size();
+    for (uint64_t index = first; index < head; ++index) {
+        const Ring::Slot& slot = ring->slots[index & (ringCapacity - 1)];
+        out.push_back({ slot.name.load(std::memory_order_relaxed), slot.start.load(std::memory_order_relaxed),
+                        slot.end.load(std::memory_order_relaxed) });
+    }
+    // The writer may have lapped the oldest slots while they were copied
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t after = ring->head.load(std::memory_order_relaxed);
+    if (after >= ringCapacity && after - ringCapacity + 1 > first) {
+        const uint64_t lost = std::min<uint64_t>(after - ringCapacity + 1 - first, head - first);
+        out.erase(out.begin() + copied, out.begin() + copied + static_cast<size_t>(lost));
+    }
+    cursor = head;
+}
+
+unsigned Profiler::takeDrawCalls() {
+    const unsigned calls = drawCalls;
+    drawCalls = 0;
+    return calls;
+}
+
+bool Profiler::writeChromeTrace(const std::string& path, uint64_t since) {
+    std::ofstream out(path);
+    if (!out) {
+        return false;
+    }
+    out.setf(std::ios::fixed);
+    out.precision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    std::vector<ProfileSample> samples;
+    const int threads = threadCount();
+    for (int thread = 0; thread < threads; ++thread) {
+        std::string name;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            name = rings[thread]->name;
+        }
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread
+            << ",\"args\":{\"name\":\"";
+        writeEscaped(out, name);
+        out << "\"}}";
+        first = false;
+
+        uint64_t cursor = 0;
+        samples.clear();
+        read(thread, cursor, samples);
+        for (const auto& sample : samples) {
+            if (sample.start < since) {
+                continue;
+            }
+            out << ",\n{\"name\":\"";
+            writeEscaped(out, sample.name);
+            // Chrome trace times are microseconds
+            out << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread << ",\"ts\":" << sample.start / 1000.0
+                << ",\"dur\":" << (sample.end - sample.start) / 1000.0 << "}";
+        }
+    }
+    out << "\n]}\n";
+    return static_cast<bool>(out);
+}
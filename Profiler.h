@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One timed scope; times are nanoseconds since the profiler started
+struct ProfileSample {
+    const char* name;
+    uint64_t start;
+    uint64_t end;
+};
+
+// Scoped-timer instrumentation. Every thread records into its own ring of
+// the newest ringCapacity samples, so recording never takes a lock; readers
+// copy samples out behind the writer. Rings of exited threads are reused.
+// While disabled a scope costs a single relaxed load and branch.
+//
+//     void CellBatch::commit() {
+//         ProfileScope scope("CellBatch::commit");
+//         ...
+//
+// Names must be string literals (or otherwise outlive the profiler).
+class Profiler {
+public:
+    static constexpr size_t ringCapacity = 1 << 14;
+
+    static bool enabled() { return on.load(std::memory_order_relaxed); }
+    static void setEnabled(bool value) { on.store(value, std::memory_order_relaxed); }
+
+    static uint64_t now();
+    static void record(const char* name, uint64_t start, uint64_t end);
+
+    // Name of the calling thread in traces ("thread N" by default); cheap,
+    // the ring is only set up on the thread's first sample
+    static void setThreadName(const std::string& name);
+    // Ring of the calling thread, for read(); -1 before its first sample
+    static int threadIndex();
+    static int threadCount();
+    // Samples of ring `thread` recorded since `cursor`, oldest first, and
+    // advances the cursor. Samples already overwritten, or left by an exited
+    // thread whose ring was taken over, are skipped.
+    static void read(int thread, uint64_t& cursor, std::vector<ProfileSample>& out);
+
+    // Every sample still in the rings that started at `since` or later, as
+    // Chrome trace JSON (chrome://tracing, ui.perfetto.dev)
+    static bool writeChromeTrace(const std::string& path, uint64_t since = 0);
+
+    // Draw calls issued by the calling thread since takeDrawCalls()
+    static void countDrawCalls(unsigned calls = 1) { drawCalls += calls; }
+    static unsigned takeDrawCalls();
+
+private:
+    static std::atomic<bool> on;
+    static thread_local unsigned drawCalls;
+};
+
+class ProfileScope {
+public:
+    explicit ProfileScope(const char* name)
+        : name(Profiler::enabled() ? name : nullptr), start(this->name != nullptr ? Profiler::now() : 0) {
+    }
+    ~ProfileScope() {
+        if (name != nullptr) {
+            Profiler::record(name, start, Profiler::now());
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    const char* name;
+    uint64_t start;
+};
@@ -0,0 +1,167 @@
+#include "Protocol.h"
+#include "FixedBoard.h"
+#include "FleetGenerator.h"
+
+size_t messageSize(MessageType type) {
+    switch (type) {
+    case MessageType::FLEET:
+        return 4 + protocolFleetSize;
+    case MessageType::SHOT:
+        return 5;
+    case MessageType::MATCHED:
+    case MessageType::GAME_OVER:
+    case MessageType::ERROR:
+        return 4;
+    case MessageType::SHOT_RESULT:
+        return 7;
+    }
+    return 0;
+}
+
+size_t encodeMessage(const Message& message, uint8_t* out) {
+    out[0] = static_cast<uint8_t>(message.type);
+    out[1] = static_cast<uint8_t>(message.game);
+    out[2] = static_cast<uint8_t>(message.game >> 8);
+    switch (message.type) {
+    case MessageType::FLEET:
+        out[3] = message.flags;
+        for (int i = 0; i < protocolFleetSize; ++i) {
+            const Ship& ship = message.fleet[i];
+            const int cell = ship.startRow * protocolCols + ship.startCol;
+            out[4 + i] = static_cast<uint8_t>(cell | (ship.direction == ShipDirection::VERTICAL ? 0x80 : 0));
+        }
+        break;
+    case MessageType::SHOT:
+        out[3] = message.row;
+        out[4] = message.col;
+        break;
+    case MessageType::SHOT_RESULT:
+        out[3] = message.flags;
+        out[4] = message.row;
+        out[5] = message.col;
+        out[6] = static_cast<uint8_t>(message.result);
+        break;
+    default:
+        out[3] = message.flags;
+        break;
+    }
+    return messageSize(message.type);
+}
+
+void appendMessage(const Message& message, std::vector<uint8_t>& out) {
+    uint8_t bytes[maxMessageSize];
+    const size_t size = encodeMessage(message, bytes);
+    out.insert(out.end(), bytes, bytes + size);
+}
+
+bool decodeMessage(const uint8_t* data, Message& message) {
+    message.type = static_cast<MessageType>(data[0]);
+    message.game = static_cast<uint16_t>(data[1] | (data[2] << 8));
+    switch (message.type) {
+    case MessageType::FLEET: {
+        message.flags = data[3];
+        const std::vector<int>& lengths = standardFleet();
+        for (int i = 0; i < protocolFleetSize; ++i) {
+            const int cell = data[4 + i] & 0x7f;
+            message.fleet[i] = { lengths[i], cell / protocolCols, cell % protocolCols,
+                                 (data[4 + i] & 0x80) ? ShipDirection::VERTICAL : ShipDirection::HORIZONTAL };
+        }
+        return message.flags <= static_cast<uint8_t>(Opponent::PLAYER);
+    }
+    case MessageType::SHOT:
+        message.row = data[3];
+        message.col = data[4];
+        return true;
+    case MessageType::SHOT_RESULT:
+        message.flags = data[3];
+        message.row = data[4];
+        message.col = data[5];
+        message.result = static_cast<ShotResult>(data[6]);
+        return data[6] <= static_cast<uint8_t>(ShotResult::SUNK);
+    case MessageType::MATCHED:
+    case MessageType::GAME_OVER:
+    case MessageType::ERROR:
+        message.flags = data[3];
+        return true;
+    }
+    return false;
+}
+
+Message fleetMessage(uint16_t game, Opponent opponent, const std::vector<Ship>& fleet) {
+    Message message;
+    message.type = MessageType::FLEET;
+    message.game = game;
+    message.flags = static_cast<uint8_t>(opponent);
+    // The wire order is standardFleet() order: longest ship first
+    std::vector<bool> used(fleet.size(), false);
+    const std::vector<int>& lengths = standardFleet();
+    for (int i = 0; i < protocolFleetSize; ++i) {
+        message.fleet[i] = { lengths[i], 0, 0, ShipDirection::HORIZONTAL };
+        for (size_t j = 0; j < fleet.size(); ++j) {
+            if (!used[j] && fleet[j].length == lengths[i]) {
+                message.fleet[i] = fleet[j];
+                used[j] = true;
+                break;
+            }
+        }
+    }
+    return message;
+}
+
+Message shotMessage(uint16_t game, int row, int col) {
+    Message message;
+    message.type = MessageType::SHOT;
+    message.game = game;
+    message.row = static_cast<uint8_t>(row);
+    message.col = static_cast<uint8_t>(col);
+    return message;
+}
+
+bool isValidFleet(const std::vector<Ship>& fleet) {
+    const std::vector<int>& lengths = standardFleet();
+    if (fleet.size() != lengths.size()) {
+        return false;
+    }
+    FixedBoard<protocolRows, protocolCols> board;
+    for (size_t i = 0; i < fleet.size(); ++i) {
+        const Ship& ship = fleet[i];
+        if (ship.length != lengths[i] || !board.canPlaceWithGap(ship.startRow, ship.startCol, ship.length, ship.direction)) {
+            return false;
+        }
+        board.place(ship.startRow, ship.startCol, ship.length, ship.direction);
+    }
+    return true;
+}
+
+void MessageReader::feed(const uint8_t* data, size_t size) {
+    // Drop what was consumed before it piles up
+    if (readPos > 0 && readPos == buffer.size()) {
+        buffer.clear();
+        readPos = 0;
+    }
+    else if (readPos > 4096) {
+        buffer.erase(buffer.begin(), buffer.begin() + readPos);
+        readPos = 0;
+    }
+    buffer.insert(buffer.end(), data, data + size);
+}
+
+bool MessageReader::next(Message& message) {
+    if (broken || readPos >= buffer.size()) {
+        return false;
+    }
+    const size_t size = messageSize(static_cast<MessageType>(buffer[readPos]));
+    if (size == 0) {
+        broken = true;
+        return false;
+    }
+    if (buffer.size() - readPos < size) {
+        return false;
+    }
+    if (!decodeMessage(&buffer[readPos], message)) {
+        broken = true;
+        return false;
+    }
+    readPos += size;
+    return true;
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "GameState.h"
+
+// Wire format of the game server, standard rules only (10x10, fleet
+// 4,3,3,2,2,2,1,1,1,1). Every message is a type byte, a little-endian uint16
+// game id picked by the client (one connection can run many games at once)
+// and a payload whose size is fixed by the type:
+//
+//   FLEET        14 bytes  flags = Opponent, then one byte per ship in
+//                          standardFleet() order: cell | vertical << 7
+//   SHOT          5 bytes  row, col
+//   MATCHED       4 bytes  flags = 1 if you shoot first
+//   SHOT_RESULT   7 bytes  flags = 1 if the opponent shot, row, col, ShotResult
+//   GAME_OVER     4 bytes  flags = 1 if you won
+//   ERROR         4 bytes  flags = ProtocolError
+enum class MessageType : uint8_t {
+    FLEET = 1,          // client: start a game with this fleet
+    SHOT = 2,           // client: fire at the opponent
+    MATCHED = 16,       // server: both fleets are in, the game has started
+    SHOT_RESULT = 17,   // server: a shot in your game, yours or the opponent's
+    GAME_OVER = 18,
+    ERROR = 19
+};
+
+enum class Opponent : uint8_t {
+    COMPUTER = 0,
+    PLAYER = 1    // paired with the next client asking for a player
+};
+
+enum class ProtocolError : uint8_t {
+    BAD_FLEET = 1,
+    GAME_EXISTS = 2,
+    UNKNOWN_GAME = 3,
+    NOT_YOUR_TURN = 4,
+    BAD_SHOT = 5
+};
+
+const int protocolRows = 10;
+const int protocolCols = 10;
+const int protocolFleetSize = 10;
+const size_t maxMessageSize = 14;
+
+struct Message {
+    MessageType type = MessageType::ERROR;
+    uint16_t game = 0;
+    uint8_t flags = 0;   // meaning depends on the type, see above
+    uint8_t row = 0;
+    uint8_t col = 0;
+    ShotResult result = ShotResult::MISS;
+    std::array<Ship, protocolFleetSize> fleet;   // FLEET only
+};
+
+// 0 for an unknown type
+size_t messageSize(MessageType type);
+// Writes messageSize(message.type) bytes to `out` and returns that count
+size_t encodeMessage(const Message& message, uint8_t* out);
+void appendMessage(const Message& message, std::vector<uint8_t>& out);
+// `data` holds messageSize() bytes of the type in data[0]
+bool decodeMessage(const uint8_t* data, Message& message);
+
+Message fleetMessage(uint16_t game, Opponent opponent, const std::vector<Ship>& fleet);
+Message shotMessage(uint16_t game, int row, int col);
+
+// Standard fleet, on the board, no ships touching
+bool isValidFleet(const std::vector<Ship>& fleet);
+
+// Cuts a TCP byte stream into messages. Once a bad type byte shows up the
+// stream cannot be resynchronised and the reader stays failed.
+class MessageReader {
+public:
+    void feed(const uint8_t* data, size_t size);
+    // False when no complete message is buffered (or the stream failed)
+    bool next(Message& message);
+    bool failed() const { return broken; }
+
+private:
+    std::vector<uint8_t> buffer;
+    size_t readPos = 0;
+    bool broken = false;
+};
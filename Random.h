@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+
+// Small, fast, seedable generator (xoshiro256**), seeded through SplitMix64.
+// Unlike std::random_device it is cheap to create, and the same seed always
+// gives the same sequence on every platform.
+class Rng {
+public:
+    explicit Rng(uint64_t seed = 0) { reseed(seed); }
+
+    void reseed(uint64_t seed) {
+        for (auto& word : state) {
+            word = splitMix64(seed);
+        }
+    }
+
+    uint64_t next() {
+        const uint64_t result = rotl(state[1] * 5, 7) * 9;
+        const uint64_t t = state[1] << 17;
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+        return result;
+    }
+
+    // Unbiased integer in [0, bound), bound > 0 (Lemire's method)
+    uint32_t below(uint32_t bound) {
+        uint64_t product = (next() >> 32) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound) {
+            const uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold) {
+                product = (next() >> 32) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    // Unbiased integer in [0, bound), bound > 0, for bounds past 32 bits
+    uint64_t below64(uint64_t bound) {
+        // 2^64 - threshold is a multiple of bound
+        const uint64_t threshold = (0 - bound) % bound;
+        uint64_t value = next();
+        while (value < threshold) {
+            value = next();
+        }
+        return value % bound;
+    }
+
+    static uint64_t splitMix64(uint64_t& x) {
+        uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+private:
+    uint64_t state[4];
+
+    static uint64_t rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+};
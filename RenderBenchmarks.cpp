@@ -0,0 +1,231 @@
+// Offscreen frame of the battle screen: baked board layer plus the ship and
+// shot batch, drawn into a RenderTexture the size of the game window.
+// Needs a GL context; on machines without one the benchmarks are skipped.
+#include <benchmark/benchmark.h>
+#include <SFML/Graphics.hpp>
+#include <cstdio>
+#include <vector>
+#include "AllocationCounter.h"
+#include "AssetCache.h"
+#include "BoardRenderer.h"
+#include "EmbeddedAssets.h"
+#include "FleetGenerator.h"
+#include "GameState.h"
+#include "InputLayer.h"
+#include "TargetingEngine.h"
+#include "TextBatch.h"
+
+namespace {
+
+const unsigned frameWidth = 1400;
+const unsigned frameHeight = 700;
+
+const BoardLayout playerLayout = { 50.0f, 50.0f, 42.5f, 60.0f, 10, 10 };
+const BoardLayout opponentLayout = { 725.0f, 50.0f, 42.5f, 60.0f, 10, 10 };
+
+// Both fleets with `shots` shots fired at each
+struct BattleFixture {
+    std::vector<Ship> playerShips;
+    FleetState playerFleet;
+    FleetState opponentFleet;
+
+    explicit BattleFixture(int shots) {
+        std::vector<Ship> opponentShips;
+        autoPlaceShipsInPlacement(playerShips, 10, 10, 1);
+        autoPlaceShipsInPlacement(opponentShips, 10, 10, 2);
+        playerFleet.setFleet(playerShips);
+        opponentFleet.setFleet(opponentShips);
+        TargetingEngine shooter(10, 10, standardFleet(), 3);
+        int row = 0;
+        int col = 0;
+        for (int i = 0; i < shots && !playerFleet.defeated() && shooter.chooseTarget(row, col); ++i) {
+            shooter.recordShot(row, col, playerFleet.fire(row, col));
+            opponentFleet.fire(row, col);
+        }
+    }
+
+    void fill(CellBatch& cells) const {
+        cells.clear();
+        cells.addShips(playerLayout, playerShips);
+        cells.addMarks(playerLayout, playerFleet);
+        cells.addMarks(opponentLayout, opponentFleet);
+        cells.commit();
+    }
+};
+
+bool makeBoardLayer(AssetCache& assets, StaticLayer& layer) {
+    if (!layer.create(frameWidth, frameHeight)) {
+        return false;
+    }
+    std::shared_ptr<const sf::Texture> board = assets.texture("field.png");
+    if (board) {
+        for (const BoardLayout* layout : { &playerLayout, &opponentLayout }) {
+            drawBoardImage(layer.canvas(), *board, *layout);
+        }
+    }
+    layer.finish();
+    return true;
+}
+
+// One unchanged frame: what every redraw of the game screen costs
+void BM_BoardFrame(benchmark::State& state) {
+    AssetCache assets;
+    StaticLayer layer;
+    sf::RenderTexture target;
+    if (!makeBoardLayer(assets, layer) || !target.create(frameWidth, frameHeight)) {
+        state.SkipWithError("no render texture (no GL context?)");
+        return;
+    }
+    const BattleFixture battle(static_cast<int>(state.range(0)));
+    CellBatch cells;
+    cells.reserve(4 * 10 * 10);
+    battle.fill(cells);
+    uint64_t allocations = 0;
+    for (auto _ : state) {
+        const uint64_t before = allocationCount();
+        target.clear(sf::Color::Black);
+        target.draw(layer);
+        target.draw(cells);
+        target.display();
+        allocations += allocationCount() - before;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+// A frame after a shot: the cell batch is rebuilt and uploaded first
+void BM_BoardFrameAfterShot(benchmark::State& state) {
+    AssetCache assets;
+    StaticLayer layer;
+    sf::RenderTexture target;
+    if (!makeBoardLayer(assets, layer) || !target.create(frameWidth, frameHeight)) {
+        state.SkipWithError("no render texture (no GL context?)");
+        return;
+    }
+    const BattleFixture battle(static_cast<int>(state.range(0)));
+    CellBatch cells;
+    cells.reserve(4 * 10 * 10);
+    uint64_t allocations = 0;
+    for (auto _ : state) {
+        const uint64_t before = allocationCount();
+        battle.fill(cells);
+        target.clear(sf::Color::Black);
+        target.draw(layer);
+        target.draw(cells);
+        target.display();
+        allocations += allocationCount() - before;
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.counters["allocs"] = benchmark::Counter(static_cast<double>(allocations), benchmark::Counter::kAvgIterations);
+}
+
+// Text of the battle screen, coordinate labels of both boards and two
+// button captions: batched: 0 draws an sf::Text per string, 1 one TextBatch
+void BM_LabelFrame(benchmark::State& state) {
+    AssetCache assets;
+    std::shared_ptr<const sf::Font> font = assets.font("arial.ttf");
+    sf::RenderTexture target;
+    if (!font || !target.create(frameWidth, frameHeight)) {
+        state.SkipWithError("no font or render texture (no GL context?)");
+        return;
+    }
+    TextBatch batch(font);
+    for (const BoardLayout* layout : { &playerLayout, &opponentLayout }) {
+        addCoordinateLabels(batch, *layout);
+    }
+    std::vector<sf::Text> texts;
+    for (const BoardLayout* layout : { &playerLayout, &opponentLayout }) {
+        for (int i = 0; i < layout->cols; ++i) {
+            texts.emplace_back(std::string(1, static_cast<char>('A' + i)), *font, 20);
+            texts.back().setPosition(layout->left + i * layout->cellWidth, layout->top - 30);
+        }
+        for (int i = 0; i < layout->rows; ++i) {
+            texts.emplace_back(std::to_string(i + 1), *font, 20);
+            texts.back().setPosition(layout->left - 20, layout->top + i * layout->cellHeight);
+        }
+    }
+    // The buttons, each a background and a caption
+    std::vector<sf::RectangleShape> backgrounds;
+    const char* captions[] = { "Pause", "Exit" };
+    for (int i = 0; i < 2; ++i) {
+        const sf::FloatRect area(frameWidth / 2.0f - 50, frameHeight / 2.0f - 65 + 100 * i, 100, 30);
+        batch.addRect(area, sf::Color(0, 0, 0, 150));
+        batch.addText(captions[i], sf::Vector2f(area.left + 50, area.top + 15), 24, sf::Color::White);
+        backgrounds.emplace_back(sf::Vector2f(area.width, area.height));
+        backgrounds.back().setPosition(area.left, area.top);
+        backgrounds.back().setFillColor(sf::Color(0, 0, 0, 150));
+        texts.emplace_back(captions[i], *font, 24);
+        texts.back().setPosition(area.left + 20, area.top);
+    }
+    const bool batched = state.range(0) != 0;
+    for (auto _ : state) {
+        target.clear(sf::Color::Black);
+        if (batched) {
+            target.draw(batch);
+        }
+        else {
+            for (const sf::RectangleShape& background : backgrounds) {
+                target.draw(background);
+            }
+            for (const sf::Text& text : texts) {
+                target.draw(text);
+            }
+        }
+        target.display();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Board image into pixels, no GL: decoded: 0 decodes the PNG, 1 maps the
+// decoded cache instead
+void BM_DecodeBoardImage(benchmark::State& state) {
+    const EmbeddedAsset* png = findEmbeddedAsset("field.png");
+    if (!png) {
+        state.SkipWithError("field.png is not embedded in this build");
+        return;
+    }
+    const std::string cachePath = "bench-field.png.sbt";
+    sf::Image image;
+    if (!image.loadFromMemory(png->data, png->size) || !saveDecodedImage(cachePath, png->data, png->size, image)) {
+        state.SkipWithError("cannot write the decoded cache");
+        return;
+    }
+    const bool decoded = state.range(0) != 0;
+    for (auto _ : state) {
+        const bool ok = decoded ? loadDecodedImage(cachePath, png->data, png->size, image) : image.loadFromMemory(png->data, png->size);
+        benchmark::DoNotOptimize(ok);
+    }
+    std::remove(cachePath.c_str());
+    state.SetItemsProcessed(state.iterations());
+}
+
+// Hover lookup with `targets` buttons spread over the battle window, no GL:
+// the cost should stay flat as targets are added
+void BM_HitTest(benchmark::State& state) {
+    const int count = static_cast<int>(state.range(0));
+    const int perRow = 40;
+    const float width = static_cast<float>(frameWidth) / perRow;
+    const float height = static_cast<float>(frameHeight) / (count / perRow + 1);
+    HitGrid grid;
+    for (int i = 0; i < count; ++i) {
+        grid.add(sf::FloatRect((i % perRow) * width, (i / perRow) * height, width * 0.8f, height * 0.8f));
+    }
+    std::vector<sf::Vector2f> points;
+    for (unsigned i = 0; i < 256; ++i) {
+        points.push_back(sf::Vector2f(static_cast<float>((i * 7919) % frameWidth), static_cast<float>((i * 104729) % frameHeight)));
+    }
+    grid.at(points[0]);
+    size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(grid.at(points[i++ & 255]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+}
+
+BENCHMARK(BM_DecodeBoardImage)->ArgName("decoded")->Arg(0)->Arg(1);
+BENCHMARK(BM_BoardFrame)->ArgName("shots")->Arg(0)->Arg(40)->Arg(80);
+BENCHMARK(BM_BoardFrameAfterShot)->ArgName("shots")->Arg(0)->Arg(40)->Arg(80);
+BENCHMARK(BM_LabelFrame)->ArgName("batched")->Arg(0)->Arg(1);
+BENCHMARK(BM_HitTest)->ArgName("targets")->Arg(10)->Arg(100)->Arg(1000);
@@ -0,0 +1,308 @@
+#include "Replay.h"
+#include <algorithm>
+#include <memory>
+#include "FleetBatch.h"
+#include "ThreadPool.h"
+
+namespace {
+
+const char replayMagic[4] = { 'S', 'B', 'R', '1' };
+
+// Matches per pool task, and tasks in flight before their output is written
+const uint64_t matchesPerTask = 256;
+const uint64_t tasksPerWave = 64;
+
+uint16_t readUint16(const uint8_t* data) {
+    return static_cast<uint16_t>(data[0] | (data[1] << 8));
+}
+
+uint64_t readUint64(const uint8_t* data) {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+        value = (value << 8) | data[i];
+    }
+    return value;
+}
+
+void appendUint16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>(value & 0xFF));
+    out.push_back(static_cast<char>(value >> 8));
+}
+
+}
+
+bool ReplayWriter::open(const std::string& path, int rows, int cols, const std::vector<int>& shipLengths) {
+    if (rows <= 0 || cols <= 0 || rows * cols > 256 || shipLengths.size() > 255) {
+        return false;
+    }
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        return false;
+    }
+    colCount = cols;
+    buffer.assign(replayMagic, sizeof(replayMagic));
+    buffer.push_back(static_cast<char>(rows));
+    buffer.push_back(static_cast<char>(cols));
+    buffer.push_back(static_cast<char>(shipLengths.size()));
+    for (int length : shipLengths) {
+        buffer.push_back(static_cast<char>(length));
+    }
+    return true;
+}
+
+bool ReplayWriter::write(const ReplayGame& game) {
+    appendRecord(buffer, game, colCount);
+    if (buffer.size() >= (1u << 16)) {
+        out.write(buffer.data(), buffer.size());
+        buffer.clear();
+    }
+    return static_cast<bool>(out);
+}
+
+bool ReplayWriter::writeRecords(const std::string& records) {
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+    out.write(records.data(), records.size());
+    return static_cast<bool>(out);
+}
+
+bool ReplayWriter::close() {
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+    out.close();
+    return static_cast<bool>(out);
+}
+
+void ReplayWriter::appendRecord(std::string& out, const ReplayGame& game, int cols) {
+    for (int i = 0; i < 8; ++i) {
+        out.push_back(static_cast<char>((game.seed >> (8 * i)) & 0xFF));
+    }
+    out.push_back(static_cast<char>(game.firstSide));
+    appendUint16(out, static_cast<uint16_t>(game.shots.size()));
+    for (const auto& fleet : game.fleets) {
+        for (const auto& ship : fleet) {
+            uint16_t value = static_cast<uint16_t>(ship.startRow * cols + ship.startCol);
+            if (ship.direction == ShipDirection::VERTICAL) {
+                value |= 0x8000;
+            }
+            appendUint16(out, value);
+        }
+    }
+    out.append(reinterpret_cast<const char*>(game.shots.data()), game.shots.size());
+}
+
+bool ReplayLog::open(const std::string& path, std::string& error) {
+    if (!file.open(path)) {
+        error = "cannot open " + path;
+        return false;
+    }
+    const uint8_t* data = file.data();
+    if (file.size() < 7 || !std::equal(replayMagic, replayMagic + 4, data)) {
+        error = path + " is not a replay log";
+        return false;
+    }
+    rowCount = data[4];
+    colCount = data[5];
+    const int shipCount = data[6];
+    if (file.size() < 7u + shipCount || rowCount == 0 || colCount == 0) {
+        error = path + ": bad header";
+        return false;
+    }
+    lengths.assign(data + 7, data + 7 + shipCount);
+    dataStart = 7 + shipCount;
+    return true;
+}
+
+bool ReplayLog::next(size_t& cursor, ReplayRecord& record) const {
+    const size_t fleetBytes = 2 * lengths.size();
+    const size_t left = file.size() - std::min(file.size(), dataStart + cursor);
+    if (left < replayRecordHeaderSize + 2 * fleetBytes) {
+        return false;
+    }
+    const uint8_t* data = file.data() + dataStart + cursor;
+    record.seed = readUint64(data);
+    record.firstSide = data[8] & 1;
+    record.shotCount = readUint16(data + 9);
+    record.fleets[0] = data + replayRecordHeaderSize;
+    record.fleets[1] = record.fleets[0] + fleetBytes;
+    record.shots = record.fleets[1] + fleetBytes;
+    const size_t size = replayRecordHeaderSize + 2 * fleetBytes + record.shotCount;
+    if (left < size) {
+        return false;
+    }
+    cursor += size;
+    return true;
+}
+
+void ReplayLog::fleet(const ReplayRecord& record, int side, std::vector<Ship>& ships) const {
+    ships.resize(lengths.size());
+    for (size_t i = 0; i < lengths.size(); ++i) {
+        const uint16_t value = readUint16(record.fleets[side] + 2 * i);
+        const int cell = value & 0x7FFF;
+        ships[i] = { lengths[i], cell / colCount, cell % colCount,
+                     (value & 0x8000) ? ShipDirection::VERTICAL : ShipDirection::HORIZONTAL };
+    }
+}
+
+ReplayPlayer::ReplayPlayer(int rows, int cols)
+    : fleets{ FleetState(rows, cols), FleetState(rows, cols) } {
+    fired[0].assign(rows * cols, 0);
+    fired[1].assign(rows * cols, 0);
+}
+
+void ReplayPlayer::start(const ReplayLog& log, const ReplayRecord& record) {
+    if (fleets[0].rows() != log.rows() || fleets[0].cols() != log.cols()) {
+        fleets[0] = FleetState(log.rows(), log.cols());
+        fleets[1] = FleetState(log.rows(), log.cols());
+    }
+    for (int i = 0; i < 2; ++i) {
+        log.fleet(record, i, ships);
+        fleets[i].setFleet(ships);
+        fired[i].assign(log.rows() * log.cols(), 0);
+    }
+    current = record;
+    side = record.firstSide;
+    won = -1;
+    played = 0;
+    badShot = false;
+}
+
+bool ReplayPlayer::step() {
+    if (won >= 0 || badShot || played >= current.shotCount) {
+        return false;
+    }
+    FleetState& target = fleets[1 - side];
+    const int cell = current.shots[played];
+    const int row = cell / target.cols();
+    const int col = cell % target.cols();
+    if (row >= target.rows() || fired[side][cell]) {
+        badShot = true;
+        return false;
+    }
+    fired[side][cell] = 1;
+    ++played;
+    const ShotResult result = target.fire(row, col);
+    if (target.defeated()) {
+        won = side;
+    }
+    else if (result == ShotResult::MISS) {
+        side = 1 - side;
+    }
+    return true;
+}
+
+int ReplayPlayer::finish() {
+    while (step()) {
+    }
+    return won;
+}
+
+int playMatch(Shooter* shooters[2], FleetState* fleets[2], int firstSide, std::vector<uint8_t>& shots) {
+    shooters[0]->reset();
+    shooters[1]->reset();
+    int side = firstSide;
+    int row = 0;
+    int col = 0;
+    while (shooters[side]->chooseTarget(row, col)) {
+        FleetState& target = *fleets[1 - side];
+        const ShotResult result = target.fire(row, col);
+        shooters[side]->recordShot(row, col, result);
+        shots.push_back(static_cast<uint8_t>(row * target.cols() + col));
+        if (target.defeated()) {
+            return side;
+        }
+        if (result == ShotResult::MISS) {
+            side = 1 - side;
+        }
+    }
+    return -1;
+}
+
+bool recordMatches(const ReplayRecordOptions& options, const std::string& path, std::string& error) {
+    if (options.rules.shipsMayTouch) {
+        error = "replay logs only hold games where ships may not touch";
+        return false;
+    }
+    const Rules& rules = options.rules;
+    ReplayWriter writer;
+    if (!writer.open(path, rules.rows, rules.cols, rules.shipLengths)) {
+        error = "cannot write " + path + " (boards are limited to 256 cells)";
+        return false;
+    }
+
+    ThreadPool pool(options.threads);
+    // Per-worker generator, shooters and fleets, built once
+    struct WorkerState {
+        std::unique_ptr<FleetGenerator> generator;
+        std::unique_ptr<Shooter> shooters[2];
+        std::unique_ptr<FleetState> fleets[2];
+        std::vector<ShipPlacement> placements;
+        ReplayGame game;
+        bool failed = false;
+    };
+    std::vector<WorkerState> workers(pool.size());
+    for (auto& worker : workers) {
+        worker.generator = std::make_unique<FleetGenerator>(rules, 0);
+        for (int side = 0; side < 2; ++side) {
+            worker.shooters[side] = makeShooter(options.shooter, rules, 0);
+            worker.fleets[side] = std::make_unique<FleetState>(rules.rows, rules.cols);
+        }
+    }
+
+    // Tasks of a wave write into their own slot; slots go to disk in order
+    std::vector<std::string> slots(tasksPerWave);
+    const uint64_t taskCount = (options.games + matchesPerTask - 1) / matchesPerTask;
+    for (uint64_t firstTask = 0; firstTask < taskCount; firstTask += tasksPerWave) {
+        const uint64_t lastTask = std::min(firstTask + tasksPerWave, taskCount);
+        for (uint64_t task = firstTask; task < lastTask; ++task) {
+            pool.submit([&, task, firstTask](unsigned index) {
+                WorkerState& worker = workers[index];
+                std::string& out = slots[task - firstTask];
+                out.clear();
+                const uint64_t last = std::min((task + 1) * matchesPerTask, options.games);
+                for (uint64_t match = task * matchesPerTask; match < last; ++match) {
+                    ReplayGame& game = worker.game;
+                    game.seed = fleetSeed(options.seed, match);
+                    uint64_t stream = game.seed;
+                    for (int side = 0; side < 2; ++side) {
+                        worker.generator->reseed(Rng::splitMix64(stream));
+                        if (worker.generator->generate(worker.placements) != FleetResult::OK) {
+                            worker.failed = true;
+                            return;
+                        }
+                        game.fleets[side].clear();
+                        for (const auto& ship : worker.placements) {
+                            game.fleets[side].push_back({ ship.length, ship.row, ship.col, ship.direction });
+                        }
+                        worker.fleets[side]->setFleet(game.fleets[side]);
+                        worker.shooters[side]->reseed(Rng::splitMix64(stream));
+                    }
+                    game.firstSide = static_cast<int>(Rng::splitMix64(stream) & 1);
+                    game.shots.clear();
+                    Shooter* shooters[2] = { worker.shooters[0].get(), worker.shooters[1].get() };
+                    FleetState* fleets[2] = { worker.fleets[0].get(), worker.fleets[1].get() };
+                    playMatch(shooters, fleets, game.firstSide, game.shots);
+                    ReplayWriter::appendRecord(out, game, rules.cols);
+                }
+            });
+        }
+        pool.wait();
+        for (const auto& worker : workers) {
+            if (worker.failed) {
+                error = "no layout found for the fleet on a " + std::to_string(rules.rows) + "x" + std::to_string(rules.cols) + " board";
+                return false;
+            }
+        }
+        for (uint64_t task = firstTask; task < lastTask; ++task) {
+            if (!writer.writeRecords(slots[task - firstTask])) {
+                error = "error writing " + path;
+                return false;
+            }
+        }
+    }
+    if (!writer.close()) {
+        error = "error writing " + path;
+        return false;
+    }
+    return true;
+}
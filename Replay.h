@@ -0,0 +1,134 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "FleetGenerator.h"
+#include "GameState.h"
+#include "MappedFile.h"
+#include "Simulator.h"
+
+// Binary match log ("SBR1"), little-endian:
+//
+//   header  "SBR1", rows, cols, ship count, ship lengths (one byte each)
+//   record  seed (8 bytes), first side (1), shot count (2),
+//           fleet of side 0 then side 1: 2 bytes per ship in header order,
+//           row * cols + col, bit 15 set for vertical (as in FleetBatch),
+//           shots: one byte each, row * cols + col
+//
+// Whose shot it is follows from the rules (a hit keeps the turn), so it is
+// not stored. Boards are limited to 256 cells.
+const size_t replayRecordHeaderSize = 11;
+
+// One complete match
+struct ReplayGame {
+    uint64_t seed = 0;              // the fleets and shooters derive from it
+    int firstSide = 0;
+    std::vector<Ship> fleets[2];    // fleets[i] belongs to side i, in the header's ship order
+    std::vector<uint8_t> shots;
+};
+
+class ReplayWriter {
+public:
+    bool open(const std::string& path, int rows, int cols, const std::vector<int>& shipLengths);
+    // Buffered; call close() to flush
+    bool write(const ReplayGame& game);
+    // Records already encoded with appendRecord()
+    bool writeRecords(const std::string& records);
+    bool close();
+
+    static void appendRecord(std::string& out, const ReplayGame& game, int cols);
+
+private:
+    std::ofstream out;
+    std::string buffer;
+    int colCount = 0;
+};
+
+// A record inside a mapped log; points into the mapping
+struct ReplayRecord {
+    uint64_t seed;
+    int firstSide;
+    int shotCount;
+    const uint8_t* fleets[2];
+    const uint8_t* shots;
+};
+
+// Memory-mapped log. Records are only decoded when visited:
+//
+//     size_t cursor = 0;
+//     ReplayRecord record;
+//     while (log.next(cursor, record)) { ... }
+class ReplayLog {
+public:
+    bool open(const std::string& path, std::string& error);
+
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+    const std::vector<int>& shipLengths() const { return lengths; }
+    size_t sizeBytes() const { return file.size(); }
+
+    // Record at `cursor` (0 = the first); advances the cursor. False at the
+    // end of the log, or if the record there is cut off (then !atEnd()).
+    bool next(size_t& cursor, ReplayRecord& record) const;
+    bool atEnd(size_t cursor) const { return dataStart + cursor >= file.size(); }
+    void fleet(const ReplayRecord& record, int side, std::vector<Ship>& ships) const;
+
+private:
+    MappedFile file;
+    size_t dataStart = 0;
+    int rowCount = 0;
+    int colCount = 0;
+    std::vector<int> lengths;
+};
+
+// Steps through a recorded match on two FleetStates. Nothing is allocated
+// per match once the first one has been loaded.
+class ReplayPlayer {
+public:
+    ReplayPlayer(int rows, int cols);
+
+    void start(const ReplayLog& log, const ReplayRecord& record);
+    // Plays the next shot; false once the match is over or out of shots
+    bool step();
+    // Plays every remaining shot and returns the winner, -1 if none
+    int finish();
+
+    // Side to shoot next
+    int turn() const { return side; }
+    int winner() const { return won; }
+    int shotsPlayed() const { return played; }
+    int shotCount() const { return current.shotCount; }
+    // Fleet of side i and every shot taken at it
+    const FleetState& fleet(int i) const { return fleets[i]; }
+    // An out-of-board or repeated shot was found; playback stops there
+    bool invalid() const { return badShot; }
+
+private:
+    FleetState fleets[2];
+    // Cells side i has fired at. Not the marks: a computer may fire into
+    // water a sinking already marked, which is no repeated shot.
+    std::vector<uint8_t> fired[2];
+    std::vector<Ship> ships;
+    ReplayRecord current = {};
+    int side = 0;
+    int won = -1;
+    int played = 0;
+    bool badShot = false;
+};
+
+struct ReplayRecordOptions {
+    Rules rules;   // no-touch only: the log does not store the touching rule
+    uint64_t seed = 0;
+    uint64_t games = 0;
+    unsigned threads = 0;   // 0 - one per hardware thread
+    ShooterKind shooter = ShooterKind::PROBABILITY;
+};
+
+// Computer against computer, `games` matches on all cores, written in index
+// order. Match i is seeded with fleetSeed(seed, i) whatever the thread count.
+bool recordMatches(const ReplayRecordOptions& options, const std::string& path, std::string& error);
+
+// One match: shooters[i] fires at fleets[1 - i], a hit keeps the turn.
+// Appends every shot to `shots` and returns the winning side.
+int playMatch(Shooter* shooters[2], FleetState* fleets[2], int firstSide, std::vector<uint8_t>& shots);
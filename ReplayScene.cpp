@@ -0,0 +1,166 @@
+#include "ReplayScene.h"
+#include <algorithm>
+#include <iostream>
+#include "GameScene.h"
+
+namespace {
+
+// Shots per second
+const float speeds[] = { 1.0f, 2.0f, 5.0f, 10.0f, 25.0f, 100.0f };
+const int speedCount = sizeof(speeds) / sizeof(speeds[0]);
+const int defaultSpeed = 2;
+
+}
+
+ReplayScene::ReplayScene(SceneStack& stack, std::string path)
+    : Scene(stack),
+      path(std::move(path)),
+      font(stack.assets().font("arial.ttf")),
+      player(battleBoardLayout(0).rows, battleBoardLayout(0).cols),
+      speedIndex(defaultSpeed),
+      text(font) {
+}
+
+sf::Vector2u ReplayScene::size() const {
+    return battleWindowSize();
+}
+
+bool ReplayScene::load() {
+    std::string error;
+    if (!log.open(path, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return false;
+    }
+    const BoardLayout& layout = battleBoardLayout(0);
+    if (log.rows() != layout.rows || log.cols() != layout.cols) {
+        std::cerr << "Error: " << path << " is a " << log.rows() << "x" << log.cols() << " log, the board shows "
+                  << layout.rows << "x" << layout.cols << std::endl;
+        return false;
+    }
+    if (!nextMatch()) {
+        std::cerr << "Error: " << path << " holds no matches" << std::endl;
+        return false;
+    }
+
+    std::shared_ptr<const sf::Texture> boardTexture = stack.assets().texture("field.png");
+    const sf::Vector2u windowSize = battleWindowSize();
+    if (!boardTexture || !boardLayer.create(windowSize.x, windowSize.y)) {
+        std::cerr << "Error creating board layer!" << std::endl;
+        return false;
+    }
+    for (int side = 0; side < 2; ++side) {
+        drawBoardImage(boardLayer.canvas(), *boardTexture, battleBoardLayout(side));
+    }
+    boardLayer.finish();
+
+    // Worst case on both boards: every cell a ship (outline and fill) plus a mark
+    cells.reserve(2 * 3 * layout.rows * layout.cols);
+    return true;
+}
+
+bool ReplayScene::playing() const {
+    return !paused && player.winner() < 0 && !player.invalid() && player.shotsPlayed() < player.shotCount();
+}
+
+bool ReplayScene::nextMatch() {
+    ReplayRecord record;
+    if (!log.next(cursor, record)) {
+        cursor = 0;
+        matchNumber = 0;
+        if (!log.next(cursor, record)) {
+            return false;
+        }
+    }
+    player.start(log, record);
+    ++matchNumber;
+    pendingShots = 0;
+    clock.restart();
+    boardChanged = true;
+    return true;
+}
+
+void ReplayScene::handleEvent(const sf::Event& event) {
+    if (event.type != sf::Event::KeyPressed) {
+        return;
+    }
+    switch (event.key.code) {
+    case sf::Keyboard::Escape:
+        stack.pop();
+        break;
+    case sf::Keyboard::Space:
+        paused = !paused;
+        clock.restart();
+        boardChanged = true;
+        break;
+    case sf::Keyboard::Right:
+        if (paused && player.step()) {
+            boardChanged = true;
+        }
+        break;
+    case sf::Keyboard::Up:
+        speedIndex = std::min(speedIndex + 1, speedCount - 1);
+        boardChanged = true;
+        break;
+    case sf::Keyboard::Down:
+        speedIndex = std::max(speedIndex - 1, 0);
+        boardChanged = true;
+        break;
+    case sf::Keyboard::End:
+        player.finish();
+        boardChanged = true;
+        break;
+    case sf::Keyboard::N:
+        nextMatch();
+        break;
+    default:
+        break;
+    }
+}
+
+void ReplayScene::bakeText() {
+    std::string status = "Match " + std::to_string(matchNumber) + "   shot " + std::to_string(player.shotsPlayed()) + "/"
+        + std::to_string(player.shotCount()) + "   " + std::to_string(static_cast<int>(speeds[speedIndex])) + " shots/s";
+    if (player.winner() >= 0) {
+        status += player.winner() == 0 ? "   left wins" : "   right wins";
+    }
+    else if (player.invalid()) {
+        status += "   bad shot in log";
+    }
+    else if (paused) {
+        status += "   paused";
+    }
+    text.clear();
+    for (int side = 0; side < 2; ++side) {
+        addCoordinateLabels(text, battleBoardLayout(side));
+    }
+    text.addText(status, sf::Vector2f(battleWindowSize().x / 2.0f, battleWindowSize().y - 25.0f), 20, sf::Color::White);
+}
+
+void ReplayScene::draw(sf::RenderWindow& window) {
+    const float elapsed = clock.restart().asSeconds();
+    if (playing()) {
+        pendingShots += elapsed * speeds[speedIndex];
+        while (pendingShots >= 1.0f && player.step()) {
+            pendingShots -= 1.0f;
+            boardChanged = true;
+        }
+    }
+    // Frames keep coming only while shots are due; a paused or finished
+    // replay idles like every other screen
+    stack.frames().setAnimating(playing());
+
+    if (boardChanged) {
+        cells.clear();
+        for (int side = 0; side < 2; ++side) {
+            cells.addShips(battleBoardLayout(side), player.fleet(side).ships());
+            // Shots at a fleet are drawn on that fleet's board
+            cells.addMarks(battleBoardLayout(side), player.fleet(side));
+        }
+        cells.commit();
+        bakeText();
+        boardChanged = false;
+    }
+    window.draw(boardLayer);
+    window.draw(cells);
+    window.draw(text);
+}
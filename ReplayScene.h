@@ -0,0 +1,52 @@
+#pragma once
+#include <memory>
+#include <string>
+#include "BoardRenderer.h"
+#include "Replay.h"
+#include "Scene.h"
+
+// Where GameScene saves the last game against the computer
+const char* const lastGameReplay = "last_game.sbr";
+
+// Plays a replay log back on the battle screen with both fleets shown.
+// Space pauses, Right steps one shot while paused, Up/Down change the
+// speed, End finishes the match, N goes to the next one, Escape leaves.
+class ReplayScene : public Scene {
+public:
+    ReplayScene(SceneStack& stack, std::string path);
+
+    sf::Vector2u size() const override;
+    std::string title() const override { return "Sea Battle - Replay"; }
+
+    bool load() override;
+    void handleEvent(const sf::Event& event) override;
+    void draw(sf::RenderWindow& window) override;
+
+private:
+    std::string path;
+    std::shared_ptr<const sf::Font> font;
+
+    ReplayLog log;
+    ReplayPlayer player;
+    size_t cursor = 0;
+    int matchNumber = 0;
+
+    int speedIndex;
+    bool paused = false;
+    sf::Clock clock;
+    float pendingShots = 0;   // shots owed at the current speed, fractional
+
+    // Board images never change: baked once in load()
+    StaticLayer boardLayer;
+    // Ships and shot marks, rebuilt only after a shot
+    CellBatch cells;
+    // Coordinate labels and the status line, rebuilt with the cells
+    TextBatch text;
+    bool boardChanged = true;
+
+    bool playing() const;
+    // Starts the next match, wrapping around at the end of the log
+    bool nextMatch();
+    // Labels and the status line
+    void bakeText();
+};
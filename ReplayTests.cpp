@@ -0,0 +1,125 @@
+// recordMatches -> ReplayLog -> ReplayPlayer: every match played back from
+// the log must end as it did when it was played, with the same fleets,
+// winner and shots, whatever the number of recording threads.
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FleetBatch.h"
+#include "FleetGenerator.h"
+#include "GameState.h"
+#include "Replay.h"
+#include "Simulator.h"
+#include "TestCheck.h"
+
+namespace {
+
+// One match as recordMatches plays it
+struct Match {
+    std::vector<Ship> fleets[2];
+    int winner;
+    std::vector<uint8_t> shots;
+};
+
+Match playAgain(const ReplayRecordOptions& options, uint64_t index) {
+    const Rules& rules = options.rules;
+    FleetGenerator generator(rules, 0);
+    std::unique_ptr<Shooter> shooters[2] = { makeShooter(options.shooter, rules, 0), makeShooter(options.shooter, rules, 0) };
+    FleetState fleets[2] = { FleetState(rules.rows, rules.cols), FleetState(rules.rows, rules.cols) };
+    Match match;
+    uint64_t stream = fleetSeed(options.seed, index);
+    std::vector<ShipPlacement> placements;
+    for (int side = 0; side < 2; ++side) {
+        generator.reseed(Rng::splitMix64(stream));
+        CHECK(generator.generate(placements) == FleetResult::OK);
+        for (const auto& ship : placements) {
+            match.fleets[side].push_back({ ship.length, ship.row, ship.col, ship.direction });
+        }
+        fleets[side].setFleet(match.fleets[side]);
+        shooters[side]->reseed(Rng::splitMix64(stream));
+    }
+    const int firstSide = static_cast<int>(Rng::splitMix64(stream) & 1);
+    Shooter* shooterPointers[2] = { shooters[0].get(), shooters[1].get() };
+    FleetState* fleetPointers[2] = { &fleets[0], &fleets[1] };
+    match.winner = playMatch(shooterPointers, fleetPointers, firstSide, match.shots);
+    return match;
+}
+
+bool sameShips(const std::vector<Ship>& a, const std::vector<Ship>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].length != b[i].length || a[i].startRow != b[i].startRow || a[i].startCol != b[i].startCol || a[i].direction != b[i].direction) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string readFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void checkRecording(ShooterKind shooter, const Rules& rules) {
+    ReplayRecordOptions options;
+    options.rules = rules;
+    options.seed = 42;
+    options.games = 40;
+    options.threads = 1;
+    options.shooter = shooter;
+    const std::string path = "replay-test.sbr";
+    const std::string threadedPath = "replay-test-threads.sbr";
+    std::string error;
+    CHECK(recordMatches(options, path, error));
+    options.threads = 3;
+    CHECK(recordMatches(options, threadedPath, error));
+    CHECK(readFile(path) == readFile(threadedPath));
+
+    ReplayLog log;
+    CHECK(log.open(path, error));
+    CHECK(log.rows() == rules.rows && log.cols() == rules.cols && log.shipLengths() == rules.shipLengths);
+    ReplayPlayer player(rules.rows, rules.cols);
+    ReplayRecord record;
+    std::vector<Ship> ships;
+    size_t cursor = 0;
+    uint64_t index = 0;
+    while (log.next(cursor, record)) {
+        const Match match = playAgain(options, index++);
+        CHECK(record.seed == fleetSeed(options.seed, index - 1));
+        for (int side = 0; side < 2; ++side) {
+            log.fleet(record, side, ships);
+            CHECK(sameShips(ships, match.fleets[side]));
+        }
+        CHECK(record.shotCount == static_cast<int>(match.shots.size()));
+        CHECK(std::equal(match.shots.begin(), match.shots.end(), record.shots));
+
+        player.start(log, record);
+        const int winner = player.finish();
+        CHECK(winner == match.winner);
+        CHECK(!player.invalid());
+        CHECK(player.shotsPlayed() == player.shotCount() && player.shotsPlayed() == record.shotCount);
+        CHECK(winner >= 0 && player.fleet(1 - winner).defeated() && !player.fleet(winner).defeated());
+    }
+    CHECK(log.atEnd(cursor));
+    CHECK(index == options.games);
+    std::remove(path.c_str());
+    std::remove(threadedPath.c_str());
+}
+
+}
+
+int main() {
+    checkRecording(ShooterKind::PROBABILITY, Rules());
+    checkRecording(ShooterKind::RANDOM, Rules());
+    Rules small;
+    small.rows = 7;
+    small.cols = 9;
+    small.shipLengths = { 3, 2, 2, 1 };
+    checkRecording(ShooterKind::DENSITY, small);
+    return testResult();
+}
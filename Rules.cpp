@@ -0,0 +1,37 @@
+#include "Rules.h"
+#include <algorithm>
+
+const std::vector<int>& standardFleet() {
+    static const std::vector<int> fleet = { 4, 3, 3, 2, 2, 2, 1, 1, 1, 1 };
+    return fleet;
+}
+
+int Rules::maxShipLength() const {
+    return shipLengths.empty() ? 0 : *std::max_element(shipLengths.begin(), shipLengths.end());
+}
+
+bool Rules::check(std::string& error) const {
+    if (rows <= 0 || cols <= 0 || rows > maxSize || cols > maxSize) {
+        error = "boards are 1x1 to " + std::to_string(maxSize) + "x" + std::to_string(maxSize) + ", not "
+                + std::to_string(rows) + "x" + std::to_string(cols);
+        return false;
+    }
+    if (shipLengths.empty()) {
+        error = "the fleet has no ships";
+        return false;
+    }
+    long long fleetCells = 0;
+    for (int length : shipLengths) {
+        if (length <= 0 || length > std::max(rows, cols)) {
+            error = "a ship of length " + std::to_string(length) + " does not fit a " + std::to_string(rows) + "x"
+                    + std::to_string(cols) + " board";
+            return false;
+        }
+        fleetCells += length;
+    }
+    if (fleetCells > cellCount()) {
+        error = "the fleet has " + std::to_string(fleetCells) + " cells, the board only " + std::to_string(cellCount());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// 1x4, 2x3, 3x2, 4x1
+const std::vector<int>& standardFleet();
+
+// Board size, fleet and touching rule of a game. Generators, shooters and
+// screens take their dimensions from here instead of assuming the classic
+// 10x10 game, which is what a default-constructed Rules describes.
+struct Rules {
+    static constexpr int maxSize = 100;
+
+    int rows = 10;
+    int cols = 10;
+    std::vector<int> shipLengths = standardFleet();
+    // Classic rules: ships may not touch, not even diagonally
+    bool shipsMayTouch = false;
+
+    int cellCount() const { return rows * cols; }
+    int maxShipLength() const;
+
+    // False, with the reason in `error`, for boards bigger than maxSize,
+    // ships that do not fit the board or a fleet with more cells than the
+    // board. A fleet that passes may still have no layout.
+    bool check(std::string& error) const;
+};
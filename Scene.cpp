@@ -0,0 +1,144 @@
+#include "Scene.h"
+#include <iostream>
+#include "Profiler.h"
+
+namespace {
+
+const char* const traceFile = "trace.json";
+
+}
+
+SceneStack::SceneStack(sf::RenderWindow& window, AssetCache& assets, const Rules& rules)
+    : renderWindow(window), assetCache(assets), gameRules(rules), frameLoop(window) {
+}
+
+void SceneStack::push(std::unique_ptr<Scene> scene) {
+    pending.push_back({ ChangeType::PUSH, std::move(scene) });
+}
+
+void SceneStack::pop() {
+    pending.push_back({ ChangeType::POP, nullptr });
+}
+
+void SceneStack::replace(std::unique_ptr<Scene> scene) {
+    pending.push_back({ ChangeType::REPLACE, std::move(scene) });
+}
+
+void SceneStack::run() {
+    Profiler::setThreadName("render");
+    applyChanges();
+    while (renderWindow.isOpen() && !scenes.empty()) {
+        sf::Event event;
+        while (frameLoop.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) {
+                renderWindow.close();
+                break;
+            }
+            if (handleProfilerKey(event)) {
+                continue;
+            }
+            {
+                ProfileScope scope("Scene::handleEvent");
+                scenes.back()->pointerInput().handleEvent(event);
+                scenes.back()->handleEvent(event);
+            }
+            applyChanges();
+            if (scenes.empty()) {
+                renderWindow.close();
+                break;
+            }
+        }
+
+        // Nothing changed since the last frame: skip drawing, the next pollEvent waits
+        if (!frameLoop.beginFrame()) {
+            continue;
+        }
+        Scene& top = *scenes.back();
+        top.pointerInput().update();
+        renderWindow.clear(top.background());
+        {
+            ProfileScope scope("Scene::draw");
+            top.draw(renderWindow);
+        }
+        renderWindow.draw(overlay);
+        frameLoop.endFrame();
+        overlay.frameDone(frameLoop.stats());
+
+        // A scene may also change the stack while drawing (LoadingScene)
+        applyChanges();
+        if (scenes.empty()) {
+            renderWindow.close();
+        }
+    }
+}
+
+bool SceneStack::handleProfilerKey(const sf::Event& event) {
+    if (event.type != sf::Event::KeyPressed) {
+        return false;
+    }
+    if (event.key.code == sf::Keyboard::F3) {
+        // Looked up on first use: at startup the font is still loading
+        if (!overlayFontSet) {
+            overlay.setFont(assetCache.font("arial.ttf"));
+            overlayFontSet = true;
+        }
+        overlay.setVisible(!overlay.visible());
+    }
+    else if (event.key.code == sf::Keyboard::F4) {
+        if (!capturing) {
+            captureStart = Profiler::now();
+            std::cout << "Profiling... press F4 again to write " << traceFile << std::endl;
+        }
+        else if (Profiler::writeChromeTrace(traceFile, captureStart)) {
+            std::cout << "Profile written to " << traceFile << std::endl;
+        }
+        else {
+            std::cerr << "Error writing " << traceFile << std::endl;
+        }
+        capturing = !capturing;
+    }
+    else {
+        return false;
+    }
+    // Scopes are only timed while someone looks at them
+    Profiler::setEnabled(overlay.visible() || capturing);
+    frameLoop.requestRedraw();
+    return true;
+}
+
+void SceneStack::applyChanges() {
+    if (pending.empty()) {
+        return;
+    }
+    Scene* oldTop = scenes.empty() ? nullptr : scenes.back().get();
+    // Taken out first: loading a scene may queue further changes
+    std::vector<Change> changes;
+    changes.swap(pending);
+    for (auto& change : changes) {
+        if (change.type != ChangeType::POP && !change.scene->load()) {
+            continue;
+        }
+        if (change.type != ChangeType::PUSH && !scenes.empty()) {
+            scenes.pop_back();
+        }
+        if (change.scene) {
+            scenes.push_back(std::move(change.scene));
+        }
+    }
+    if (!scenes.empty() && scenes.back().get() != oldTop) {
+        activate(*scenes.back());
+    }
+}
+
+void SceneStack::activate(Scene& scene) {
+    const sf::Vector2u size = scene.size();
+    if (renderWindow.getSize() != size) {
+        renderWindow.setSize(size);
+    }
+    // Scenes lay out in pixels of their own size
+    renderWindow.setView(sf::View(sf::FloatRect(0, 0, static_cast<float>(size.x), static_cast<float>(size.y))));
+    renderWindow.setTitle(scene.title());
+    // A new top scene starts idle; animated scenes turn animation on as they draw
+    frameLoop.setAnimating(false);
+    frameLoop.requestRedraw();
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+#include "AssetCache.h"
+#include "FrameLoop.h"
+#include "InputLayer.h"
+#include "PerformanceOverlay.h"
+#include "Rules.h"
+
+class SceneStack;
+
+// One screen of the game (menu, ship placement, battle). All scenes share the
+// single window, GL context and AssetCache owned by the SceneStack; the top
+// scene gets the events and is drawn.
+class Scene {
+public:
+    explicit Scene(SceneStack& stack) : stack(stack) {}
+    virtual ~Scene() = default;
+
+    // Window size and title while this scene is on top
+    virtual sf::Vector2u size() const = 0;
+    virtual std::string title() const = 0;
+    virtual sf::Color background() const { return sf::Color::Black; }
+
+    // Creates the scene's GPU resources; a scene that fails to load is dropped
+    virtual bool load() { return true; }
+
+    virtual void handleEvent(const sf::Event& event) = 0;
+    virtual void draw(sf::RenderWindow& window) = 0;
+
+    // Buttons and boards the scene registered; the stack feeds it every
+    // event before handleEvent()
+    InputLayer& pointerInput() { return input; }
+
+protected:
+    SceneStack& stack;
+    InputLayer input;
+};
+
+// Owns the scenes and drives the shared frame loop. Screens are pushed,
+// popped or replaced instead of opening a nested window, so the call stack
+// stays flat no matter how many rounds are played.
+//
+// The rules (board size, fleet, touching) are fixed for the whole session.
+//
+// In any scene F3 toggles the performance overlay, and F4 starts a profile
+// capture and, pressed again, writes it to traceFile as Chrome trace JSON.
+class SceneStack {
+public:
+    SceneStack(sf::RenderWindow& window, AssetCache& assets, const Rules& rules);
+
+    // Applied once the current event or frame has been handled, so a scene
+    // can safely pop or replace itself from handleEvent() or draw()
+    void push(std::unique_ptr<Scene> scene);
+    void pop();
+    void replace(std::unique_ptr<Scene> scene);
+
+    // Runs until the window is closed or the last scene is popped
+    void run();
+
+    sf::RenderWindow& window() { return renderWindow; }
+    AssetCache& assets() { return assetCache; }
+    FrameLoop& frames() { return frameLoop; }
+    const Rules& rules() const { return gameRules; }
+
+private:
+    enum class ChangeType { PUSH, POP, REPLACE };
+    struct Change {
+        ChangeType type;
+        std::unique_ptr<Scene> scene;
+    };
+
+    sf::RenderWindow& renderWindow;
+    AssetCache& assetCache;
+    Rules gameRules;
+    FrameLoop frameLoop;
+    PerformanceOverlay overlay;
+    bool overlayFontSet = false;
+    bool capturing = false;
+    uint64_t captureStart = 0;
+    std::vector<std::unique_ptr<Scene>> scenes;
+    std::vector<Change> pending;
+
+    void applyChanges();
+    void activate(Scene& scene);
+    // F3 / F4; true if the key was taken
+    bool handleProfilerKey(const sf::Event& event);
+};
@@ -0,0 +1,556 @@
+// Headless command-line tools. Only serve and loadtest use SFML (network).
+//
+//   SeaBattleCli generate --count N [--seed S] [--fleet 4,3,3,2,2,2,1,1,1,1]
+//                         [--board 10x10] [--touch 0|1] [--threads T]
+//                         [--format text|binary] [--out FILE] [--uniform 0|1] [--tables FILE]
+//   SeaBattleCli simulate --games N [--seed S] [--shooter probability|density|endgame|random]
+//                         [--fleet ...] [--board 10x10] [--touch 0|1] [--threads T]
+//   SeaBattleCli record --games N --out FILE [--seed S] [--shooter probability|density|endgame|random]
+//                       [--fleet ...] [--board 10x10] [--threads T]
+//   SeaBattleCli replay --in FILE
+//   SeaBattleCli corpus --count N --out FILE [--seed S] [--fleet ...] [--board 10x10]
+//                       [--threads T] [--run-keys K]
+//   SeaBattleCli corpus-stats --in FILE [--threads T]
+//   SeaBattleCli corpus-lookup --in FILE [--layouts FILE]
+//   SeaBattleCli layouts [--fleet ...] [--board 10x10] [--tables FILE]
+//   SeaBattleCli serve [--port P] [--seed S] [--stats 0|1]
+//   SeaBattleCli loadtest [--host H] [--port P] [--local 0|1] [--connections C]
+//                         [--games-per-connection G] [--matches N]
+//                         [--opponent computer|player] [--seed S]
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include "FleetBatch.h"
+#include "FleetCorpus.h"
+#include "FleetSampler.h"
+#include "Replay.h"
+#include "Simulator.h"
+#ifndef SEA_BATTLE_NO_NETWORK
+#include "LoadTest.h"
+#include "NetServer.h"
+#endif
+
+namespace {
+
+void printUsage() {
+    std::cerr << "Usage:\n"
+              << "  SeaBattleCli generate --count N [--seed S] [--fleet 4,3,3,2,2,2,1,1,1,1]\n"
+              << "                        [--board 10x10] [--touch 0|1] [--threads T] [--format text|binary] [--out FILE]\n"
+              << "                        [--uniform 0|1] [--tables FILE]\n"
+              << "  SeaBattleCli simulate --games N [--seed S] [--shooter probability|density|endgame|random]\n"
+              << "                        [--fleet 4,3,3,2,2,2,1,1,1,1] [--board 10x10] [--touch 0|1] [--threads T]\n"
+              << "  SeaBattleCli record --games N --out FILE [--seed S] [--shooter probability|density|endgame|random]\n"
+              << "                      [--fleet 4,3,3,2,2,2,1,1,1,1] [--board 10x10] [--threads T]\n"
+              << "  SeaBattleCli replay --in FILE\n"
+              << "  SeaBattleCli corpus --count N --out FILE [--seed S] [--fleet 4,3,3,2,2,2,1,1,1,1] [--board 10x10]\n"
+              << "                      [--threads T] [--run-keys K]\n"
+              << "  SeaBattleCli corpus-stats --in FILE [--threads T]\n"
+              << "  SeaBattleCli corpus-lookup --in FILE [--layouts FILE]\n"
+              << "  SeaBattleCli layouts [--fleet 4,3,3,2,2,2,1,1,1,1] [--board 10x10] [--tables FILE]\n"
+              << "  SeaBattleCli serve [--port P] [--seed S] [--stats 0|1]\n"
+              << "  SeaBattleCli loadtest [--host H] [--port P] [--local 0|1] [--connections C]\n"
+              << "                        [--games-per-connection G] [--matches N]\n"
+              << "                        [--opponent computer|player] [--seed S]\n";
+}
+
+// "--name value" pairs after the command name
+bool parseOptions(int argc, char* argv[], std::map<std::string, std::string>& options) {
+    for (int i = 2; i < argc; i += 2) {
+        const std::string name = argv[i];
+        if (name.compare(0, 2, "--") != 0 || i + 1 >= argc) {
+            std::cerr << "Bad option: " << name << std::endl;
+            return false;
+        }
+        options[name.substr(2)] = argv[i + 1];
+    }
+    return true;
+}
+
+bool parseNumber(const std::map<std::string, std::string>& options, const std::string& name, uint64_t& value) {
+    auto it = options.find(name);
+    if (it == options.end()) {
+        return true;
+    }
+    try {
+        value = std::stoull(it->second);
+    }
+    catch (const std::exception&) {
+        std::cerr << "Bad value for --" << name << ": " << it->second << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// --fleet, --board and --touch
+bool parseRules(const std::map<std::string, std::string>& options, Rules& rules) {
+    auto it = options.find("fleet");
+    if (it != options.end() && !parseFleetSpec(it->second, rules.shipLengths)) {
+        std::cerr << "Bad fleet spec: " << it->second << std::endl;
+        return false;
+    }
+    it = options.find("board");
+    if (it != options.end() && !parseBoardSize(it->second, rules.rows, rules.cols)) {
+        std::cerr << "Bad board size: " << it->second << std::endl;
+        return false;
+    }
+    uint64_t touch = rules.shipsMayTouch ? 1 : 0;
+    if (!parseNumber(options, "touch", touch)) {
+        return false;
+    }
+    rules.shipsMayTouch = touch != 0;
+    std::string error;
+    if (!rules.check(error)) {
+        std::cerr << "Bad rules: " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+int runGenerate(const std::map<std::string, std::string>& options) {
+    FleetBatchOptions batch;
+    uint64_t threads = 0;
+    if (!parseNumber(options, "count", batch.count) || !parseNumber(options, "seed", batch.seed) || !parseNumber(options, "threads", threads)) {
+        return EXIT_FAILURE;
+    }
+    batch.threads = static_cast<unsigned>(threads);
+
+    if (!parseRules(options, batch.rules)) {
+        return EXIT_FAILURE;
+    }
+    // Exactly uniform layouts; the tables go to the working directory unless --tables names a file
+    uint64_t uniform = 0;
+    if (!parseNumber(options, "uniform", uniform)) {
+        return EXIT_FAILURE;
+    }
+    if (uniform != 0) {
+        auto tables = options.find("tables");
+        batch.uniformTables = tables != options.end() ? tables->second : FleetSampler::defaultCachePath(batch.rules);
+    }
+    auto it = options.find("format");
+    if (it != options.end()) {
+        if (it->second == "binary") {
+            batch.format = FleetFormat::BINARY;
+        }
+        else if (it->second != "text") {
+            std::cerr << "Bad format: " << it->second << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::ofstream file;
+    std::ostream* out = &std::cout;
+    it = options.find("out");
+    if (it != options.end()) {
+        file.open(it->second, std::ios::binary);
+        if (!file) {
+            std::cerr << "Error opening " << it->second << std::endl;
+            return EXIT_FAILURE;
+        }
+        out = &file;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::string error;
+    if (!generateFleetBatch(batch, *out, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return EXIT_FAILURE;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << batch.count << " fleets in " << seconds << " s (" << (seconds > 0 ? batch.count / seconds : 0) << " fleets/s)" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+int runSimulate(const std::map<std::string, std::string>& options) {
+    SimulationOptions simulation;
+    uint64_t threads = 0;
+    if (!parseNumber(options, "games", simulation.games) || !parseNumber(options, "seed", simulation.seed) || !parseNumber(options, "threads", threads)) {
+        return EXIT_FAILURE;
+    }
+    simulation.threads = static_cast<unsigned>(threads);
+    if (!parseRules(options, simulation.rules)) {
+        return EXIT_FAILURE;
+    }
+    auto it = options.find("shooter");
+    if (it != options.end() && !parseShooterKind(it->second, simulation.shooter)) {
+        std::cerr << "Bad shooter: " << it->second << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const SimulationReport report = runSimulation(simulation);
+    std::cout << "games:      " << report.games << "\n"
+              << "shots mean: " << report.meanShots << "\n"
+              << "shots min/p50/p90/p99/max: " << report.minShots << " / " << report.p50Shots << " / " << report.p90Shots
+              << " / " << report.p99Shots << " / " << report.maxShots << "\n"
+              << "time:       " << report.seconds << " s\n"
+              << "games/sec:  " << report.gamesPerSecond << std::endl;
+    if (report.failedFleets > 0) {
+        std::cerr << report.failedFleets << " fleets could not be placed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int runRecord(const std::map<std::string, std::string>& options) {
+    ReplayRecordOptions record;
+    uint64_t threads = 0;
+    if (!parseNumber(options, "games", record.games) || !parseNumber(options, "seed", record.seed) || !parseNumber(options, "threads", threads)) {
+        return EXIT_FAILURE;
+    }
+    record.threads = static_cast<unsigned>(threads);
+    if (!parseRules(options, record.rules)) {
+        return EXIT_FAILURE;
+    }
+    auto it = options.find("shooter");
+    if (it != options.end() && !parseShooterKind(it->second, record.shooter)) {
+        std::cerr << "Bad shooter: " << it->second << std::endl;
+        return EXIT_FAILURE;
+    }
+    it = options.find("out");
+    if (it == options.end()) {
+        std::cerr << "record needs --out FILE" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::string error;
+    if (!recordMatches(record, it->second, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return EXIT_FAILURE;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << record.games << " matches in " << seconds << " s (" << (seconds > 0 ? record.games / seconds : 0) << " matches/s)" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+// Plays every match of a log back headless and checks it
+int runReplay(const std::map<std::string, std::string>& options) {
+    auto it = options.find("in");
+    if (it == options.end()) {
+        std::cerr << "replay needs --in FILE" << std::endl;
+        return EXIT_FAILURE;
+    }
+    ReplayLog log;
+    std::string error;
+    if (!log.open(it->second, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    ReplayPlayer player(log.rows(), log.cols());
+    ReplayRecord record;
+    size_t cursor = 0;
+    uint64_t matches = 0;
+    uint64_t moves = 0;
+    uint64_t unfinished = 0;
+    uint64_t firstSideWins = 0;
+    while (log.next(cursor, record)) {
+        player.start(log, record);
+        const int winner = player.finish();
+        ++matches;
+        moves += player.shotsPlayed();
+        if (winner < 0 || player.shotsPlayed() != player.shotCount()) {
+            ++unfinished;
+        }
+        else if (winner == record.firstSide) {
+            ++firstSideWins;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "matches:          " << matches << "\n"
+              << "moves:            " << moves << "\n"
+              << "first side wins:  " << (matches > unfinished ? 100.0 * firstSideWins / (matches - unfinished) : 0) << " %\n"
+              << "time:             " << seconds << " s\n"
+              << "moves/sec:        " << (seconds > 0 ? moves / seconds : 0) << std::endl;
+    if (!log.atEnd(cursor)) {
+        std::cerr << "Log is cut off after " << matches << " matches" << std::endl;
+        return EXIT_FAILURE;
+    }
+    if (unfinished > 0) {
+        std::cerr << unfinished << " matches did not play back to a win" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+int runCorpus(const std::map<std::string, std::string>& options) {
+    CorpusBuildOptions corpus;
+    uint64_t threads = 0;
+    if (!parseNumber(options, "count", corpus.count) || !parseNumber(options, "seed", corpus.seed) || !parseNumber(options, "threads", threads)
+        || !parseNumber(options, "run-keys", corpus.keysPerRun)) {
+        return EXIT_FAILURE;
+    }
+    corpus.threads = static_cast<unsigned>(threads);
+    if (!parseRules(options, corpus.rules)) {
+        return EXIT_FAILURE;
+    }
+    auto it = options.find("out");
+    if (it == options.end()) {
+        std::cerr << "corpus needs --out FILE" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    std::string error;
+    if (!buildCorpus(corpus, it->second, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return EXIT_FAILURE;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cerr << corpus.count << " layouts in " << seconds << " s (" << (seconds > 0 ? corpus.count / seconds : 0) << " layouts/s)" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+bool openCorpus(const std::map<std::string, std::string>& options, const char* command, FleetCorpus& corpus) {
+    auto it = options.find("in");
+    if (it == options.end()) {
+        std::cerr << command << " needs --in FILE" << std::endl;
+        return false;
+    }
+    std::string error;
+    if (!corpus.open(it->second, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Layout counts and how often each cell holds a ship, in percent
+int runCorpusStats(const std::map<std::string, std::string>& options) {
+    FleetCorpus corpus;
+    uint64_t threads = 0;
+    if (!parseNumber(options, "threads", threads) || !openCorpus(options, "corpus-stats", corpus)) {
+        return EXIT_FAILURE;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const CorpusStats stats = corpus.stats(static_cast<unsigned>(threads));
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "layouts:        " << stats.layouts << "\n"
+              << "distinct:       " << stats.records << " (up to mirror images)\n"
+              << "scan time:      " << seconds << " s\n"
+              << "ship cells (%):\n";
+    char cell[16];
+    for (int row = 0; row < corpus.rows(); ++row) {
+        for (int col = 0; col < corpus.cols(); ++col) {
+            std::snprintf(cell, sizeof(cell), "%6.2f", 100.0 * stats.cellFrequency[row * corpus.cols() + col]);
+            std::cout << cell;
+        }
+        std::cout << "\n";
+    }
+    std::cout.flush();
+    return EXIT_SUCCESS;
+}
+
+// Reads layouts in generate's text format (stdin by default) and prints how
+// often each is in the corpus
+int runCorpusLookup(const std::map<std::string, std::string>& options) {
+    FleetCorpus corpus;
+    if (!openCorpus(options, "corpus-lookup", corpus)) {
+        return EXIT_FAILURE;
+    }
+    std::ifstream file;
+    std::istream* in = &std::cin;
+    auto it = options.find("layouts");
+    if (it != options.end() && it->second != "-") {
+        file.open(it->second);
+        if (!file) {
+            std::cerr << "Error opening " << it->second << std::endl;
+            return EXIT_FAILURE;
+        }
+        in = &file;
+    }
+
+    std::string line;
+    std::vector<ShipPlacement> fleet;
+    uint64_t lineNumber = 0;
+    while (std::getline(*in, line)) {
+        ++lineNumber;
+        bool onBoard = parseFleetLine(line, fleet);
+        for (const auto& ship : fleet) {
+            const int lastRow = ship.row + (ship.direction == ShipDirection::VERTICAL ? ship.length - 1 : 0);
+            const int lastCol = ship.col + (ship.direction == ShipDirection::HORIZONTAL ? ship.length - 1 : 0);
+            onBoard = onBoard && ship.row >= 0 && ship.col >= 0 && lastRow < corpus.rows() && lastCol < corpus.cols();
+        }
+        if (!onBoard) {
+            std::cerr << "Bad layout on line " << lineNumber << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << corpus.count(fleet) << "\n";
+    }
+    std::cout.flush();
+    return EXIT_SUCCESS;
+}
+
+// Counts the layouts of the fleet exactly and caches the tables that
+// generate --uniform 1 samples from
+int runLayouts(const std::map<std::string, std::string>& options) {
+    Rules rules;
+    if (!parseRules(options, rules)) {
+        return EXIT_FAILURE;
+    }
+    auto it = options.find("tables");
+    const std::string path = it != options.end() ? it->second : FleetSampler::defaultCachePath(rules);
+
+    const auto start = std::chrono::steady_clock::now();
+    FleetSampler sampler;
+    std::string error;
+    if (!sampler.open(rules, path, error)) {
+        std::cerr << "Error: " << error << std::endl;
+        return EXIT_FAILURE;
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << sampler.layoutCount() << std::endl;
+    std::cerr << "Tables in " << path << " (" << seconds << " s)" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+#ifndef SEA_BATTLE_NO_NETWORK
+bool parsePort(const std::map<std::string, std::string>& options, unsigned short& port) {
+    uint64_t value = port;
+    if (!parseNumber(options, "port", value)) {
+        return false;
+    }
+    if (value > 65535) {
+        std::cerr << "Bad port: " << value << std::endl;
+        return false;
+    }
+    port = static_cast<unsigned short>(value);
+    return true;
+}
+
+int runServe(const std::map<std::string, std::string>& options) {
+    unsigned short port = defaultServerPort;
+    uint64_t seed = std::random_device()();
+    uint64_t stats = 1;
+    if (!parsePort(options, port) || !parseNumber(options, "seed", seed) || !parseNumber(options, "stats", stats)) {
+        return EXIT_FAILURE;
+    }
+    NetServer server(seed);
+    if (!server.listen(port)) {
+        return EXIT_FAILURE;
+    }
+    std::cerr << "Serving on port " << server.port() << std::endl;
+    std::atomic<bool> stop(false);
+    server.run(stop, stats != 0);
+    return EXIT_SUCCESS;
+}
+
+int runLoadTestCommand(const std::map<std::string, std::string>& options) {
+    LoadTestOptions loadTest;
+    uint64_t connections = loadTest.connections;
+    uint64_t games = loadTest.gamesPerConnection;
+    uint64_t local = 0;
+    if (!parsePort(options, loadTest.port) || !parseNumber(options, "connections", connections) || !parseNumber(options, "games-per-connection", games)
+        || !parseNumber(options, "matches", loadTest.matches) || !parseNumber(options, "seed", loadTest.seed) || !parseNumber(options, "local", local)) {
+        return EXIT_FAILURE;
+    }
+    loadTest.connections = static_cast<unsigned>(connections);
+    loadTest.gamesPerConnection = static_cast<unsigned>(games);
+    auto it = options.find("host");
+    if (it != options.end()) {
+        loadTest.host = it->second;
+    }
+    it = options.find("opponent");
+    if (it != options.end()) {
+        if (it->second == "player") {
+            loadTest.opponent = Opponent::PLAYER;
+        }
+        else if (it->second != "computer") {
+            std::cerr << "Bad opponent: " << it->second << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    // --local 1: serve from a thread of this process, over loopback
+    NetServer server(loadTest.seed);
+    std::atomic<bool> stop(false);
+    std::thread serverThread;
+    if (local != 0) {
+        if (!server.listen(sf::Socket::AnyPort)) {
+            return EXIT_FAILURE;
+        }
+        loadTest.host = "127.0.0.1";
+        loadTest.port = server.port();
+        serverThread = std::thread([&server, &stop]() { server.run(stop); });
+    }
+
+    LoadTestReport report;
+    std::string error;
+    const bool ok = runLoadTest(loadTest, report, error);
+    if (serverThread.joinable()) {
+        stop = true;
+        serverThread.join();
+    }
+    if (!ok) {
+        std::cerr << "Error: " << error << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "matches:     " << report.matches << "\n"
+              << "moves:       " << report.moves << "\n"
+              << "time:        " << report.seconds << " s\n"
+              << "matches/sec: " << report.matchesPerSecond << "\n"
+              << "move latency p50/p90/p99/max: " << report.p50LatencyUs << " / " << report.p90LatencyUs << " / "
+              << report.p99LatencyUs << " / " << report.maxLatencyUs << " us" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+#endif
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+    std::map<std::string, std::string> options;
+    if (!parseOptions(argc, argv, options)) {
+        printUsage();
+        return EXIT_FAILURE;
+    }
+
+    const std::string command = argv[1];
+    if (command == "generate") {
+        return runGenerate(options);
+    }
+    if (command == "simulate") {
+        return runSimulate(options);
+    }
+    if (command == "record") {
+        return runRecord(options);
+    }
+    if (command == "replay") {
+        return runReplay(options);
+    }
+    if (command == "corpus") {
+        return runCorpus(options);
+    }
+    if (command == "corpus-stats") {
+        return runCorpusStats(options);
+    }
+    if (command == "corpus-lookup") {
+        return runCorpusLookup(options);
+    }
+    if (command == "layouts") {
+        return runLayouts(options);
+    }
+#ifndef SEA_BATTLE_NO_NETWORK
+    if (command == "serve") {
+        return runServe(options);
+    }
+    if (command == "loadtest") {
+        return runLoadTestCommand(options);
+    }
+#endif
+    printUsage();
+    return EXIT_FAILURE;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Board.h"
+#include "Random.h"
+
+// A targeting strategy: picks the next cell and learns from the result
+class Shooter {
+public:
+    virtual ~Shooter() = default;
+
+    // Start a new game against a fresh fleet
+    virtual void reset() = 0;
+    virtual void reseed(uint64_t seed) = 0;
+    // Returns false once there is nothing left to shoot at
+    virtual bool chooseTarget(int& row, int& col) = 0;
+    virtual void recordShot(int row, int col, ShotResult result) = 0;
+};
+
+// Baseline: uniformly random unshot cell, no memory of hits
+class RandomShooter : public Shooter {
+public:
+    RandomShooter(int rows, int cols, uint64_t seed = 0)
+        : cells(rows * cols), colCount(cols), rng(seed) {
+        reset();
+    }
+
+    void reset() override {
+        for (int i = 0; i < static_cast<int>(cells.size()); ++i) {
+            cells[i] = i;
+        }
+        left = static_cast<int>(cells.size());
+    }
+    void reseed(uint64_t seed) override { rng.reseed(seed); }
+
+    bool chooseTarget(int& row, int& col) override {
+        if (left == 0) {
+            return false;
+        }
+        const uint32_t pick = rng.below(static_cast<uint32_t>(left));
+        const int cell = cells[pick];
+        cells[pick] = cells[--left];
+        cells[left] = cell;
+        row = cell / colCount;
+        col = cell % colCount;
+        return true;
+    }
+    void recordShot(int, int, ShotResult) override {}
+
+private:
+    std::vector<int> cells;   // [0, left) not shot yet
+    int left = 0;
+    int colCount;
+    Rng rng;
+};
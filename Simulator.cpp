@@ -0,0 +1,158 @@
+#include "Simulator.h"
+#include <algorithm>
+#include <chrono>
+#include "DensityShooter.h"
+#include "EndgameShooter.h"
+#include "FleetBatch.h"
+#include "TargetingEngine.h"
+#include "ThreadPool.h"
+
+namespace {
+
+// Games per pool task
+const uint64_t gamesPerTask = 512;
+
+// Independent stream for the shooter of game `index`
+uint64_t shooterSeed(uint64_t seed, uint64_t index) {
+    return fleetSeed(~seed, index);
+}
+
+}
+
+bool parseShooterKind(const std::string& name, ShooterKind& kind) {
+    if (name == "random") {
+        kind = ShooterKind::RANDOM;
+        return true;
+    }
+    if (name == "probability") {
+        kind = ShooterKind::PROBABILITY;
+        return true;
+    }
+    if (name == "density") {
+        kind = ShooterKind::DENSITY;
+        return true;
+    }
+    if (name == "endgame") {
+        kind = ShooterKind::ENDGAME;
+        return true;
+    }
+    return false;
+}
+
+std::unique_ptr<Shooter> makeShooter(ShooterKind kind, const Rules& rules, uint64_t seed) {
+    if (kind == ShooterKind::RANDOM) {
+        return std::make_unique<RandomShooter>(rules.rows, rules.cols, seed);
+    }
+    if (kind == ShooterKind::ENDGAME && !rules.shipsMayTouch) {
+        return std::make_unique<EndgameShooter>(rules.rows, rules.cols, rules.shipLengths, seed);
+    }
+    // Larger boards do not fit the kernel's registers; same strategy there
+    if (kind == ShooterKind::DENSITY && !rules.shipsMayTouch && rules.rows <= densityMaxSize && rules.cols <= densityMaxSize) {
+        return std::make_unique<DensityShooter>(rules.rows, rules.cols, rules.shipLengths, seed);
+    }
+    return std::make_unique<TargetingEngine>(rules.rows, rules.cols, rules.shipLengths, seed, rules.shipsMayTouch);
+}
+
+int playGame(Shooter& shooter, FleetState& state) {
+    shooter.reset();
+    int shots = 0;
+    int row = 0;
+    int col = 0;
+    while (!state.defeated() && shooter.chooseTarget(row, col)) {
+        shooter.recordShot(row, col, state.fire(row, col));
+        ++shots;
+    }
+    return shots;
+}
+
+SimulationReport runSimulation(const SimulationOptions& options) {
+    SimulationReport report;
+    report.games = options.games;
+
+    // Shots per game, written by index so the result is thread-count independent
+    std::vector<uint16_t> shots(options.games, 0);
+
+    const auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(options.threads);
+
+        // Per-worker generator, shooter and board, built once
+        struct WorkerState {
+            std::unique_ptr<FleetGenerator> generator;
+            std::unique_ptr<Shooter> shooter;
+            std::unique_ptr<FleetState> state;
+            std::vector<ShipPlacement> placements;
+            std::vector<Ship> fleet;
+            uint64_t failed = 0;
+        };
+        std::vector<WorkerState> workers(pool.size());
+        for (auto& worker : workers) {
+            worker.generator = std::make_unique<FleetGenerator>(options.rules, 0);
+            worker.shooter = makeShooter(options.shooter, options.rules, 0);
+            worker.state = std::make_unique<FleetState>(options.rules.rows, options.rules.cols, options.rules.shipsMayTouch);
+        }
+
+        for (uint64_t first = 0; first < options.games; first += gamesPerTask) {
+            const uint64_t last = std::min(first + gamesPerTask, options.games);
+            pool.submit([&, first, last](unsigned index) {
+                WorkerState& worker = workers[index];
+                for (uint64_t game = first; game < last; ++game) {
+                    worker.generator->reseed(fleetSeed(options.seed, game));
+                    if (worker.generator->generate(worker.placements) != FleetResult::OK) {
+                        ++worker.failed;
+                        continue;
+                    }
+                    worker.fleet.clear();
+                    for (const auto& ship : worker.placements) {
+                        worker.fleet.push_back({ ship.length, ship.row, ship.col, ship.direction });
+                    }
+                    worker.state->setFleet(worker.fleet);
+                    worker.shooter->reseed(shooterSeed(options.seed, game));
+                    shots[game] = static_cast<uint16_t>(playGame(*worker.shooter, *worker.state));
+                }
+            });
+        }
+        pool.wait();
+
+        for (const auto& worker : workers) {
+            report.failedFleets += worker.failed;
+        }
+    }
+    report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Exact percentiles from a histogram: a game never takes more shots than cells
+    const int cellCount = options.rules.cellCount();
+    std::vector<uint64_t> histogram(cellCount + 1, 0);
+    uint64_t played = 0;
+    uint64_t total = 0;
+    for (uint16_t count : shots) {
+        if (count > 0) {
+            ++histogram[count];
+            ++played;
+            total += count;
+        }
+    }
+    if (played == 0) {
+        return report;
+    }
+
+    auto percentile = [&](double fraction) {
+        const uint64_t rank = static_cast<uint64_t>(fraction * (played - 1));
+        uint64_t seen = 0;
+        for (int count = 0; count <= cellCount; ++count) {
+            seen += histogram[count];
+            if (seen > rank) {
+                return count;
+            }
+        }
+        return cellCount;
+    };
+    report.meanShots = static_cast<double>(total) / played;
+    report.minShots = percentile(0.0);
+    report.p50Shots = percentile(0.5);
+    report.p90Shots = percentile(0.9);
+    report.p99Shots = percentile(0.99);
+    report.maxShots = percentile(1.0);
+    report.gamesPerSecond = report.seconds > 0 ? played / report.seconds : 0;
+    return report;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FleetGenerator.h"
+#include "GameState.h"
+#include "Shooter.h"
+
+enum class ShooterKind {
+    RANDOM,
+    PROBABILITY,
+    DENSITY,    // SIMD density kernel, boards up to densityMaxSize
+    ENDGAME     // probability, then an exact search near the end; time-bounded,
+                // so its games can differ from run to run
+};
+
+bool parseShooterKind(const std::string& name, ShooterKind& kind);
+// Where ships may touch, the density and endgame shooters (built for the
+// no-touch rule) fall back to the probability shooter
+std::unique_ptr<Shooter> makeShooter(ShooterKind kind, const Rules& rules, uint64_t seed);
+
+struct SimulationOptions {
+    Rules rules;
+    uint64_t seed = 0;
+    uint64_t games = 0;
+    unsigned threads = 0;   // 0 - one per hardware thread
+    ShooterKind shooter = ShooterKind::PROBABILITY;
+};
+
+struct SimulationReport {
+    uint64_t games = 0;
+    uint64_t failedFleets = 0;   // fleets the generator could not place
+    double meanShots = 0;
+    int minShots = 0;
+    int p50Shots = 0;
+    int p90Shots = 0;
+    int p99Shots = 0;
+    int maxShots = 0;
+    double seconds = 0;
+    double gamesPerSecond = 0;
+};
+
+// Plays `games` headless games, shooter against a freshly generated fleet,
+// on a work-stealing pool. Game i always uses the same fleet and shooter
+// seeds, so the shot statistics do not depend on the thread count.
+SimulationReport runSimulation(const SimulationOptions& options);
+
+// Shots the shooter needs to sink the fleet in `state` (fleet already set)
+int playGame(Shooter& shooter, FleetState& state);
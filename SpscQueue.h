@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+
+// Fixed-size ring between exactly one producer thread and one consumer
+// thread. Neither side ever locks or allocates: push() fails when the ring
+// is full and pop() when it is empty. The two positions sit on separate
+// cache lines so the threads do not keep stealing each other's line.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    // Producer thread
+    bool push(const T& value) {
+        const size_t head = writeIndex.load(std::memory_order_relaxed);
+        if (head - readIndex.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        items[head & (Capacity - 1)] = value;
+        writeIndex.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread
+    bool pop(T& value) {
+        const size_t tail = readIndex.load(std::memory_order_relaxed);
+        if (tail == writeIndex.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = items[tail & (Capacity - 1)];
+        readIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Either thread; only a hint while the other side is running
+    bool empty() const {
+        return readIndex.load(std::memory_order_acquire) == writeIndex.load(std::memory_order_acquire);
+    }
+
+private:
+    alignas(64) std::atomic<size_t> writeIndex{ 0 };
+    alignas(64) std::atomic<size_t> readIndex{ 0 };
+    alignas(64) T items[Capacity];
+};
@@ -0,0 +1,270 @@
+#include "TargetingEngine.h"
+#include <algorithm>
+
+TargetingEngine::TargetingEngine(int rows, int cols, const std::vector<int>& shipLengths, uint64_t seed, bool shipsMayTouch)
+    : rowCount(rows), colCount(cols), touching(shipsMayTouch), fleet(shipLengths), rng(seed) {
+    const int cellCount = rows * cols;
+    const int maxLength = fleet.empty() ? 0 : *std::max_element(fleet.begin(), fleet.end());
+    coveredBy.resize(cellCount);
+    touchedBy.resize(cellCount);
+
+    // Body and halo of every placement as Board::place() marks them, so the
+    // engine follows exactly the rules the fleet was generated with
+    for (int length = 1; length <= maxLength; ++length) {
+        if (std::find(fleet.begin(), fleet.end(), length) == fleet.end()) {
+            continue;
+        }
+        for (int row = 0; row < rows; ++row) {
+            for (int col = 0; col < cols; ++col) {
+                for (ShipDirection direction : { ShipDirection::HORIZONTAL, ShipDirection::VERTICAL }) {
+                    const bool vertical = direction == ShipDirection::VERTICAL;
+                    const int lastRow = row + (vertical ? length - 1 : 0);
+                    const int lastCol = col + (vertical ? 0 : length - 1);
+                    if (lastRow >= rows || lastCol >= cols || (length == 1 && vertical)) {
+                        continue;
+                    }
+
+                    const int index = static_cast<int>(placements.size());
+                    placements.push_back({ length, {} });
+                    for (int r = std::max(row - 1, 0); r <= std::min(lastRow + 1, rows - 1); ++r) {
+                        for (int c = std::max(col - 1, 0); c <= std::min(lastCol + 1, cols - 1); ++c) {
+                            if (r >= row && r <= lastRow && c >= col && c <= lastCol) {
+                                placements.back().cells.push_back(r * cols + c);
+                                coveredBy[r * cols + c].push_back(index);
+                            }
+                            else if (!touching) {
+                                touchedBy[r * cols + c].push_back(index);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    cover.assign(maxLength + 1, std::vector<uint32_t>(cellCount, 0));
+    remaining.assign(maxLength + 1, 0);
+    alive.assign((placements.size() + 63) / 64, 0);
+    shot.assign((cellCount + 63) / 64, 0);
+    openHits.assign((cellCount + 63) / 64, 0);
+    weight.assign(cellCount, 0);
+    sunkShip.reserve(cellCount);
+    reset();
+}
+
+void TargetingEngine::reset() {
+    std::fill(remaining.begin(), remaining.end(), 0);
+    for (int length : fleet) {
+        ++remaining[length];
+    }
+    for (auto& counts : cover) {
+        std::fill(counts.begin(), counts.end(), 0);
+    }
+    std::fill(alive.begin(), alive.end(), 0);
+    for (int p = 0; p < static_cast<int>(placements.size()); ++p) {
+        setBit(alive, p);
+        for (int cell : placements[p].cells) {
+            ++cover[placements[p].length][cell];
+        }
+    }
+    std::fill(shot.begin(), shot.end(), 0);
+    std::fill(openHits.begin(), openHits.end(), 0);
+}
+
+bool TargetingEngine::chooseTarget(int& row, int& col) {
+    std::fill(weight.begin(), weight.end(), 0);
+
+    bool targeting = false;
+    for (uint64_t word : openHits) {
+        targeting = targeting || word != 0;
+    }
+
+    const int cellCount = rowCount * colCount;
+    if (targeting) {
+        // Finish the wounded ship: only placements through an open hit count
+        for (int hit = 0; hit < cellCount; ++hit) {
+            if (!testBit(openHits, hit)) {
+                continue;
+            }
+            for (int p : coveredBy[hit]) {
+                if (isAlive(p)) {
+                    for (int cell : placements[p].cells) {
+                        weight[cell] += remaining[placements[p].length];
+                    }
+                }
+            }
+        }
+    }
+    else {
+        for (size_t length = 1; length < cover.size(); ++length) {
+            if (remaining[length] == 0) {
+                continue;
+            }
+            const std::vector<uint32_t>& counts = cover[length];
+            for (int cell = 0; cell < cellCount; ++cell) {
+                weight[cell] += remaining[length] * counts[cell];
+            }
+        }
+    }
+
+    // Reservoir-sample among the best unshot cells
+    int best = -1;
+    uint32_t bestWeight = 0;
+    uint32_t ties = 0;
+    for (int cell = 0; cell < cellCount; ++cell) {
+        if (testBit(shot, cell)) {
+            continue;
+        }
+        if (best < 0 || weight[cell] > bestWeight) {
+            best = cell;
+            bestWeight = weight[cell];
+            ties = 1;
+        }
+        else if (weight[cell] == bestWeight && rng.below(++ties) == 0) {
+            best = cell;
+        }
+    }
+    if (best < 0) {
+        return false;
+    }
+    row = best / colCount;
+    col = best % colCount;
+    return true;
+}
+
+void TargetingEngine::recordShot(int row, int col, ShotResult result) {
+    const int cell = row * colCount + col;
+    setBit(shot, cell);
+
+    if (result == ShotResult::MISS) {
+        markWater(cell);
+        return;
+    }
+
+    // A ship cell: nothing else may touch it
+    setBit(openHits, cell);
+    for (int p : touchedBy[cell]) {
+        kill(p);
+    }
+    if (result == ShotResult::HIT) {
+        return;
+    }
+
+    collectSunkShip(cell);
+    const std::vector<int>& ship = sunkShip;
+    for (int part : ship) {
+        for (int p : coveredBy[part]) {
+            kill(p);
+        }
+    }
+    // Everything around a sunk ship is water, unless ships may touch
+    if (!touching) {
+        for (int part : ship) {
+            const int r = part / colCount;
+            const int c = part % colCount;
+            for (int nr = std::max(r - 1, 0); nr <= std::min(r + 1, rowCount - 1); ++nr) {
+                for (int nc = std::max(c - 1, 0); nc <= std::min(c + 1, colCount - 1); ++nc) {
+                    const int next = nr * colCount + nc;
+                    if (!testBit(shot, next)) {
+                        setBit(shot, next);
+                        markWater(next);
+                    }
+                }
+            }
+        }
+    }
+
+    const int length = static_cast<int>(ship.size());
+    if (length < static_cast<int>(remaining.size()) && remaining[length] > 0) {
+        --remaining[length];
+    }
+}
+
+int TargetingEngine::shipsLeft() const {
+    int count = 0;
+    for (int ships : remaining) {
+        count += ships;
+    }
+    return count;
+}
+
+void TargetingEngine::kill(int placement) {
+    if (!isAlive(placement)) {
+        return;
+    }
+    clearBit(alive, placement);
+    const Placement& p = placements[placement];
+    for (int cell : p.cells) {
+        --cover[p.length][cell];
+    }
+}
+
+void TargetingEngine::collectSunkShip(int cell) {
+    std::vector<int>& ship = sunkShip;
+    ship.assign(1, cell);
+    clearBit(openHits, cell);
+    if (touching) {
+        const int across = hitRun(cell, 0, 1);
+        const int down = hitRun(cell, 1, 0);
+        auto afloat = [this](int length) { return length < static_cast<int>(remaining.size()) && remaining[length] > 0; };
+        int dRow = 0;
+        int dCol = 0;
+        if (afloat(across) && (!afloat(down) || across >= down)) {
+            dCol = 1;
+        }
+        else if (afloat(down)) {
+            dRow = 1;
+        }
+        if (dRow == 0 && dCol == 0) {
+            return;
+        }
+        for (int sign : { -1, 1 }) {
+            int r = cell / colCount + sign * dRow;
+            int c = cell % colCount + sign * dCol;
+            while (r >= 0 && r < rowCount && c >= 0 && c < colCount && testBit(openHits, r * colCount + c)) {
+                clearBit(openHits, r * colCount + c);
+                ship.push_back(r * colCount + c);
+                r += sign * dRow;
+                c += sign * dCol;
+            }
+        }
+        return;
+    }
+
+    // No touching: the connected open hits are the whole ship
+    for (size_t i = 0; i < ship.size(); ++i) {
+        const int r = ship[i] / colCount;
+        const int c = ship[i] % colCount;
+        const int neighbours[4][2] = { { r - 1, c }, { r + 1, c }, { r, c - 1 }, { r, c + 1 } };
+        for (const auto& n : neighbours) {
+            if (n[0] < 0 || n[0] >= rowCount || n[1] < 0 || n[1] >= colCount) {
+                continue;
+            }
+            const int next = n[0] * colCount + n[1];
+            if (testBit(openHits, next)) {
+                clearBit(openHits, next);
+                ship.push_back(next);
+            }
+        }
+    }
+}
+
+int TargetingEngine::hitRun(int cell, int dRow, int dCol) const {
+    int run = 1;
+    for (int sign : { -1, 1 }) {
+        int r = cell / colCount + sign * dRow;
+        int c = cell % colCount + sign * dCol;
+        while (r >= 0 && r < rowCount && c >= 0 && c < colCount && testBit(openHits, r * colCount + c)) {
+            ++run;
+            r += sign * dRow;
+            c += sign * dCol;
+        }
+    }
+    return run;
+}
+
+void TargetingEngine::markWater(int cell) {
+    for (int p : coveredBy[cell]) {
+        kill(p);
+    }
+}
@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "Board.h"
+#include "Random.h"
+#include "Shooter.h"
+
+// Computer shooter that fires where the remaining fleet is most likely to be.
+// For every cell it keeps, per ship length, the number of still-legal
+// single-ship placements covering it (legal = inside the board, on no known
+// water, and under the same no-touch rule as Board::canPlaceWithGap unless
+// ships may touch); a cell's weight sums them times the ships of that length
+// still afloat.
+//
+// This approximates, rather than counts, the legal layouts of the whole
+// remaining fleet covering each cell: ships are weighed as if they did not
+// exclude each other. Counting joint layouts takes a dynamic program over
+// whole fleets, about a minute for the empty 10x10 board (FleetSampler),
+// against a budget of 1 ms per move. Per ship the counts stay exact, and
+// since shots only ever rule placements out, each result just subtracts the
+// placements it kills instead of re-enumerating the board, which keeps a
+// move well under 1 ms.
+class TargetingEngine : public Shooter {
+public:
+    TargetingEngine(int rows, int cols, const std::vector<int>& shipLengths, uint64_t seed = 0, bool shipsMayTouch = false);
+
+    void reset() override;
+    void reseed(uint64_t seed) override { rng.reseed(seed); }
+
+    // Unshot cell with the highest weight; ties are broken at random.
+    // While some hit is not yet sunk only placements through such hits count.
+    // Returns false once every cell has been shot.
+    bool chooseTarget(int& row, int& col) override;
+
+    // Result of a shot at (row, col). On SUNK the ship is the group of
+    // connected hits containing the cell, its halo is known to be water.
+    // Where ships may touch, connected hits can be several ships: the ship
+    // is taken to be the straight run of hits through the cell whose length
+    // is still afloat, and nothing around it is known.
+    void recordShot(int row, int col, ShotResult result) override;
+
+    // Weight of every cell for the next shot, row-major (valid after chooseTarget)
+    const std::vector<uint32_t>& weights() const { return weight; }
+    int shipsLeft() const;
+
+    // What the engine knows, for an exact search on top of it (EndgameSolver).
+    // A placement is alive while it agrees with every shot so far.
+    int rows() const { return rowCount; }
+    int cols() const { return colCount; }
+    int placementCount() const { return static_cast<int>(placements.size()); }
+    bool placementAlive(int placement) const { return isAlive(placement); }
+    int placementLength(int placement) const { return placements[placement].length; }
+    const std::vector<int>& placementCells(int placement) const { return placements[placement].cells; }
+    // Length -> ships of that length not sunk yet
+    const std::vector<int>& shipsRemaining() const { return remaining; }
+    bool isShot(int cell) const { return testBit(shot, cell); }
+    // Hit, but its ship is not sunk yet
+    bool isOpenHit(int cell) const { return testBit(openHits, cell); }
+
+private:
+    struct Placement {
+        int length;
+        std::vector<int> cells;
+    };
+
+    int rowCount;
+    int colCount;
+    bool touching;
+    std::vector<int> fleet;
+    Rng rng;
+
+    std::vector<Placement> placements;
+    std::vector<std::vector<int>> coveredBy;   // cell -> placements using it
+    std::vector<std::vector<int>> touchedBy;   // cell -> placements whose halo (not body) contains it
+
+    std::vector<uint64_t> alive;               // bitset over placements
+    std::vector<std::vector<uint32_t>> cover;  // length -> cell -> alive placements covering it
+    std::vector<int> remaining;                // length -> ships not sunk yet
+
+    std::vector<uint64_t> shot;                // bitsets over cells
+    std::vector<uint64_t> openHits;
+    std::vector<uint32_t> weight;
+    std::vector<int> sunkShip;                 // scratch for recordShot, sized once
+
+    bool isAlive(int placement) const { return (alive[placement >> 6] >> (placement & 63)) & 1u; }
+    static bool testBit(const std::vector<uint64_t>& mask, int bit) { return (mask[bit >> 6] >> (bit & 63)) & 1u; }
+    static void setBit(std::vector<uint64_t>& mask, int bit) { mask[bit >> 6] |= 1ull << (bit & 63); }
+    static void clearBit(std::vector<uint64_t>& mask, int bit) { mask[bit >> 6] &= ~(1ull << (bit & 63)); }
+
+    void kill(int placement);
+    void markWater(int cell);
+    // Cells of the ship sunk at `cell` into sunkShip, cleared from openHits
+    void collectSunkShip(int cell);
+    // Open hits in a straight line through the cell, the cell included
+    int hitRun(int cell, int dRow, int dCol) const;
+};
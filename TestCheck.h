@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdlib>
+#include <iostream>
+
+// Checks for the test programs run by CTest. A failed CHECK prints where it
+// failed and the program carries on; main() returns testResult().
+//
+//     CHECK(fleet.mark(2, 3) == CellMark::NONE);
+//     ...
+//     return testResult();
+#define CHECK(condition) ((condition) ? (void)0 : testFailed(#condition, __FILE__, __LINE__))
+
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void testFailed(const char* condition, const char* file, int line) {
+    std::cerr << file << ":" << line << ": CHECK(" << condition << ") failed" << std::endl;
+    ++testFailures();
+}
+
+inline int testResult() {
+    if (testFailures() > 0) {
+        std::cerr << testFailures() << " check(s) failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
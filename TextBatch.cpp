@@ -0,0 +1,108 @@
+#include "TextBatch.h"
+#include <algorithm>
+#include "Profiler.h"
+
+namespace {
+
+// Glyph quads reach a pixel past the glyph, like sf::Text's, so smoothing
+// does not cut the edges
+const float glyphPadding = 1.0f;
+
+// Every font page keeps a white square at its top-left corner (sf::Text
+// draws underlines with it); solid quads sample its centre
+const sf::FloatRect whiteTexel(1.0f, 1.0f, 0.0f, 0.0f);
+
+// Lays out one line with glyphs of `glyphSize` scaled by `scale`, baseline
+// at y = 0. Calls place(glyph, x) for every visible glyph with the pen at x
+// and returns the line's bounds, measured the way sf::Text measures them.
+template <typename Place>
+sf::FloatRect layoutLine(const sf::Font& font, const std::string& text, unsigned glyphSize, float scale, Place place) {
+    float minX = 0.0f;
+    float minY = 0.0f;
+    float maxX = 0.0f;
+    float maxY = 0.0f;
+    bool empty = true;
+    auto extend = [&](float left, float top, float right, float bottom) {
+        minX = empty ? left : std::min(minX, left);
+        minY = empty ? top : std::min(minY, top);
+        maxX = empty ? right : std::max(maxX, right);
+        maxY = empty ? bottom : std::max(maxY, bottom);
+        empty = false;
+    };
+
+    float x = 0.0f;
+    sf::Uint32 previous = 0;
+    for (char c : text) {
+        const sf::Uint32 current = static_cast<unsigned char>(c);
+        x += font.getKerning(previous, current, glyphSize) * scale;
+        previous = current;
+        const sf::Glyph& glyph = font.getGlyph(current, glyphSize, false);
+        const float advance = glyph.advance * scale;
+        if (current == ' ') {
+            extend(x, 0.0f, x + advance, 0.0f);
+        }
+        else {
+            const sf::FloatRect& bounds = glyph.bounds;
+            extend(x + bounds.left * scale, bounds.top * scale, x + (bounds.left + bounds.width) * scale, (bounds.top + bounds.height) * scale);
+            place(glyph, x);
+        }
+        x += advance;
+    }
+    return sf::FloatRect(minX, minY, maxX - minX, maxY - minY);
+}
+
+}
+
+TextBatch::TextBatch(std::shared_ptr<const sf::Font> font, unsigned atlasSize) : font(std::move(font)), atlasSize(atlasSize) {
+}
+
+void TextBatch::clear() {
+    vertices.clear();
+}
+
+void TextBatch::addText(const std::string& text, sf::Vector2f centre, unsigned characterSize, sf::Color color) {
+    const float scale = static_cast<float>(characterSize) / atlasSize;
+    auto skip = [](const sf::Glyph&, float) {};
+    const sf::FloatRect bounds = layoutLine(*font, text, atlasSize, scale, skip);
+    const sf::Vector2f origin(centre.x - bounds.left - bounds.width / 2.0f, centre.y - bounds.top - bounds.height / 2.0f);
+
+    layoutLine(*font, text, atlasSize, scale, [&](const sf::Glyph& glyph, float x) {
+        const sf::FloatRect& glyphBounds = glyph.bounds;
+        const sf::IntRect& rect = glyph.textureRect;
+        const sf::FloatRect position(origin.x + x + (glyphBounds.left - glyphPadding) * scale, origin.y + (glyphBounds.top - glyphPadding) * scale,
+                                     (glyphBounds.width + 2 * glyphPadding) * scale, (glyphBounds.height + 2 * glyphPadding) * scale);
+        const sf::FloatRect texture(rect.left - glyphPadding, rect.top - glyphPadding, rect.width + 2 * glyphPadding, rect.height + 2 * glyphPadding);
+        addQuad(position, texture, color);
+    });
+}
+
+void TextBatch::addRect(const sf::FloatRect& rect, sf::Color color) {
+    addQuad(rect, whiteTexel, color);
+}
+
+void TextBatch::addQuad(const sf::FloatRect& position, const sf::FloatRect& texture, sf::Color color) {
+    const float right = position.left + position.width;
+    const float bottom = position.top + position.height;
+    const float textureRight = texture.left + texture.width;
+    const float textureBottom = texture.top + texture.height;
+    vertices.emplace_back(sf::Vector2f(position.left, position.top), color, sf::Vector2f(texture.left, texture.top));
+    vertices.emplace_back(sf::Vector2f(right, position.top), color, sf::Vector2f(textureRight, texture.top));
+    vertices.emplace_back(sf::Vector2f(right, bottom), color, sf::Vector2f(textureRight, textureBottom));
+    vertices.emplace_back(sf::Vector2f(position.left, bottom), color, sf::Vector2f(texture.left, textureBottom));
+}
+
+void TextBatch::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    if (vertices.empty()) {
+        return;
+    }
+    ProfileScope scope("TextBatch::draw");
+    // Looked up per draw: the page texture grows as glyphs are added, but
+    // texture coordinates are in pixels and stay valid
+    states.texture = &font->getTexture(atlasSize);
+    target.draw(vertices.data(), vertices.size(), sf::Quads, states);
+    Profiler::countDrawCalls();
+}
+
+sf::FloatRect measureText(const sf::Font& font, const std::string& text, unsigned characterSize) {
+    return layoutLine(font, text, characterSize, 1.0f, [](const sf::Glyph&, float) {});
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <SFML/Graphics.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// All the text of one screen (coordinate labels, button captions, status
+// lines) as one quad batch over the font's glyph atlas, so however many
+// strings there are it is a single draw call. Glyphs are rendered once at
+// `atlasSize` and scaled for other sizes, which keeps every string on one
+// atlas texture. The owner rebuilds the batch (clear() and add*) only when
+// a string or colour changes; an unchanged batch is just drawn again.
+class TextBatch : public sf::Drawable {
+public:
+    explicit TextBatch(std::shared_ptr<const sf::Font> font, unsigned atlasSize = 24);
+
+    void clear();
+    // One line centred on `centre`, as the labels have always been placed
+    void addText(const std::string& text, sf::Vector2f centre, unsigned characterSize, sf::Color color);
+    // Solid rectangle (a button's background), drawn in order with the text
+    void addRect(const sf::FloatRect& rect, sf::Color color);
+
+private:
+    std::shared_ptr<const sf::Font> font;
+    unsigned atlasSize;
+    std::vector<sf::Vertex> vertices;
+
+    void addQuad(const sf::FloatRect& position, const sf::FloatRect& texture, sf::Color color);
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+};
+
+// Bounds of one line of text at `characterSize`, the same as
+// sf::Text::getLocalBounds() gives
+sf::FloatRect measureText(const sf::Font& font, const std::string& text, unsigned characterSize);
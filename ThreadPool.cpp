@@ -0,0 +1,94 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(unsigned threads) {
+    if (threads == 0) {
+        threads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::run, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(Task task) {
+    // Spread new tasks round-robin, stealing evens out the rest
+    // Count first, so a worker never takes a task that is not counted yet
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        ++queued;
+        ++pending;
+    }
+    Queue& queue = *queues[nextQueue.fetch_add(1) % queues.size()];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    workAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(stateMutex);
+    allDone.wait(lock, [this]() { return pending == 0; });
+}
+
+bool ThreadPool::takeTask(unsigned worker, Task& task) {
+    {
+        Queue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t i = 1; i < queues.size(); ++i) {
+        Queue& victim = *queues[(worker + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run(unsigned worker) {
+    Task task;
+    for (;;) {
+        if (takeTask(worker, task)) {
+            {
+                std::lock_guard<std::mutex> lock(stateMutex);
+                --queued;
+            }
+            task(worker);
+            task = nullptr;
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (--pending == 0) {
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        // Sleep until something is queued; another worker may still grab it first
+        std::unique_lock<std::mutex> lock(stateMutex);
+        workAvailable.wait(lock, [this]() { return stopping || queued > 0; });
+        if (stopping && queued == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of workers with one task deque each. A worker pops its own
+// newest task first and, when it runs dry, steals the oldest task of
+// another worker, so uneven tasks (long games, slow fleets) still keep
+// every core busy. Tasks receive the index of the worker running them,
+// which lets callers keep per-worker state without locking.
+class ThreadPool {
+public:
+    using Task = std::function<void(unsigned worker)>;
+
+    explicit ThreadPool(unsigned threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    unsigned size() const { return static_cast<unsigned>(queues.size()); }
+
+    void submit(Task task);
+    // Blocks until every submitted task has finished
+    void wait();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<unsigned> nextQueue{ 0 };
+
+    std::mutex stateMutex;
+    std::condition_variable workAvailable;
+    std::condition_variable allDone;
+    size_t queued = 0;      // sitting in a deque
+    size_t pending = 0;     // submitted, not finished
+    bool stopping = false;
+
+    bool takeTask(unsigned worker, Task& task);
+    void run(unsigned worker);
+};
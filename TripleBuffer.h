@@ -0,0 +1,45 @@
+#pragma once
+#include <atomic>
+
+// Latest-value handoff from one writer thread to one reader thread. The
+// writer fills back() and publish()es it; the reader update()s to the newest
+// published value and reads front() for as long as it likes. Each side
+// owns one of the three slots and the third is swapped through an atomic,
+// so neither side ever waits and intermediate values are simply dropped.
+// A published slot comes back to the writer holding an old value: the
+// writer rewrites it completely every time.
+template <typename T>
+class TripleBuffer {
+public:
+    // All three slots start as copies of `initial`, so buffers sized there
+    // never grow afterwards
+    explicit TripleBuffer(const T& initial = T()) : slots{ initial, initial, initial } {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer thread
+    T& back() { return slots[backSlot]; }
+    void publish() {
+        backSlot = middle.exchange(backSlot | freshBit, std::memory_order_acq_rel) & slotMask;
+    }
+
+    // Reader thread: true if front() changed
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & freshBit) == 0) {
+            return false;
+        }
+        frontSlot = middle.exchange(frontSlot, std::memory_order_acq_rel) & slotMask;
+        return true;
+    }
+    const T& front() const { return slots[frontSlot]; }
+
+private:
+    static constexpr int slotMask = 3;
+    static constexpr int freshBit = 4;
+
+    T slots[3];
+    std::atomic<int> middle{ 1 };   // slot index, plus freshBit once published
+    int backSlot = 0;
+    int frontSlot = 2;
+};